@@ -25,8 +25,21 @@
  * IN THE SOFTWARE.
  */
 
+#if defined( LOG_USE_MMAP_SINK ) && LOG_USE_MMAP_SINK && !defined( _POSIX_C_SOURCE )
+#define _POSIX_C_SOURCE 200809L  /* mmap(), msync(), ftruncate() and posix_fallocate() */
+#endif
+
 #include <inttypes.h>
+#include <stddef.h>
 #include "log_ec.h"
+#if LOG_USE_CYCLE_COUNTER && !defined( __arm__ ) && !defined( __x86_64__ ) && !defined( __i386__ ) && !defined( __aarch64__ )
+#include <time.h>
+#endif
+#if LOG_USE_MMAP_SINK
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 /* Private macro definitions ------------------------------------------------*/
 
@@ -34,54 +47,568 @@
 #define LOG_USE_COLOR 0  /* Default: monochrom log printing */
 #endif
 
+#define LOG_LEVEL_OFF ( LOG_FATAL + 1 )  /* Effective logging level when log messages are not written anywhere */
+
+#if LOG_USE_ASYNC
+#if ( LOG_ASYNC_QUEUE_LENGTH & ( LOG_ASYNC_QUEUE_LENGTH - 1U ) ) != 0U
+#error "LOG_ASYNC_QUEUE_LENGTH shall be a power of 2"
+#endif
+#define LOG_ASYNC_QUEUE_MASK ( (uint32_t)LOG_ASYNC_QUEUE_LENGTH - 1U )  /* Mask to convert a queue position to a slot index */
+#endif
+
+#if LOG_DEFERRED_FORMAT && !LOG_USE_ASYNC
+#error "LOG_DEFERRED_FORMAT requires asynchronous logging (LOG_ASYNC_QUEUE_LENGTH > 0)"
+#endif
+
+#if LOG_USE_CHUNK_OUTPUT && !LOG_USE_ASYNC
+#error "LOG_USE_CHUNK_OUTPUT requires asynchronous logging (LOG_ASYNC_QUEUE_LENGTH > 0)"
+#endif
+
+#if LOG_LAZY_FORMAT && !LOG_USE_MESSAGE_BUFFER
+#error "LOG_LAZY_FORMAT requires the message buffer (LOG_MESSAGE_BUFFER_SIZE > 0)"
+#endif
+
+#if LOG_USE_CHUNK_OUTPUT && LOG_DEFERRED_FORMAT
+#error "LOG_USE_CHUNK_OUTPUT requires queued log messages to be formatted by the caller (LOG_DEFERRED_FORMAT = 0)"
+#endif
+
+#if LOG_USE_CHUNK_OUTPUT && defined( __GNUC__ )
+#define LOG_CHUNK_ALIGN __attribute__(( aligned( LOG_CHUNK_ALIGNMENT ) ))  /* alignment of the queued log message, e.g. for DMA */
+#else
+#define LOG_CHUNK_ALIGN  /* natural alignment */
+#endif
+
+/** Macro that evaluates 'true' if printf arguments are serialized into binary form */
+#define LOG_USE_ARG_PACKING ( LOG_DEFERRED_FORMAT || LOG_USE_COALESCE || LOG_USE_CRASH_LOG )
+
+/** Macro that evaluates 'true' if packed printf arguments are formatted by the library */
+#define LOG_USE_ARG_RENDERING ( LOG_DEFERRED_FORMAT || LOG_USE_CRASH_LOG )
+
+/** Macro that evaluates 'true' if single printf conversions are formatted by formatSpec() */
+#define LOG_USE_FORMAT_SPEC ( LOG_USE_ARG_RENDERING || LOG_USE_FIELDS )
+
+#if LOG_USE_CRASH_LOG && ( ( LOG_CRASH_LOG_LENGTH == 0U ) || ( ( LOG_CRASH_LOG_LENGTH & ( LOG_CRASH_LOG_LENGTH - 1U ) ) != 0U ) )
+#error "LOG_CRASH_LOG_LENGTH shall be a power of 2"
+#endif
+
+#if LOG_USE_CRASH_LOG && ( LOG_CRASH_ARGS_SIZE > 255U )
+#error "LOG_CRASH_ARGS_SIZE shall be no larger than 255 bytes"
+#endif
+
+#if LOG_PREFIX_SIZE < 64U
+#error "LOG_PREFIX_SIZE shall be at least 64 bytes, to hold the timestamp, logging level and line number"
+#endif
+
+#ifndef LOG_CRASH_LOG_SECTION
+#if defined( __GNUC__ )
+#define LOG_CRASH_LOG_SECTION __attribute__(( section( ".noinit" ) ))  /* section that is not zeroed by the startup code, which the linker script shall provide */
+#else
+#define LOG_CRASH_LOG_SECTION  /* the crash log shall be placed in uninitialized memory by the linker configuration */
+#endif
+#endif
+
+#define LOG_CRASH_LOG_MAGIC 0x4C4F4743UL  /* "LOGC" */
+#define CRASH_LOG_UNCHECKED 0U  /* Crash log state: the header has not been validated or reset since startup */
+#define CRASH_LOG_CHECKING  1U  /* Crash log state: a writer is validating or resetting the header */
+#define CRASH_LOG_READY     2U  /* Crash log state: the header has been validated or reset */
+#define CRASH_RECORD_BUSY   0xFFFFFFFFUL  /* Sequence number of a crash log record that is being written */
+
+#if LOG_USE_CYCLE_COUNTER && !defined( LOG_READ_CYCLE_COUNTER )
+#define LOG_READ_CYCLE_COUNTER() readCycleCounter()  /* Default: read the CPU cycle counter */
+#endif
+
+#if LOG_USE_CYCLE_COUNTER && defined( __arm__ ) && !( defined( __ARM_ARCH_7M__ ) || defined( __ARM_ARCH_7EM__ ) || defined( __ARM_ARCH_8M_MAIN__ ) || defined( __ARM_ARCH_8_1M_MAIN__ ) )
+#error "LOG_USE_CYCLE_COUNTER requires the DWT cycle counter of an Armv7-M or Armv8-M Mainline core"
+#endif
+
+#if LOG_USE_CYCLE_COUNTER && !defined( __arm__ ) && !defined( __x86_64__ ) && !defined( __i386__ ) && !defined( __aarch64__ ) && !defined( CLOCK_MONOTONIC )
+#error "LOG_USE_CYCLE_COUNTER is not supported on this platform"
+#endif
+
+#if LOG_USE_CYCLE_COUNTER && defined( __arm__ )
+#define DWT_CTRL       ( *(volatile uint32_t*)0xE0001000UL )  /* DWT control register */
+#define DWT_CYCCNT     ( *(volatile uint32_t*)0xE0001004UL )  /* DWT cycle counter */
+#define DWT_LAR        ( *(volatile uint32_t*)0xE0001FB0UL )  /* DWT lock access register (Cortex-M7) */
+#define DEM_CR         ( *(volatile uint32_t*)0xE000EDFCUL )  /* Debug exception and monitor control register */
+#define DEM_CR_TRCENA  ( 1UL << 24 )                          /* Enable the DWT */
+#define DWT_CTRL_CYCCNTENA ( 1UL )                            /* Enable the cycle counter */
+#endif
+
+/** Macro that evaluates 'true' if timestamp A is earlier than timestamp B, allowing for wrap-around */
+#if LOG_TIMESTAMP_64
+#define TIMESTAMP_BEFORE( A, B ) ( (int64_t)( (A) - (B) ) < 0 )
+#else
+#define TIMESTAMP_BEFORE( A, B ) ( (int32_t)( (A) - (B) ) < 0 )
+#endif
+
+/** Macro that evaluates 'true' if atomic operations are required */
+#define LOG_USE_ATOMICS ( LOG_USE_ASYNC || LOG_USE_CRASH_LOG )
+
+#if LOG_USE_BATCH_SINK && !LOG_USE_CALLBACKS
+#error "LOG_USE_BATCH_SINK requires logging callbacks (LOG_MAX_CALLBACKS > 0)"
+#endif
+
+#if LOG_USE_BINARY_SINK && !LOG_USE_CALLBACKS
+#error "LOG_USE_BINARY_SINK requires logging callbacks (LOG_MAX_CALLBACKS > 0)"
+#endif
+
+#if LOG_USE_MMAP_SINK && !LOG_USE_CALLBACKS
+#error "LOG_USE_MMAP_SINK requires logging callbacks (LOG_MAX_CALLBACKS > 0)"
+#endif
+
+#if LOG_USE_MMAP_SINK && !( defined( __unix__ ) || defined( __APPLE__ ) )
+#error "LOG_USE_MMAP_SINK requires a POSIX host with mmap()"
+#endif
+
+#if LOG_USE_BINARY_SINK && ( ( LOG_BINARY_RECORD_SIZE < 32U ) || ( LOG_BINARY_RECORD_SIZE > 16383U ) )
+#error "LOG_BINARY_RECORD_SIZE shall be between 32 and 16383 bytes"
+#endif
+
+/** Macro that evaluates 'true' if printf conversion specifications are parsed by the library */
+#define LOG_USE_FORMAT_PARSER ( LOG_USE_ARG_PACKING || LOG_USE_MINIMAL_PRINTF || LOG_USE_BINARY_SINK )
+
+/** Macro that evaluates 'true' if the log message prefix and body are formatted into one buffer before they are written to the console */
+#define LOG_USE_LINE_BUFFER ( LOG_USE_CONSOLE_WRITE || LOG_USE_MINIMAL_PRINTF )
+
+#if LOG_USE_CONSOLE_WRITE
+#define LOG_WRITE_LINE( BUF, LEN ) CONSOLE_WRITE( BUF, LEN )  /* write the log message with a single call */
+#else
+#define LOG_WRITE_LINE( BUF, LEN ) CONSOLE_PRINTF( "%s", BUF )  /* the log message has already been formatted by the minimal printf formatter */
+#endif
+
+#define BINARY_RECORD_MESSAGE   0x00U  /* Binary record type: log message */
+#define BINARY_RECORD_SYNC      0x10U  /* Binary record type: absolute timestamp */
+#define BINARY_RECORD_SITE      0x20U  /* Binary record type: log message identified by its call site ID */
+#define BINARY_RECORD_TRUNCATED 0x80U  /* Binary record flag: printf arguments that did not fit in the record were discarded */
+#define BINARY_FORMAT_VERSION   1U     /* Version of the binary record format */
+
+#define LOG_FLOAT_MAX_PRECISION 9  /* Maximum precision of the %f conversion of the minimal printf formatter */
+
+#ifndef LOG_FIELD_FLOAT_FORMAT
+#if LOG_USE_MINIMAL_PRINTF
+#define LOG_FIELD_FLOAT_FORMAT "%.3f"  /* Default: printf format of a floating point field value, which is supported by the minimal printf formatter */
+#else
+#define LOG_FIELD_FLOAT_FORMAT "%g"  /* Default: printf format of a floating point field value in the text of a structured log message */
+#endif
+#endif
+
+#if LOG_USE_COLOR
+#define LEVEL_PREFIX( COLOR, LEVEL ) { " " COLOR LEVEL "\x1b[0m \x1b[90m", sizeof( " " COLOR LEVEL "\x1b[0m \x1b[90m" ) - 1U }  /* padded level string: colour */
+#define LEVEL_PREFIX_END ":\x1b[0m "  /* end of message prefix: colour */
+#else
+#define LEVEL_PREFIX( COLOR, LEVEL ) { " " LEVEL " ", sizeof( " " LEVEL " " ) - 1U }  /* padded level string: monochrome */
+#define LEVEL_PREFIX_END ": "  /* end of message prefix: monochrome */
+#endif
+
 /* Private type definitions -------------------------------------------------*/
 
+/** Precomputed log message prefix text for a logging level */
+typedef struct {
+    const char* text;  //!< Text between the timestamp and the filename: padded level string, and colour escape codes if enabled
+    size_t length;     //!< Number of characters of text
+} tLevelPrefix;
+
+#if LOG_TIMESTAMP_64 || LOG_USE_FIELDS
+typedef uint64_t tDecimal;  //!< Unsigned integer formatted by appendUnsigned()
+#else
+typedef uint32_t tDecimal;  //!< Unsigned integer formatted by appendUnsigned()
+#endif
+
 #if LOG_USE_CALLBACKS
 typedef struct {
     tLog_callbackFn cbFn;  //!< Callback function
     void* cbData;          //!< User data associated with callback function
     int cbLogLevel;        //!< Minimum logging level at which the callback is invoked
+#if LOG_USE_STATS
+    size_t slot;           //!< Registration slot, which indexes the callback duration histogram
+#endif
 } tCallback;
+
+/** Registered callbacks, sorted by ascending callback logging level, which are rebuilt and read with the lock held */
+typedef struct {
+    size_t count;                            //!< Number of registered callbacks
+    tCallback callbacks[LOG_MAX_CALLBACKS];  //!< Registered callbacks
+} tCallbackSnapshot;
+#endif
+
+#if LOG_USE_FORMAT_PARSER
+/** printf conversion specification length modifier */
+typedef enum {
+    LENGTH_NONE,
+    LENGTH_HH,
+    LENGTH_H,
+    LENGTH_L,
+    LENGTH_LL,
+    LENGTH_J,
+    LENGTH_Z,
+    LENGTH_T,
+    LENGTH_BIG_L
+} tLengthModifier;
+
+/** Type of the argument consumed by a printf conversion specification */
+typedef enum {
+    ARG_NONE,      //!< No argument, e.g. "%%"
+    ARG_SIGNED,    //!< Signed integer
+    ARG_UNSIGNED,  //!< Unsigned integer
+    ARG_DOUBLE,    //!< Floating point value
+    ARG_CHAR,      //!< Character
+    ARG_STRING,    //!< Null terminated string
+    ARG_POINTER,   //!< Pointer
+    ARG_COUNT      //!< Pointer to character count ("%n")
+} tArgType;
+
+/** Parsed printf conversion specification */
+typedef struct {
+    const char* flags;               //!< First flag character
+    size_t flagsLength;              //!< Number of flag characters
+    int width;                       //!< Field width, or -1 if not specified
+    int precision;                   //!< Precision, or -1 if not specified
+    bool widthArg;                   //!< Field width is given by an int argument ('*')
+    bool precisionArg;               //!< Precision is given by an int argument ('*')
+    tLengthModifier lengthModifier;  //!< Length modifier
+    char specifier;                  //!< Conversion specifier character
+    tArgType argType;                //!< Type of the argument
+} tConversion;
+#endif
+
+#if LOG_USE_MINIMAL_PRINTF
+/** Output buffer of the minimal printf formatter */
+typedef struct {
+    char* buffer;   //!< Destination buffer
+    size_t size;    //!< Size of the destination buffer
+    size_t length;  //!< Number of characters formatted, including any that did not fit in the buffer
+} tFormatOutput;
+#endif
+
+#if LOG_USE_COALESCE
+/** Last log message, which is compared with the next log message to detect repeats */
+typedef struct {
+    const char* fmt;                         //!< printf format string, or NULL if the log message cannot be coalesced
+    tLog_context* context;                   //!< Logger context, or NULL for the default context
+    const char* file;                        //!< Filename
+    int line;                                //!< Line number
+    int level;                               //!< Logging level
+#if LOG_USE_MODULES
+    int module;                              //!< Module index
+#endif
+    tLog_timestamp time;                     //!< Timestamp of the last log message that was written
+    uint32_t repeats;                        //!< Number of repeats that have been coalesced
+    size_t length;                           //!< Number of bytes of packed printf arguments
+    uint8_t args[LOG_COALESCE_ARGS_SIZE];    //!< Packed printf arguments
+} tCoalesceState;
+#endif
+
+#if LOG_USE_ASYNC
+typedef struct {
+    uint32_t sequence;                      //!< Queue position at which the slot can next be written (free) or read (full), plus one when full
+    tLog_timestamp time;                    //!< Timestamp value
+    int level;                              //!< Logging level of the log message
+    const char* file;                       //!< Filename
+    int line;                               //!< Line number
+#if LOG_DEFERRED_FORMAT
+    const char* fmt;                        //!< printf format string
+    size_t length;                          //!< Number of bytes of packed printf arguments
+    uint8_t data[LOG_ASYNC_MESSAGE_SIZE];   //!< Packed printf arguments
+#elif LOG_USE_CHUNK_OUTPUT
+    uint32_t length;                        //!< Number of characters of the formatted log message
+    uint32_t references;                    //!< Number of references to the log message held by chunk write drivers
+    char data[LOG_ASYNC_MESSAGE_SIZE] LOG_CHUNK_ALIGN;  //!< Formatted log message prefix and body
+#else
+    char data[LOG_ASYNC_MESSAGE_SIZE];      //!< Formatted log message body
+#endif
+} tQueueSlot;
+
+typedef struct {
+    uint32_t writePosition;                 //!< Queue position of the next slot to be reserved by a producer
+    uint32_t readPosition;                  //!< Queue position of the next slot to be printed by the consumer
+    tQueueSlot slots[LOG_ASYNC_QUEUE_LENGTH];  //!< Queue storage
+#if LOG_USE_COALESCE
+    uint32_t coalesceBusy;                  //!< 1 while a producer compares a log message with the last log message of the queue, otherwise 0
+    tCoalesceState coalesce;                //!< Last log message that was only queued, without the lock, and its repeat count
+#endif
+} tQueue;
+#endif
+
+#if LOG_USE_CRASH_LOG
+/** Crash log record, which holds a log message without formatting it */
+typedef struct {
+    uint32_t sequence;                       //!< Crash log position of the record plus one when it is committed, CRASH_RECORD_BUSY while it is written, otherwise a stale value
+#if LOG_CRASH_RECORD_CRC
+    uint32_t crc;                            //!< CRC-32 of the record from the filename pointer to the end of the packed printf arguments
 #endif
+    const char* file;                        //!< Filename
+    const char* fmt;                         //!< printf format string
+    tLog_timestamp time;                     //!< Timestamp value
+    int32_t line;                            //!< Line number
+    uint8_t level;                           //!< Logging level
+    uint8_t length;                          //!< Number of bytes of packed printf arguments
+    int16_t module;                          //!< Module index
+    uint8_t args[LOG_CRASH_ARGS_SIZE];       //!< Packed printf arguments
+} tCrashRecord;
 
+/** Crash-persistent RAM log: a ring of records, which survives a reset */
 typedef struct {
+    uint32_t magic;                          //!< LOG_CRASH_LOG_MAGIC if the crash log has been initialised
+    uint32_t length;                         //!< Number of records
+    uint32_t recordSize;                     //!< Size of a record in bytes
+    uint32_t crc;                            //!< CRC-32 of the magic number, length and record size
+    uint32_t writePosition;                  //!< Crash log position of the next record to be reserved by a writer
+    tCrashRecord records[LOG_CRASH_LOG_LENGTH];  //!< Ring of records
+} tCrashLog;
+#endif
+
+/** Logger context: the logging level, lock, callbacks and statistics of a logger instance */
+struct tLog_context {
     void* lockData;                          //!< Application-specific data object required by lock function
     tLog_lockFn lockFn;                      //!< Lock function
-    tLog_timestampFn timestampFn;            //!< Timestamp function
+    tLog_timedLockFn timedLockFn;            //!< Timed lock function, which is called instead of the lock function if it is set
+    uint32_t lockTimeout;                    //!< Timeout passed to the timed lock function
+    tLog_stats stats;                        //!< Numbers of dropped log messages
     int level;                               //!< Currently set logging level
+    int effectiveLevel;                      //!< Lowest logging level at which log messages are written to the console or passed to a callback
     bool consoleLoggingDisabled;             //!< Flag to suppress printing of log messages to the console
 #if LOG_USE_CALLBACKS
-    tCallback callbacks[LOG_MAX_CALLBACKS];  //!< Array of logging callback functions
+    tCallback callbacks[LOG_MAX_CALLBACKS];  //!< Array of logging callback functions, in registration slots
+    int callbackLevel;                       //!< Lowest logging level at which a callback is invoked
+    tCallbackSnapshot snapshot;              //!< Registered callbacks, sorted by ascending callback logging level
+#endif
+#if LOG_USE_COALESCE
+    tCoalesceState coalesce;                 //!< Last log message that was written with the lock held, and its repeat count
+#endif
+};
+
+typedef struct {
+    tLog_timestampFn timestampFn;            //!< Timestamp function
+    uint32_t timestampDivisor;               //!< Number of timestamp ticks per printed unit, or 0 if timestamps are printed unscaled
+#if LOG_USE_ASYNC
+    bool asyncEnabled;                       //!< Flag to queue log messages for printing to the console by log_drain()
+    bool queueInitialised;                   //!< Flag that indicates the queue slot sequence numbers have been initialised
+    tLog_contextIdFn contextIdFn;            //!< Context ID function, which selects the queue
+    tQueue queues[LOG_ASYNC_QUEUE_COUNT];    //!< Queues of log messages waiting to be printed to the console
+#if LOG_USE_CHUNK_OUTPUT
+    tLog_chunkWriteFn chunkWriteFn;          //!< Chunk write function, which transmits queued log messages
+    void* chunkWriteData;                    //!< Application-specific data object required by chunk write function
+#endif
+#endif
+#if LOG_USE_MODULES
+    int8_t moduleLevels[LOG_MAX_MODULES];    //!< Logging level of each module
+    bool moduleLevelSet[LOG_MAX_MODULES];    //!< Flag that indicates the module logging level overrides the level set by log_setLevel()
+#endif
+#if LOG_USE_CRASH_LOG
+    uint32_t crashLogState;                  //!< CRASH_LOG_UNCHECKED, CRASH_LOG_CHECKING or CRASH_LOG_READY, which is changed atomically
+    bool crashLogReplay;                     //!< Flag that suppresses recording of the log messages replayed by log_recoverCrashLog()
 #endif
 } tLogConfig;
 
 
+/* Public variable definitions ----------------------------------------------*/
+
+int log_effectiveLevel = LOG_TRACE;
+
+#if LOG_USE_MODULES
+int8_t log_effectiveModuleLevel[LOG_MAX_MODULES];  /* LOG_TRACE */
+#endif
+
+#if LOG_USE_SAMPLING
+uint32_t log_sampleRate[LOG_FATAL + 1];  /* all log messages are written */
+#endif
+
+
 /* Private variable definitions ---------------------------------------------*/
 
 static tLogConfig logConfig = {
-    .lockFn = NULL,
     .timestampFn = NULL,
+};
+
+/** Default logger context, which is used by log_log() and the logging macros */
+static tLog_context defaultContext = {
+    .lockFn = NULL,
+    .timedLockFn = NULL,
+    .lockTimeout = LOG_LOCK_WAIT_FOREVER,
     .level = LOG_TRACE,
+    .effectiveLevel = LOG_TRACE,
     .consoleLoggingDisabled = false,
+#if LOG_USE_CALLBACKS
+    .callbackLevel = LOG_LEVEL_OFF,
+#endif
 };
 
-static const char* level_strings[] = {
-  "TRACE", "DEBUG", "INFO", "WARN", "ERROR", "FATAL"
+#if LOG_MAX_CONTEXTS > 0U
+/** Logger contexts that are allocated by log_createContext() */
+static tLog_context contextPool[LOG_MAX_CONTEXTS];
+
+/** Number of logger contexts that have been allocated from contextPool */
+static size_t contextCount = 0U;
+#endif
+
+/** Log message prefix text from the timestamp to the filename, for each logging level */
+static const tLevelPrefix level_prefixes[] = {
+  LEVEL_PREFIX( "\x1b[94m", "TRACE" ),
+  LEVEL_PREFIX( "\x1b[36m", "DEBUG" ),
+  LEVEL_PREFIX( "\x1b[32m", "INFO " ),
+  LEVEL_PREFIX( "\x1b[33m", "WARN " ),
+  LEVEL_PREFIX( "\x1b[31m", "ERROR" ),
+  LEVEL_PREFIX( "\x1b[31m", "FATAL" )
 };
 
-#if LOG_USE_COLOR
-static const char *level_colors[] = {
-  "\x1b[94m", "\x1b[36m", "\x1b[32m", "\x1b[33m", "\x1b[31m", "\x1b[31m"
+#if LOG_USE_COALESCE
+/** Format string of the log message that reports the number of coalesced repeats */
+static const char log_repeatedFormat[] = "last message repeated %lu times";
+#endif
+
+#if LOG_USE_CRASH_LOG
+/** Crash-persistent RAM log, which is not initialised at startup */
+static tCrashLog crashLog LOG_CRASH_LOG_SECTION;
+
+/** CRC-32 (polynomial 0xEDB88320) lookup table, indexed by 4-bit value */
+static const uint32_t crc32Nibbles[16] = {
+  0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL, 0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+  0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL, 0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL
 };
 #endif
 
+#if LOG_USE_BINARY_SINK
+/** Reference object for the string addresses in binary log records, which the decoder finds in the ELF symbol table */
+static const char log_binaryAnchor[] = "log_ec";
+#endif
+
+/** Two-digit decimal strings "00" to "99", for fast integer formatting */
+static const char digit_pairs[] =
+  "00010203040506070809" "10111213141516171819" "20212223242526272829" "30313233343536373839" "40414243444546474849"
+  "50515253545556575859" "60616263646566676869" "70717273747576777879" "80818283848586878889" "90919293949596979899";
+
+
+#if LOG_USE_STRING_TABLE
+/* Bounds of the call site table, which are defined by the linker */
+extern const tLog_site __start_log_ec_sites[] __attribute__(( weak ));
+extern const tLog_site __stop_log_ec_sites[] __attribute__(( weak ));
+#endif
 
 /* Private function declarations --------------------------------------------*/
 
-static uint32_t getTimestamp( void );
+static tLog_timestamp getTimestamp( void );
+#if LOG_USE_CYCLE_COUNTER
+static inline tLog_timestamp readCycleCounter( void );
+#endif
+static inline size_t writtenLength( int printed, size_t size );
+static size_t appendChars( char* buffer, size_t size, size_t length, const char* str, size_t strLength );
+static size_t appendUnsigned( char* buffer, size_t size, size_t length, tDecimal value, size_t minWidth );
+static size_t log_formatPrefixHead( char* buffer, size_t size, tLog_event* ev );
+static size_t log_formatPrefixTail( char* buffer, size_t size, size_t length, tLog_event* ev );
+#if LOG_USE_LINE_BUFFER || LOG_USE_CHUNK_OUTPUT || LOG_USE_MMAP_SINK
+static size_t log_formatPrefix( char* buffer, size_t size, tLog_event* ev );
+#endif
+#if !LOG_USE_LINE_BUFFER
+static int log_printPrefix( tLog_event* ev );
+#endif
+#if LOG_USE_MESSAGE_BUFFER || ( LOG_USE_ASYNC && !LOG_USE_CHUNK_OUTPUT )
+static int log_printText( tLog_event* ev, const char* text );
+#endif
 static int log_print( tLog_event* ev );
-static bool lock( void );
-static bool unlock( void );
+static inline tLog_context* eventContext( const tLog_event* ev );
+static bool writesToConsole( const tLog_context* context, const tLog_event* ev );
+static bool lock( tLog_context* context );
+static bool unlock( tLog_context* context );
+static inline void countEvent( uint32_t* counter );
+static void countDropped( tLog_context* context, int level, uint32_t* reason );
+#if LOG_USE_STATS
+static void countDuration( uint32_t* histogram, tLog_timestamp start );
+#endif
+static void updateEffectiveLevel( tLog_context* context );
+#if LOG_USE_MODULES
+static int consoleLevel( int module );
+#endif
+static int logEvent( tLog_event* ev, va_list ap );
+static int writeEvent( tLog_event* ev, va_list ap );
+static int deliverEvent( tLog_context* context, tLog_event* ev, va_list ap, bool queueToConsole, bool printToConsole, bool invokeCallbacks );
+#if LOG_USE_COALESCE
+static bool coalesceEvent( tLog_context* context, const tLog_event* ev, va_list ap, bool lockAcquired );
+static void flushRepeats( tCoalesceState* last, bool lockAcquired );
+static void writeRepeats( tLog_event* ev, bool lockAcquired, const char* fmt, ... );
+#endif
+#if LOG_USE_CRASH_LOG
+static uint32_t crc32( uint32_t crc, const void* data, size_t size );
+static uint32_t crashLogHeaderCrc( void );
+#if LOG_CRASH_RECORD_CRC
+static uint32_t crashRecordCrc( const tCrashRecord* record );
+#endif
+static void resetCrashLog( void );
+static void recordCrashEvent( const tLog_event* ev, va_list ap );
+static int replayEvent( tLog_event* ev, const char* fmt, ... );
+#endif
+#if LOG_USE_BATCH_SINK || LOG_USE_MMAP_SINK
+static size_t formatEventText( char* buffer, size_t size, tLog_event* ev );
+#endif
+#if LOG_USE_FIELDS
+static size_t appendSigned( char* buffer, size_t size, size_t length, int64_t value );
+static size_t formatFields( char* buffer, size_t size, const char* msg, const tLog_field* fields, size_t fieldCount );
+static void renderFields( tLog_event* ev );
+#endif
+#if LOG_USE_FIELDS || LOG_DEFERRED_FORMAT
+static int logText( tLog_event* ev, const char* fmt, ... );
+#endif
+#if LOG_DEFERRED_FORMAT
+static int logPacked( tLog_event* ev, const uint8_t* args, size_t argsLength );
+#endif
+#if LOG_USE_BATCH_SINK
+static void deliverBatch( tLog_batchSink* sink );
+#endif
+#if LOG_USE_MMAP_SINK
+static bool mapLogFile( tLog_mmapSink* sink );
+static void unmapLogFile( tLog_mmapSink* sink );
+static void rotateLogFiles( const tLog_mmapSink* sink );
+#endif
+#if LOG_USE_BINARY_SINK
+static size_t encodeVarint( uint8_t* buffer, size_t size, size_t length, uintmax_t value );
+static size_t encodeSigned( uint8_t* buffer, size_t size, size_t length, intmax_t value );
+static size_t encodeArgs( uint8_t* buffer, size_t size, size_t length, const char* fmt, va_list ap, bool* truncated );
+static void writeBinaryRecord( tLog_binarySink* sink, uint8_t* record, size_t length );
+#endif
+#if LOG_USE_ATOMICS
+static inline uint32_t atomicLoad( uint32_t* value );
+static inline void atomicStore( uint32_t* value, uint32_t newValue );
+static inline bool atomicCompareExchange( uint32_t* value, uint32_t expected, uint32_t desired );
+static inline uint32_t atomicFetchAdd( uint32_t* value, uint32_t delta );
+#endif
+#if LOG_USE_CALLBACKS
+static bool lockRegistration( tLog_context* context );
+static bool removeCallback( tLog_context* context, tLog_callbackFn cbFn, void* cbData );
+static void buildCallbackSnapshot( tLog_context* context );
+#endif
+#if LOG_USE_ASYNC
+static tQueueSlot* peekQueue( tQueue* queue );
+static tQueue* producerQueue( void );
+static int enqueue( tLog_event* ev, const uint8_t* packedArgs, size_t packedLength );
+#if LOG_USE_CHUNK_OUTPUT
+static tQueueSlot* chunkSlot( const char* chunk );
+#endif
+#endif
+#if LOG_USE_FORMAT_PARSER
+static const char* parseConversion( const char* fmt, tConversion* conv );
+static intmax_t readSignedArg( tLengthModifier lengthModifier, va_list* ap );
+static uintmax_t readUnsignedArg( tLengthModifier lengthModifier, va_list* ap );
+static size_t stringLength( const char* str, int precision );
+#endif
+#if LOG_USE_MINIMAL_PRINTF
+static void outputChars( tFormatOutput* out, const char* str, size_t length );
+static void outputRepeat( tFormatOutput* out, char c, size_t count );
+static void outputField( tFormatOutput* out, const tConversion* conv, bool zeroPad, const char* prefix, size_t zeros, const char* body, size_t bodyLength );
+static size_t formatDigits( char* end, uintmax_t value, unsigned int base, bool upperCase );
+#if LOG_MINIMAL_PRINTF_FLOAT
+static size_t formatDouble( char* end, double value, int precision );
+#endif
+static void formatConversion( tFormatOutput* out, tConversion* conv, const char* spec, size_t specLength, va_list* ap );
+#endif
+#if LOG_USE_ARG_PACKING
+static size_t integerArgSize( tLengthModifier lengthModifier );
+static size_t packArgs( uint8_t* buffer, size_t size, const char* fmt, va_list ap, bool* truncated );
+#endif
+#if LOG_USE_FORMAT_SPEC
+static int formatSpec( char* buffer, size_t size, const char* spec, ... );
+#endif
+#if LOG_USE_ARG_RENDERING
+static size_t renderArgs( char* buffer, size_t size, const char* fmt, const uint8_t* args, size_t argsLength );
+#endif
 
 
 /* Private function definitions ---------------------------------------------*/
@@ -89,152 +616,3310 @@ static bool unlock( void );
 /**
  * @brief Get timestamp value.
  * 
- * @return Timestamp, as an unsigned integer value (uint32_t).
+ * @return Timestamp, as an unsigned integer value (tLog_timestamp).
  */
-static uint32_t getTimestamp( void )
+static tLog_timestamp getTimestamp( void )
 {
+#if LOG_USE_CYCLE_COUNTER
+    return (tLog_timestamp)LOG_READ_CYCLE_COUNTER();  /* a single register read, without a function call */
+#else
     return ( NULL != logConfig.timestampFn ) ? logConfig.timestampFn() : 0U;
+#endif
 }
 
+#if LOG_USE_CYCLE_COUNTER
 /**
- * @brief Write log event data to the console.
- * 
- * @param ev Log event data.
- * @return Number of characters printed if successful. On error, it returns a negative value.
+ * @brief Read the CPU cycle counter, or the monotonic clock if the CPU has no cycle counter.
+ *
+ * @return Cycle count, truncated to the timestamp width.
  */
-static int log_print( tLog_event* ev )
+static inline tLog_timestamp readCycleCounter( void )
 {
-#if LOG_USE_COLOR
-    int printfResult = CONSOLE_PRINTF( "%8" PRIu32 " %s%-5s\x1b[0m \x1b[90m%s:%d:\x1b[0m ",
-            ev->time, level_colors[ev->level], level_strings[ev->level], ev->file, ev->line );  /* message prefix: colour */
+#if defined( __arm__ )
+    return (tLog_timestamp)DWT_CYCCNT;
+#elif defined( __x86_64__ ) || defined( __i386__ )
+    return (tLog_timestamp)__builtin_ia32_rdtsc();
+#elif defined( __aarch64__ )
+    uint64_t count;
+    __asm__ volatile( "mrs %0, cntvct_el0" : "=r"( count ) );
+    return (tLog_timestamp)count;
 #else
-    int printfResult = CONSOLE_PRINTF( "%8" PRIu32 " %-5s %s:%d: ",
-             ev->time, level_strings[ev->level], ev->file, ev->line );  /* message prefix: monochrome */
+    struct timespec now;
+#if defined( CLOCK_MONOTONIC_RAW )
+    (void)clock_gettime( CLOCK_MONOTONIC_RAW, &now );
+#else
+    (void)clock_gettime( CLOCK_MONOTONIC, &now );
+#endif
+    return (tLog_timestamp)( ( (uint64_t)now.tv_sec * 1000000000U ) + (uint64_t)now.tv_nsec );
 #endif
-    int vprintfResult = CONSOLE_VPRINTF(ev->fmt, ev->ap);  /* message body */
-    return ( ( printfResult >= 0 ) && ( vprintfResult >= 0 ) ) ? ( printfResult + vprintfResult ) : -1;
 }
+#endif
 
-static bool lock( void )
+/**
+ * @brief Get the number of characters written by a call to snprintf() or vsnprintf().
+ *
+ * @param printed Value returned by snprintf() or vsnprintf().
+ * @param size Size of the destination buffer.
+ * @return Number of characters written to the buffer, excluding the null terminator.
+ */
+static inline size_t writtenLength( int printed, size_t size )
 {
-    bool lockAcquired = true;  /* if no lock function is set, lock acquisition always succeeds */
-    if( NULL != logConfig.lockFn )
-    {
-        lockAcquired = logConfig.lockFn( true, logConfig.lockData );
-    }
-    return lockAcquired;
+    return ( ( printed < 0 ) || ( 0U == size ) ) ? 0U : ( (size_t)printed < size ) ? (size_t)printed : ( size - 1U );
 }
 
-static bool unlock( void )
+/**
+ * @brief Append characters to a buffer, truncating them if the buffer is full.
+ *
+ * @param buffer Destination buffer.
+ * @param size Size of the destination buffer.
+ * @param length Number of characters already in the buffer (less than size).
+ * @param str Characters to be appended.
+ * @param strLength Number of characters to be appended.
+ * @return Number of characters in the buffer, excluding the null terminator.
+ */
+static size_t appendChars( char* buffer, size_t size, size_t length, const char* str, size_t strLength )
 {
-    bool lockReleased = true;  /* if no lock function is set, lock release always succeeds */
-    if( NULL != logConfig.lockFn )
+    if( strLength >= ( size - length ) )
     {
-        lockReleased = logConfig.lockFn( false, logConfig.lockData );
+        strLength = size - length - 1U;  /* truncate */
     }
-    return lockReleased;
+    memcpy( &buffer[length], str, strLength );
+    length += strLength;
+    buffer[length] = '\0';
+    return length;
 }
 
-
-/* Public function definitions ----------------------------------------------*/
-
-void log_setLockFn( tLog_lockFn lockFn, void* lockData )
+/**
+ * @brief Append an unsigned decimal integer to a buffer, right-justified in a 
+ *        field of at least minWidth characters.
+ *
+ * Digits are converted two at a time using a lookup table, instead of printf().
+ *
+ * @param buffer Destination buffer.
+ * @param size Size of the destination buffer.
+ * @param length Number of characters already in the buffer (less than size).
+ * @param value Value to be appended.
+ * @param minWidth Minimum field width.
+ * @return Number of characters in the buffer, excluding the null terminator.
+ */
+static size_t appendUnsigned( char* buffer, size_t size, size_t length, tDecimal value, size_t minWidth )
 {
-    logConfig.lockFn = lockFn;
-    logConfig.lockData = lockData;
+    char digits[20U];  /* a uint64_t value has at most 20 decimal digits */
+    size_t index = sizeof( digits );
+    while( value >= 100U )
+    {
+        const char* pair = &digit_pairs[( value % 100U ) * 2U];
+        value /= 100U;
+        digits[--index] = pair[1];
+        digits[--index] = pair[0];
+    }
+    if( value >= 10U )
+    {
+        digits[--index] = digit_pairs[( value * 2U ) + 1U];
+        digits[--index] = digit_pairs[value * 2U];
+    }
+    else
+    {
+        digits[--index] = (char)( '0' + value );
+    }
+    size_t digitCount = sizeof( digits ) - index;
+    for( ; ( minWidth > digitCount ) && ( length < ( size - 1U ) ); minWidth-- )
+    {
+        buffer[length++] = ' ';  /* pad */
+    }
+    return appendChars( buffer, size, length, &digits[index], digitCount );
 }
 
-void log_setTimestampFn( tLog_timestampFn timestampFn )
+/**
+ * @brief Format the start of the log message prefix (timestamp and logging level), which precedes the filename, into a buffer.
+ *
+ * The timestamp is divided by the divisor set by log_setTimestampDivisor().
+ * 
+ * @param buffer Destination buffer.
+ * @param size Size of the destination buffer (greater than 0).
+ * @param ev Log event data.
+ * @return Number of characters written to the buffer, excluding the null terminator.
+ */
+static size_t log_formatPrefixHead( char* buffer, size_t size, tLog_event* ev )
 {
-    logConfig.timestampFn = timestampFn;
+    const tLevelPrefix* levelPrefix = &level_prefixes[ev->level];
+    uint32_t divisor = logConfig.timestampDivisor;
+    tLog_timestamp time = ( divisor > 1U ) ? ( ev->time / divisor ) : ev->time;  /* scaled when printed, not when captured */
+    size_t length = appendUnsigned( buffer, size, 0U, time, 8U );
+    return appendChars( buffer, size, length, levelPrefix->text, levelPrefix->length );
 }
 
-void log_setLevel( int level )
+/**
+ * @brief Append the end of the log message prefix (line number and separator), which follows the filename, to a buffer.
+ * 
+ * @param buffer Destination buffer.
+ * @param size Size of the destination buffer (greater than 0).
+ * @param length Number of characters already in the buffer (less than size).
+ * @param ev Log event data.
+ * @return Number of characters in the buffer, excluding the null terminator.
+ */
+static size_t log_formatPrefixTail( char* buffer, size_t size, size_t length, tLog_event* ev )
 {
-    logConfig.level = level;
+    length = appendChars( buffer, size, length, ":", 1U );
+    length = appendUnsigned( buffer, size, length, (uint32_t)ev->line, 0U );
+    return appendChars( buffer, size, length, LEVEL_PREFIX_END, sizeof( LEVEL_PREFIX_END ) - 1U );
 }
 
-void log_off( void )
+#if LOG_USE_LINE_BUFFER || LOG_USE_CHUNK_OUTPUT || LOG_USE_MMAP_SINK
+/**
+ * @brief Format the log message prefix (timestamp, logging level, filename and line number) into a buffer.
+ *
+ * The prefix has a fixed layout, so it is formatted with table lookups and 
+ * copies, without calling printf(). It is equivalent to the printf() format
+ * "%8" PRIu32 " %-5s %s:%d: " (with colour escape codes if LOG_USE_COLOR is set).
+ * 
+ * @param buffer Destination buffer.
+ * @param size Size of the destination buffer (greater than 0).
+ * @param ev Log event data.
+ * @return Number of characters written to the buffer, excluding the null terminator.
+ */
+static size_t log_formatPrefix( char* buffer, size_t size, tLog_event* ev )
 {
-    logConfig.consoleLoggingDisabled = true;
+    size_t length = log_formatPrefixHead( buffer, size, ev );
+    length = appendChars( buffer, size, length, ev->file, strlen( ev->file ) );
+    return log_formatPrefixTail( buffer, size, length, ev );
 }
+#endif
 
-void log_on( void )
+#if !LOG_USE_LINE_BUFFER
+/**
+ * @brief Write the log message prefix (timestamp, logging level, filename and line number) to the console.
+ *
+ * The filename is printed by its own conversion, so it is never truncated. 
+ * The start and end of the prefix are formatted into one buffer, as two
+ * strings.
+ * 
+ * @param ev Log event data.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+static int log_printPrefix( tLog_event* ev )
 {
-    logConfig.consoleLoggingDisabled = false;
+    char prefix[LOG_PREFIX_SIZE];
+    size_t headLength = log_formatPrefixHead( prefix, sizeof( prefix ), ev );
+    char* tail = &prefix[headLength + 1U];
+    (void)log_formatPrefixTail( tail, sizeof( prefix ) - headLength - 1U, 0U, ev );
+    return CONSOLE_PRINTF( "%s%s%s", prefix, ev->file, tail );
 }
+#endif
 
-#if LOG_USE_CALLBACKS
-bool log_registerCallbackFn( tLog_callbackFn cbFn, void* cbData, int cbLogLevel )
+#if LOG_USE_MESSAGE_BUFFER || ( LOG_USE_ASYNC && !LOG_USE_CHUNK_OUTPUT )
+/**
+ * @brief Write the log message prefix and an already formatted log message body to the console.
+ * 
+ * @param ev Log event data.
+ * @param text Formatted, null terminated log message body.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+static int log_printText( tLog_event* ev, const char* text )
 {
-    bool registered = false;
-    log_unregisterCallbackFn( cbFn, cbData );  /* remove existing registration, if any, to prevent duplicates */
-
-    for( size_t i = 0U; ( !registered ) && ( i < LOG_MAX_CALLBACKS); i++ )
+#if LOG_USE_LINE_BUFFER
+    char line[LOG_CONSOLE_LINE_SIZE];
+    size_t length = log_formatPrefix( line, sizeof( line ), ev );
+    size_t textLength = strlen( text );
+    if( textLength >= ( sizeof( line ) - length ) )
     {
-        if( NULL == logConfig.callbacks[i].cbFn )
-        {
-            /* Register the new callback function pointer, logging level and data object */
-            logConfig.callbacks[i] = (tCallback) { cbFn, cbData, cbLogLevel };
-            registered = true;
-        }
+        textLength = sizeof( line ) - length - 1U;  /* log message has been truncated */
     }
-    return registered;
+    memcpy( &line[length], text, textLength );
+    length += textLength;
+    line[length] = '\0';
+    return LOG_WRITE_LINE( line, length );
+#else
+    int printfResult = log_printPrefix( ev );
+    int bodyResult = CONSOLE_PRINTF( "%s", text );
+    return ( ( printfResult >= 0 ) && ( bodyResult >= 0 ) ) ? ( printfResult + bodyResult ) : -1;
+#endif
 }
+#endif
 
-void log_unregisterCallbackFn( tLog_callbackFn cbFn, void* cbData )
-{
-    bool finished = false;
-    for( size_t i = 0U; ( !finished ) && ( i < LOG_MAX_CALLBACKS ); i++ )
-    {
-        if( ( cbFn == logConfig.callbacks[i].cbFn ) && ( cbData == logConfig.callbacks[i].cbData ) )
-        {
-            /* Delete the previously registered function pointer */
-            logConfig.callbacks[i] = (tCallback) { NULL, NULL, LOG_TRACE };
-            finished = true;
-        }
-    }
+/**
+ * @brief Write log event data to the console.
+ * 
+ * @param ev Log event data.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+static int log_print( tLog_event* ev )
+{
+#if LOG_USE_MESSAGE_BUFFER
+    return log_printText( ev, log_eventText( ev, NULL ) );  /* message body, formatted once for the console and all callbacks */
+#elif LOG_USE_LINE_BUFFER
+    /* format the message prefix and body into one buffer, then write it with a single call */
+    char line[LOG_CONSOLE_LINE_SIZE];
+    size_t length = log_formatPrefix( line, sizeof( line ), ev );
+    length += writtenLength( LOG_VSNPRINTF( &line[length], sizeof( line ) - length, ev->fmt, ev->ap ), sizeof( line ) - length );
+    return LOG_WRITE_LINE( line, length );
+#else
+    int printfResult = log_printPrefix( ev );
+    int vprintfResult = CONSOLE_VPRINTF(ev->fmt, ev->ap);  /* message body */
+    return ( ( printfResult >= 0 ) && ( vprintfResult >= 0 ) ) ? ( printfResult + vprintfResult ) : -1;
+#endif
+}
+
+/**
+ * @brief Get the logger context of a log event.
+ *
+ * @param ev Log event data.
+ * @return Logger context, which is the default context if the event context is NULL.
+ */
+static inline tLog_context* eventContext( const tLog_event* ev )
+{
+    return ( NULL != ev->context ) ? ev->context : &defaultContext;
+}
+
+/**
+ * @brief Check whether a log event is written to the console by its logger context.
+ *
+ * The per-module logging levels only apply to the default context.
+ *
+ * @param context Logger context of the log event.
+ * @param ev Log event data.
+ * @return true if the log event is written to the console.
+ */
+static bool writesToConsole( const tLog_context* context, const tLog_event* ev )
+{
+#if LOG_USE_MODULES
+    int level = ( &defaultContext == context ) ? consoleLevel( ev->module ) : context->level;
+#else
+    int level = context->level;
+#endif
+    return !context->consoleLoggingDisabled && ( ev->level >= level );
+}
+
+static bool lock( tLog_context* context )
+{
+    bool lockAcquired = true;  /* if no lock function is set, lock acquisition always succeeds */
+    if( NULL != context->timedLockFn )
+    {
+        lockAcquired = context->timedLockFn( true, context->lockTimeout, context->lockData );
+    }
+    else if( NULL != context->lockFn )
+    {
+        lockAcquired = context->lockFn( true, context->lockData );
+    }
+    return lockAcquired;
+}
+
+static bool unlock( tLog_context* context )
+{
+    bool lockReleased = true;  /* if no lock function is set, lock release always succeeds */
+    if( NULL != context->timedLockFn )
+    {
+        lockReleased = context->timedLockFn( false, 0U, context->lockData );
+    }
+    else if( NULL != context->lockFn )
+    {
+        lockReleased = context->lockFn( false, context->lockData );
+    }
+    return lockReleased;
+}
+
+/**
+ * @brief Increment a statistics counter that is updated without the lock.
+ *
+ * The counter is updated atomically if atomic operations are compiled.
+ *
+ * @param counter Statistics counter.
+ */
+static inline void countEvent( uint32_t* counter )
+{
+#if LOG_USE_ATOMICS
+    (void)atomicFetchAdd( counter, 1U );
+#else
+    (*counter)++;  /* no atomic operations are compiled: a concurrent update may not be counted */
+#endif
+}
+
+/**
+ * @brief Count a dropped log message.
+ *
+ * @param context Logger context of the log message.
+ * @param level Logging level of the log message.
+ * @param reason Counter of the reason for which the log message was dropped.
+ */
+static void countDropped( tLog_context* context, int level, uint32_t* reason )
+{
+    countEvent( &context->stats.dropped[level] );
+    countEvent( reason );
+}
+
+#if LOG_USE_STATS
+/**
+ * @brief Count a duration in its log2 bucket of a duration histogram, which is updated with the lock held.
+ *
+ * @param histogram Duration histogram of LOG_STATS_BUCKETS buckets.
+ * @param start Timestamp at the start of the measured interval.
+ */
+static void countDuration( uint32_t* histogram, tLog_timestamp start )
+{
+    tLog_timestamp ticks = getTimestamp() - start;
+    size_t bucket = 0U;
+    while( ( 0U != ticks ) && ( bucket < ( LOG_STATS_BUCKETS - 1U ) ) )
+    {
+        ticks >>= 1;
+        bucket++;
+    }
+    histogram[bucket]++;
+}
+#endif
+
+/**
+ * @brief Recalculate the lowest logging level at which log messages of a logger
+ *        context are written to the console or passed to a callback.
+ *
+ * @param context Logger context.
+ */
+static void updateEffectiveLevel( tLog_context* context )
+{
+    int effectiveLevel = context->consoleLoggingDisabled ? LOG_LEVEL_OFF : context->level;
+#if LOG_USE_CALLBACKS
+    int callbackLevel = LOG_LEVEL_OFF;
+    for( size_t i = 0U; i < LOG_MAX_CALLBACKS; i++ )
+    {
+        tCallback* cb = &context->callbacks[i];
+        if( ( NULL != cb->cbFn ) && ( cb->cbLogLevel < callbackLevel ) )
+        {
+            callbackLevel = cb->cbLogLevel;
+        }
+    }
+    context->callbackLevel = callbackLevel;
+    if( callbackLevel < effectiveLevel )
+    {
+        effectiveLevel = callbackLevel;
+    }
+#endif
+    context->effectiveLevel = effectiveLevel;
+    if( &defaultContext != context )
+    {
+        return;  /* the logging macros and module logging levels only use the default context */
+    }
+    log_effectiveLevel = effectiveLevel;
+#if LOG_USE_MODULES
+    for( int module = 0; module < (int)LOG_MAX_MODULES; module++ )
+    {
+        int moduleLevel = context->consoleLoggingDisabled ? LOG_LEVEL_OFF : consoleLevel( module );
+#if LOG_USE_CALLBACKS
+        moduleLevel = ( callbackLevel < moduleLevel ) ? callbackLevel : moduleLevel;
+#endif
+        log_effectiveModuleLevel[module] = (int8_t)moduleLevel;
+    }
+#endif
+}
+
+#if LOG_USE_MODULES
+/**
+ * @brief Get the logging level at which log messages of a module are written to the console.
+ *
+ * @param module Module index.
+ * @return Module logging level, or the logging level set by log_setLevel() if the module level is not set.
+ */
+static int consoleLevel( int module )
+{
+    return logConfig.moduleLevelSet[module] ? logConfig.moduleLevels[module] : defaultContext.level;
+}
+#endif
+
+#if LOG_USE_FORMAT_PARSER
+/**
+ * @brief Parse a printf conversion specification.
+ *
+ * @param fmt Pointer to the character that follows the '%' character.
+ * @param conv Parsed conversion specification.
+ * @return Pointer to the character that follows the conversion specification.
+ */
+static const char* parseConversion( const char* fmt, tConversion* conv )
+{
+    *conv = (tConversion) { .flags = fmt, .width = -1, .precision = -1, .lengthModifier = LENGTH_NONE };
+
+    while( ( '\0' != *fmt ) && ( NULL != strchr( "-+ #0", *fmt ) ) )
+    {
+        fmt++;
+    }
+    conv->flagsLength = (size_t)( fmt - conv->flags );
+
+    if( '*' == *fmt )
+    {
+        conv->widthArg = true;
+        fmt++;
+    }
+    else
+    {
+        for( conv->width = ( ( *fmt >= '0' ) && ( *fmt <= '9' ) ) ? 0 : -1; ( *fmt >= '0' ) && ( *fmt <= '9' ); fmt++ )
+        {
+            conv->width = ( conv->width * 10 ) + ( *fmt - '0' );
+        }
+    }
+
+    if( '.' == *fmt )
+    {
+        fmt++;
+        conv->precision = 0;
+        if( '*' == *fmt )
+        {
+            conv->precisionArg = true;
+            fmt++;
+        }
+        for( ; ( *fmt >= '0' ) && ( *fmt <= '9' ); fmt++ )
+        {
+            conv->precision = ( conv->precision * 10 ) + ( *fmt - '0' );
+        }
+    }
+
+    switch( *fmt )
+    {
+        case 'h': conv->lengthModifier = ( 'h' == fmt[1] ) ? LENGTH_HH : LENGTH_H; break;
+        case 'l': conv->lengthModifier = ( 'l' == fmt[1] ) ? LENGTH_LL : LENGTH_L; break;
+        case 'j': conv->lengthModifier = LENGTH_J; break;
+        case 'z': conv->lengthModifier = LENGTH_Z; break;
+        case 't': conv->lengthModifier = LENGTH_T; break;
+        case 'L': conv->lengthModifier = LENGTH_BIG_L; break;
+        default: break;
+    }
+    fmt += ( ( LENGTH_HH == conv->lengthModifier ) || ( LENGTH_LL == conv->lengthModifier ) ) ? 2 :
+           ( LENGTH_NONE == conv->lengthModifier ) ? 0 : 1;
+
+    conv->specifier = *fmt;
+    switch( conv->specifier )
+    {
+        case 'd': case 'i': conv->argType = ARG_SIGNED; break;
+        case 'u': case 'o': case 'x': case 'X': conv->argType = ARG_UNSIGNED; break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': conv->argType = ARG_DOUBLE; break;
+        case 'c': conv->argType = ARG_CHAR; break;
+        case 's': conv->argType = ARG_STRING; break;
+        case 'p': conv->argType = ARG_POINTER; break;
+        case 'n': conv->argType = ARG_COUNT; break;
+        default: conv->argType = ARG_NONE; break;  /* "%%", or an invalid conversion specification */
+    }
+    return ( '\0' != *fmt ) ? ( fmt + 1 ) : fmt;
+}
+
+/**
+ * @brief Read a signed integer argument from a variadic arguments list.
+ *
+ * @param lengthModifier Length modifier of the conversion specification.
+ * @param ap Pointer to printf variadic arguments list.
+ * @return Argument value.
+ */
+static intmax_t readSignedArg( tLengthModifier lengthModifier, va_list* ap )
+{
+    intmax_t value;
+    switch( lengthModifier )
+    {
+        case LENGTH_HH: value = (signed char)va_arg( *ap, int ); break;
+        case LENGTH_H: value = (short)va_arg( *ap, int ); break;
+        case LENGTH_L: value = va_arg( *ap, long ); break;
+        case LENGTH_LL: value = va_arg( *ap, long long ); break;
+        case LENGTH_J: value = va_arg( *ap, intmax_t ); break;
+        case LENGTH_Z: value = (intmax_t)va_arg( *ap, size_t ); break;
+        case LENGTH_T: value = va_arg( *ap, ptrdiff_t ); break;
+        default: value = va_arg( *ap, int ); break;
+    }
+    return value;
+}
+
+/**
+ * @brief Read an unsigned integer argument from a variadic arguments list.
+ *
+ * @param lengthModifier Length modifier of the conversion specification.
+ * @param ap Pointer to printf variadic arguments list.
+ * @return Argument value.
+ */
+static uintmax_t readUnsignedArg( tLengthModifier lengthModifier, va_list* ap )
+{
+    uintmax_t value;
+    switch( lengthModifier )
+    {
+        case LENGTH_HH: value = (unsigned char)va_arg( *ap, unsigned int ); break;
+        case LENGTH_H: value = (unsigned short)va_arg( *ap, unsigned int ); break;
+        case LENGTH_L: value = va_arg( *ap, unsigned long ); break;
+        case LENGTH_LL: value = va_arg( *ap, unsigned long long ); break;
+        case LENGTH_J: value = va_arg( *ap, uintmax_t ); break;
+        case LENGTH_Z: value = va_arg( *ap, size_t ); break;
+        case LENGTH_T: value = (uintmax_t)va_arg( *ap, ptrdiff_t ); break;
+        default: value = va_arg( *ap, unsigned int ); break;
+    }
+    return value;
+}
+
+/**
+ * @brief Get the number of characters of a string printed by a "%s" conversion.
+ *
+ * As printf does, no more than precision characters are read, so the string
+ * need not be null terminated if a precision is specified.
+ *
+ * @param str String.
+ * @param precision Precision of the conversion specification, or -1 if not specified.
+ * @return Length of the string, limited to the precision.
+ */
+static size_t stringLength( const char* str, int precision )
+{
+    size_t length = 0U;
+    while( ( ( precision < 0 ) || ( length < (size_t)precision ) ) && ( '\0' != str[length] ) )
+    {
+        length++;
+    }
+    return length;
+}
+#endif
+
+#if LOG_USE_MINIMAL_PRINTF
+/**
+ * @brief Append characters to the output of the minimal printf formatter.
+ *
+ * Characters that do not fit in the buffer are counted, but not written.
+ *
+ * @param out Formatter output.
+ * @param str Characters to be appended.
+ * @param length Number of characters to be appended.
+ */
+static void outputChars( tFormatOutput* out, const char* str, size_t length )
+{
+    if( out->length < out->size )
+    {
+        size_t freeSpace = out->size - out->length - 1U;  /* leave space for the null terminator */
+        memcpy( &out->buffer[out->length], str, ( length < freeSpace ) ? length : freeSpace );
+    }
+    out->length += length;
+}
+
+/**
+ * @brief Append a repeated character to the output of the minimal printf formatter.
+ *
+ * @param out Formatter output.
+ * @param c Character to be appended.
+ * @param count Number of times the character is appended.
+ */
+static void outputRepeat( tFormatOutput* out, char c, size_t count )
+{
+    for( ; count > 0U; count-- )
+    {
+        outputChars( out, &c, 1U );
+    }
+}
+
+/**
+ * @brief Append a formatted conversion, padded to the field width.
+ *
+ * @param out Formatter output.
+ * @param conv Conversion specification, with the field width resolved.
+ * @param zeroPad true if the field may be padded with leading zeros ('0' flag).
+ * @param prefix Sign or "0x" prefix, which precedes any leading zeros.
+ * @param zeros Number of leading zeros required by the precision.
+ * @param body Formatted characters.
+ * @param bodyLength Number of formatted characters.
+ */
+static void outputField( tFormatOutput* out, const tConversion* conv, bool zeroPad, const char* prefix, size_t zeros, const char* body, size_t bodyLength )
+{
+    size_t prefixLength = strlen( prefix );
+    size_t fieldLength = prefixLength + zeros + bodyLength;
+    size_t padding = ( ( conv->width > 0 ) && ( (size_t)conv->width > fieldLength ) ) ? ( (size_t)conv->width - fieldLength ) : 0U;
+    bool leftJustify = ( NULL != memchr( conv->flags, '-', conv->flagsLength ) );
+    zeroPad = zeroPad && !leftJustify && ( NULL != memchr( conv->flags, '0', conv->flagsLength ) );
+
+    if( !leftJustify && !zeroPad )
+    {
+        outputRepeat( out, ' ', padding );
+    }
+    outputChars( out, prefix, prefixLength );
+    outputRepeat( out, '0', zeros + ( zeroPad ? padding : 0U ) );
+    outputChars( out, body, bodyLength );
+    if( leftJustify )
+    {
+        outputRepeat( out, ' ', padding );
+    }
+}
+
+/**
+ * @brief Convert an unsigned integer to digits, written backwards from the end of a buffer.
+ *
+ * @param end Pointer to the character after the last digit.
+ * @param value Value to be converted.
+ * @param base Number base: 8, 10 or 16.
+ * @param upperCase true for upper case hexadecimal digits.
+ * @return Number of digits.
+ */
+static size_t formatDigits( char* end, uintmax_t value, unsigned int base, bool upperCase )
+{
+    const char* hexDigits = upperCase ? "0123456789ABCDEF" : "0123456789abcdef";
+    char* digit = end;
+    do
+    {
+        *--digit = hexDigits[value % base];
+        value /= base;
+    } while( value > 0U );
+    return (size_t)( end - digit );
+}
+
+#if LOG_MINIMAL_PRINTF_FLOAT
+/**
+ * @brief Convert a non-negative floating point value to fixed point digits, 
+ *        written backwards from the end of a buffer.
+ *
+ * @param end Pointer to the character after the last digit.
+ * @param value Value to be converted, which shall be less than 2^64.
+ * @param precision Number of digits after the decimal point (up to LOG_FLOAT_MAX_PRECISION).
+ * @return Number of characters.
+ */
+static size_t formatDouble( char* end, double value, int precision )
+{
+    static const uint32_t powersOf10[LOG_FLOAT_MAX_PRECISION + 1] = {
+        1U, 10U, 100U, 1000U, 10000U, 100000U, 1000000U, 10000000U, 100000000U, 1000000000U
+    };
+    uint64_t integer = (uint64_t)value;
+    uint64_t fraction = (uint64_t)( ( ( value - (double)integer ) * powersOf10[precision] ) + 0.5 );
+    if( fraction >= powersOf10[precision] )
+    {
+        fraction -= powersOf10[precision];  /* fraction has been rounded up to 1 */
+        integer++;
+    }
+    char* digit = end;
+    if( precision > 0 )
+    {
+        size_t fractionLength = formatDigits( digit, fraction, 10U, false );
+        digit -= fractionLength;
+        for( ; fractionLength < (size_t)precision; fractionLength++ )
+        {
+            *--digit = '0';
+        }
+        *--digit = '.';
+    }
+    digit -= formatDigits( digit, integer, 10U, false );
+    return (size_t)( end - digit );
+}
+#endif
+
+/**
+ * @brief Format one conversion specification with the minimal printf formatter.
+ *
+ * @param out Formatter output.
+ * @param conv Parsed conversion specification.
+ * @param spec Pointer to the '%' character of the conversion specification.
+ * @param specLength Number of characters of the conversion specification.
+ * @param ap Pointer to printf variadic arguments list.
+ */
+static void formatConversion( tFormatOutput* out, tConversion* conv, const char* spec, size_t specLength, va_list* ap )
+{
+    char digits[32U];  /* large enough for a 64-bit octal value, or a fixed point value with LOG_FLOAT_MAX_PRECISION digits */
+    char* end = &digits[sizeof( digits )];
+    if( conv->widthArg )
+    {
+        conv->width = va_arg( *ap, int );
+    }
+    if( conv->precisionArg )
+    {
+        int precision = va_arg( *ap, int );
+        conv->precision = ( precision >= 0 ) ? precision : -1;  /* negative precision argument is ignored */
+    }
+    bool plusFlag = ( NULL != memchr( conv->flags, '+', conv->flagsLength ) );
+    bool spaceFlag = ( NULL != memchr( conv->flags, ' ', conv->flagsLength ) );
+    if( conv->widthArg && ( conv->width < 0 ) )
+    {
+        conv->width = -conv->width;  /* negative width argument is a '-' flag followed by a positive width */
+        conv->flags = "-";
+        conv->flagsLength = 1U;
+    }
+
+    switch( conv->argType )
+    {
+        case ARG_SIGNED:
+        case ARG_UNSIGNED:
+        case ARG_POINTER:
+        {
+            const char* prefix = "";
+            uintmax_t value;
+            if( ARG_SIGNED == conv->argType )
+            {
+                intmax_t signedValue = readSignedArg( conv->lengthModifier, ap );
+                value = ( signedValue < 0 ) ? ( (uintmax_t)0U - (uintmax_t)signedValue ) : (uintmax_t)signedValue;
+                prefix = ( signedValue < 0 ) ? "-" : plusFlag ? "+" : spaceFlag ? " " : "";
+            }
+            else if( ARG_UNSIGNED == conv->argType )
+            {
+                value = readUnsignedArg( conv->lengthModifier, ap );
+            }
+            else
+            {
+                value = (uintmax_t)(uintptr_t)va_arg( *ap, void* );
+                prefix = "0x";
+            }
+            unsigned int base = ( 'o' == conv->specifier ) ? 8U : ( ( 'd' == conv->specifier ) || ( 'i' == conv->specifier ) || ( 'u' == conv->specifier ) ) ? 10U : 16U;
+            size_t digitCount = formatDigits( end, value, base, ( 'X' == conv->specifier ) );
+            if( ( 0 == conv->precision ) && ( 0U == value ) )
+            {
+                digitCount = 0U;  /* zero precision with zero value produces no digits */
+            }
+            size_t zeros = ( ( conv->precision > 0 ) && ( (size_t)conv->precision > digitCount ) ) ? ( (size_t)conv->precision - digitCount ) : 0U;
+            outputField( out, conv, ( conv->precision < 0 ), prefix, zeros, end - digitCount, digitCount );
+            break;
+        }
+        case ARG_CHAR:
+        {
+            char c = (char)va_arg( *ap, int );
+            outputField( out, conv, false, "", 0U, &c, 1U );
+            break;
+        }
+        case ARG_STRING:
+        {
+            const char* str = va_arg( *ap, const char* );
+            str = ( NULL != str ) ? str : "(null)";
+            size_t length = stringLength( str, conv->precision );
+            outputField( out, conv, false, "", 0U, str, length );
+            break;
+        }
+        case ARG_DOUBLE:
+        {
+            double value = ( LENGTH_BIG_L == conv->lengthModifier ) ? (double)va_arg( *ap, long double ) : va_arg( *ap, double );
+#if LOG_MINIMAL_PRINTF_FLOAT
+            if( ( 'f' == conv->specifier ) || ( 'F' == conv->specifier ) )
+            {
+                const char* prefix = ( value < 0.0 ) ? "-" : plusFlag ? "+" : spaceFlag ? " " : "";
+                value = ( value < 0.0 ) ? -value : value;
+                int precision = ( conv->precision < 0 ) ? 6 : ( conv->precision > LOG_FLOAT_MAX_PRECISION ) ? LOG_FLOAT_MAX_PRECISION : conv->precision;
+                if( value != value )
+                {
+                    outputField( out, conv, false, "", 0U, "nan", 3U );
+                }
+                else if( value < 18446744073709551616.0 )  /* 2^64 */
+                {
+                    size_t length = formatDouble( end, value, precision );
+                    outputField( out, conv, true, prefix, 0U, end - length, length );
+                }
+                else
+                {
+                    outputField( out, conv, false, prefix, 0U, "inf", 3U );  /* infinite, or out of range */
+                }
+                break;
+            }
+#else
+            (void)value;
+#endif
+            outputChars( out, spec, specLength );  /* unsupported floating point conversion */
+            break;
+        }
+        case ARG_COUNT:
+            (void)va_arg( *ap, void* );  /* "%n" is not supported: the argument is consumed but not written */
+            break;
+        default:
+            if( '%' == conv->specifier )
+            {
+                outputChars( out, "%", 1U );
+            }
+            else
+            {
+                outputChars( out, spec, specLength );  /* invalid conversion specification */
+            }
+            break;
+    }
+}
+#endif
+
+#if LOG_USE_ARG_PACKING
+/**
+ * @brief Get the size of a packed integer argument.
+ *
+ * @param lengthModifier Length modifier of the conversion specification.
+ * @return 4 if the argument type is no larger than 32 bits, otherwise 8.
+ */
+static size_t integerArgSize( tLengthModifier lengthModifier )
+{
+    size_t size = sizeof( int );
+    switch( lengthModifier )
+    {
+        case LENGTH_L: size = sizeof( long ); break;
+        case LENGTH_LL: size = sizeof( long long ); break;
+        case LENGTH_J: size = sizeof( intmax_t ); break;
+        case LENGTH_Z: size = sizeof( size_t ); break;
+        case LENGTH_T: size = sizeof( ptrdiff_t ); break;
+        default: break;
+    }
+    return ( size <= sizeof( int32_t ) ) ? sizeof( int32_t ) : sizeof( int64_t );
+}
+
+/**
+ * @brief Serialize the printf arguments of a log message into a buffer.
+ *
+ * The format string is walked to determine the type of each argument. Integers
+ * are stored as 32-bit or 64-bit values, floating point values as double, and 
+ * strings are copied into the buffer with their null terminator, up to the precision
+ * of the conversion specification. Packing stops
+ * at the first argument that does not fit in the buffer.
+ *
+ * @param buffer Destination buffer.
+ * @param size Size of the destination buffer in bytes.
+ * @param fmt printf format string.
+ * @param ap printf variadic arguments list.
+ * @param[out] truncated Set to true if an argument was truncated or discarded, if not NULL.
+ * @return Number of bytes written to the buffer.
+ */
+static size_t packArgs( uint8_t* buffer, size_t size, const char* fmt, va_list ap, bool* truncated )
+{
+    bool stringTruncated = false;
+    size_t length = 0U;
+    bool full = false;
+    va_list args;
+    va_copy( args, ap );
+    while( ( '\0' != *fmt ) && ( !full ) )
+    {
+        if( '%' != *fmt++ )
+        {
+            continue;
+        }
+
+        tConversion conv;
+        fmt = parseConversion( fmt, &conv );
+        int32_t starArgs[2U];
+        size_t starArgCount = 0U;
+        if( conv.widthArg )
+        {
+            starArgs[starArgCount++] = va_arg( args, int );
+        }
+        if( conv.precisionArg )
+        {
+            starArgs[starArgCount] = va_arg( args, int );
+            conv.precision = ( starArgs[starArgCount] >= 0 ) ? starArgs[starArgCount] : -1;  /* negative precision argument is ignored */
+            starArgCount++;
+        }
+
+        union {
+            int32_t i32;
+            int64_t i64;
+            double d;
+            const void* p;
+        } value;
+        size_t valueSize = 0U;
+        const char* str = NULL;
+
+        switch( conv.argType )
+        {
+            case ARG_SIGNED:
+            case ARG_UNSIGNED:
+            {
+                intmax_t arg = ( ARG_SIGNED == conv.argType ) ? readSignedArg( conv.lengthModifier, &args ) :
+                                                                (intmax_t)readUnsignedArg( conv.lengthModifier, &args );
+                valueSize = integerArgSize( conv.lengthModifier );
+                if( sizeof( int32_t ) == valueSize )
+                {
+                    value.i32 = (int32_t)arg;
+                }
+                else
+                {
+                    value.i64 = (int64_t)arg;
+                }
+                break;
+            }
+            case ARG_DOUBLE:
+                value.d = ( LENGTH_BIG_L == conv.lengthModifier ) ? (double)va_arg( args, long double ) : va_arg( args, double );
+                valueSize = sizeof( value.d );
+                break;
+            case ARG_CHAR:
+                value.i32 = va_arg( args, int );
+                valueSize = sizeof( value.i32 );
+                break;
+            case ARG_STRING:
+                str = va_arg( args, const char* );
+                str = ( NULL != str ) ? str : "(null)";
+                break;
+            case ARG_POINTER:
+                value.p = va_arg( args, const void* );
+                valueSize = sizeof( value.p );
+                break;
+            case ARG_COUNT:
+                (void)va_arg( args, void* );  /* "%n" is not supported: the argument is consumed but not written */
+                break;
+            default:
+                break;
+        }
+
+        size_t starArgsSize = starArgCount * sizeof( int32_t );
+        size_t strSize = ( NULL != str ) ? ( stringLength( str, conv.precision ) + 1U ) : 0U;
+        if( ( length + starArgsSize + valueSize + ( ( strSize > 0U ) ? 1U : 0U ) ) > size )
+        {
+            full = true;
+        }
+        else
+        {
+            memcpy( &buffer[length], starArgs, starArgsSize );
+            length += starArgsSize;
+            memcpy( &buffer[length], &value, valueSize );
+            length += valueSize;
+            if( strSize > 0U )
+            {
+                /* copy the string, truncating it if necessary */
+                size_t copySize = ( strSize <= ( size - length ) ) ? strSize : ( size - length );
+                stringTruncated = stringTruncated || ( copySize < strSize );
+                memcpy( &buffer[length], str, copySize - 1U );
+                buffer[length + copySize - 1U] = '\0';
+                length += copySize;
+            }
+        }
+    }
+    va_end( args );
+    if( NULL != truncated )
+    {
+        *truncated = full || stringTruncated;
+    }
+    return length;
+}
+#endif
+
+#if LOG_USE_FORMAT_SPEC
+/**
+ * @brief Format a single printf conversion specification with LOG_VSNPRINTF().
+ *
+ * @param buffer Destination buffer.
+ * @param size Size of the destination buffer in bytes.
+ * @param spec printf conversion specification.
+ * @param ... printf argument.
+ * @return Number of characters that would have been written if the buffer were large enough.
+ */
+static int formatSpec( char* buffer, size_t size, const char* spec, ... )
+{
+    va_list ap;
+    va_start( ap, spec );
+    int result = LOG_VSNPRINTF( buffer, size, spec, ap );
+    va_end( ap );
+    return result;
+}
+#endif
+
+#if LOG_USE_ARG_RENDERING
+/**
+ * @brief Format a log message body from a printf format string and packed arguments.
+ *
+ * Each conversion specification is formatted separately with LOG_VSNPRINTF(), using
+ * the intmax_t or uintmax_t length modifier for integer arguments. Rendering 
+ * stops at the first conversion whose argument is missing from the buffer.
+ *
+ * @param buffer Destination buffer for the null terminated log message body.
+ * @param size Size of the destination buffer in bytes.
+ * @param fmt printf format string.
+ * @param args Packed printf arguments.
+ * @param argsLength Number of bytes of packed printf arguments.
+ * @return Number of characters written to the buffer, excluding the null terminator.
+ */
+static size_t renderArgs( char* buffer, size_t size, const char* fmt, const uint8_t* args, size_t argsLength )
+{
+    size_t length = 0U;
+    size_t argIndex = 0U;
+    bool finished = ( 0U == size );
+
+    while( ( '\0' != *fmt ) && ( !finished ) )
+    {
+        if( '%' != *fmt )
+        {
+            if( length < ( size - 1U ) )
+            {
+                buffer[length++] = *fmt;
+            }
+            fmt++;
+            continue;
+        }
+
+        tConversion conv;
+        fmt = parseConversion( fmt + 1, &conv );
+        if( ARG_NONE == conv.argType )
+        {
+            if( '%' == conv.specifier )
+            {
+                if( length < ( size - 1U ) )
+                {
+                    buffer[length++] = '%';
+                }
+            }
+            continue;
+        }
+
+        /* read width and precision arguments */
+        int32_t starArg;
+        if( conv.widthArg && ( ( argIndex + sizeof( starArg ) ) <= argsLength ) )
+        {
+            memcpy( &starArg, &args[argIndex], sizeof( starArg ) );
+            argIndex += sizeof( starArg );
+            conv.width = starArg;
+        }
+        if( conv.precisionArg && ( ( argIndex + sizeof( starArg ) ) <= argsLength ) )
+        {
+            memcpy( &starArg, &args[argIndex], sizeof( starArg ) );
+            argIndex += sizeof( starArg );
+            conv.precision = ( starArg >= 0 ) ? starArg : -1;
+        }
+
+        /* rebuild the conversion specification, without '*' arguments */
+        char spec[48U];
+        size_t flagsLength = ( conv.flagsLength < 8U ) ? conv.flagsLength : 8U;
+        spec[0U] = '%';
+        memcpy( &spec[1U], conv.flags, flagsLength );
+        size_t specLength = 1U + flagsLength;
+        if( ( conv.width < 0 ) && conv.widthArg )
+        {
+            spec[specLength++] = '-';  /* negative width argument is a '-' flag followed by a positive width */
+            conv.width = -conv.width;
+        }
+        if( conv.width >= 0 )
+        {
+            specLength = appendUnsigned( spec, sizeof( spec ), specLength, (uint32_t)conv.width, 0U );
+        }
+        if( conv.precision >= 0 )
+        {
+            specLength = appendChars( spec, sizeof( spec ), specLength, ".", 1U );
+            specLength = appendUnsigned( spec, sizeof( spec ), specLength, (uint32_t)conv.precision, 0U );
+        }
+        if( ( ARG_SIGNED == conv.argType ) || ( ARG_UNSIGNED == conv.argType ) )
+        {
+            spec[specLength++] = 'j';
+        }
+        spec[specLength++] = conv.specifier;
+        spec[specLength] = '\0';
+
+        /* format the argument */
+        size_t valueSize = ( ( ARG_SIGNED == conv.argType ) || ( ARG_UNSIGNED == conv.argType ) ) ? integerArgSize( conv.lengthModifier ) :
+                           ( ARG_DOUBLE == conv.argType ) ? sizeof( double ) :
+                           ( ARG_CHAR == conv.argType ) ? sizeof( int32_t ) :
+                           ( ARG_POINTER == conv.argType ) ? sizeof( const void* ) :
+                           ( ARG_STRING == conv.argType ) ? 1U : 0U;
+        if( ( argIndex + valueSize ) > argsLength )
+        {
+            finished = true;  /* argument is missing because packing stopped when the buffer was full */
+            continue;
+        }
+
+        char* out = &buffer[length];
+        size_t outSize = size - length;
+        int printed = 0;
+        switch( conv.argType )
+        {
+            case ARG_SIGNED:
+            case ARG_UNSIGNED:
+            {
+                int64_t i64 = 0;
+                if( sizeof( int32_t ) == valueSize )
+                {
+                    int32_t i32;
+                    memcpy( &i32, &args[argIndex], sizeof( i32 ) );
+                    i64 = ( ARG_SIGNED == conv.argType ) ? (int64_t)i32 : (int64_t)(uint32_t)i32;
+                }
+                else
+                {
+                    memcpy( &i64, &args[argIndex], sizeof( i64 ) );
+                }
+                printed = ( ARG_SIGNED == conv.argType ) ? formatSpec( out, outSize, spec, (intmax_t)i64 ) :
+                                                           formatSpec( out, outSize, spec, (uintmax_t)(uint64_t)i64 );
+                break;
+            }
+            case ARG_DOUBLE:
+            {
+                double d;
+                memcpy( &d, &args[argIndex], sizeof( d ) );
+                printed = formatSpec( out, outSize, spec, d );
+                break;
+            }
+            case ARG_CHAR:
+            {
+                int32_t c;
+                memcpy( &c, &args[argIndex], sizeof( c ) );
+                printed = formatSpec( out, outSize, spec, (int)c );
+                break;
+            }
+            case ARG_POINTER:
+            {
+                const void* p;
+                memcpy( &p, &args[argIndex], sizeof( p ) );
+                printed = formatSpec( out, outSize, spec, p );
+                break;
+            }
+            case ARG_STRING:
+            {
+                const char* str = (const char*)&args[argIndex];
+                const char* end = memchr( str, '\0', argsLength - argIndex );
+                valueSize = ( NULL != end ) ? (size_t)( end - str ) + 1U : ( argsLength - argIndex );
+                printed = formatSpec( out, outSize, spec, str );
+                break;
+            }
+            default:
+                break;
+        }
+        argIndex += valueSize;
+        length += ( printed < 0 ) ? 0U : ( (size_t)printed < outSize ) ? (size_t)printed : ( outSize - 1U );
+    }
+
+    if( size > 0U )
+    {
+        buffer[length] = '\0';
+    }
+    return length;
+}
+#endif
+
+#if LOG_USE_FIELDS
+/**
+ * @brief Append a signed decimal integer to a buffer.
+ *
+ * @param buffer Destination buffer.
+ * @param size Size of the destination buffer.
+ * @param length Number of characters already in the buffer (less than size).
+ * @param value Value to be appended.
+ * @return Number of characters in the buffer, excluding the null terminator.
+ */
+static size_t appendSigned( char* buffer, size_t size, size_t length, int64_t value )
+{
+    if( value < 0 )
+    {
+        length = appendChars( buffer, size, length, "-", 1U );
+    }
+    return appendUnsigned( buffer, size, length, ( value < 0 ) ? ( 0U - (uint64_t)value ) : (uint64_t)value, 0U );
+}
+
+/**
+ * @brief Format the text of a structured log message: the message, followed
+ *        by " key=value" for each field and a newline.
+ *
+ * Integer and boolean values are converted with table lookups and string 
+ * values are copied, without calling printf(). Floating point values are 
+ * formatted by LOG_VSNPRINTF() with the LOG_FIELD_FLOAT_FORMAT format.
+ *
+ * @param buffer Destination buffer.
+ * @param size Size of the destination buffer (greater than 0).
+ * @param msg Message.
+ * @param fields Array of typed key/value fields.
+ * @param fieldCount Number of fields.
+ * @return Number of characters written to the buffer, excluding the null terminator.
+ */
+static size_t formatFields( char* buffer, size_t size, const char* msg, const tLog_field* fields, size_t fieldCount )
+{
+    size_t length = appendChars( buffer, size, 0U, msg, strlen( msg ) );
+    for( size_t i = 0; i < fieldCount; i++ )
+    {
+        const tLog_field* field = &fields[i];
+        length = appendChars( buffer, size, length, " ", 1U );
+        length = appendChars( buffer, size, length, field->key, strlen( field->key ) );
+        length = appendChars( buffer, size, length, "=", 1U );
+        switch( field->type )
+        {
+            case LOG_FIELD_I32: length = appendSigned( buffer, size, length, field->value.i32 ); break;
+            case LOG_FIELD_U32: length = appendUnsigned( buffer, size, length, field->value.u32, 0U ); break;
+            case LOG_FIELD_I64: length = appendSigned( buffer, size, length, field->value.i64 ); break;
+            case LOG_FIELD_U64: length = appendUnsigned( buffer, size, length, field->value.u64, 0U ); break;
+            case LOG_FIELD_F32: length += writtenLength( formatSpec( &buffer[length], size - length, LOG_FIELD_FLOAT_FORMAT, (double)field->value.f32 ), size - length ); break;
+            case LOG_FIELD_F64: length += writtenLength( formatSpec( &buffer[length], size - length, LOG_FIELD_FLOAT_FORMAT, field->value.f64 ), size - length ); break;
+            case LOG_FIELD_BOOL: length = field->value.b ? appendChars( buffer, size, length, "true", 4U ) : appendChars( buffer, size, length, "false", 5U ); break;
+            case LOG_FIELD_STR:
+                length = appendChars( buffer, size, length, "\"", 1U );
+                length = appendChars( buffer, size, length, field->value.str, strlen( field->value.str ) );
+                length = appendChars( buffer, size, length, "\"", 1U );
+                break;
+            default: length = appendChars( buffer, size, length, "?", 1U ); break;
+        }
+    }
+    length = appendChars( buffer, size, length, "\n", 1U );
+    if( ( length > 0U ) && ( '\n' != buffer[length - 1U] ) )
+    {
+        buffer[length - 1U] = '\n';  /* the text has been truncated: keep the end of line */
+    }
+    return length;
+}
+
+/**
+ * @brief Format the text of a structured log message, if it has not been formatted yet.
+ *
+ * The text is formatted into the buffer that is the printf argument of the 
+ * format string "%s", so it is only formatted when the console, coalescing, the
+ * crash log or a sink first reads it, and sinks that only read the typed fields
+ * cost no formatting.
+ *
+ * @param ev Log event data.
+ */
+static void renderFields( tLog_event* ev )
+{
+    if( NULL != ev->fieldsMsg )
+    {
+        (void)formatFields( ev->fieldsText, LOG_FIELDS_TEXT_SIZE, ev->fieldsMsg, ev->fields, ev->fieldCount );
+        ev->fieldsMsg = NULL;
+    }
+}
+#endif
+
+#if LOG_USE_FIELDS || LOG_DEFERRED_FORMAT
+/**
+ * @brief Timestamp a log event whose body has been formatted by the library, and write it with the formatted text as the printf argument.
+ *
+ * @param ev Log event data, with the level, filename and line number set.
+ * @param fmt printf format string of the formatted text.
+ * @param ... printf arguments.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+static int logText( tLog_event* ev, const char* fmt, ... )
+{
+    ev->fmt = fmt;
+    va_list ap;
+    va_start( ap, fmt );
+    int result = logEvent( ev, ap );
+    va_end( ap );
+    return result;
+}
+#endif
+
+#if LOG_USE_BATCH_SINK || LOG_USE_MMAP_SINK
+/**
+ * @brief Format a log message body into the text buffer of a sink.
+ *
+ * @param buffer Destination buffer.
+ * @param size Size of the destination buffer in bytes.
+ * @param ev Log event data.
+ * @return Number of characters of the log message body, including any that did not fit in the buffer.
+ */
+static size_t formatEventText( char* buffer, size_t size, tLog_event* ev )
+{
+#if LOG_USE_MESSAGE_BUFFER
+    /* copy the log message body that is formatted once for all sinks */
+    size_t textLength;
+    const char* text = log_eventText( ev, &textLength );
+    if( size > 0U )
+    {
+        (void)appendChars( buffer, size, 0U, text, textLength );
+    }
+    return textLength;
+#else
+    va_list args;
+    va_copy( args, ev->ap );
+    int printed = LOG_VSNPRINTF( buffer, size, ev->fmt, args );
+    va_end( args );
+    return ( printed < 0 ) ? 0U : (size_t)printed;
+#endif
+}
+#endif
+
+#if LOG_USE_BATCH_SINK
+
+/**
+ * @brief Deliver the log messages accumulated by a batch sink, if any, and empty the batch.
+ *
+ * @param sink Batch sink.
+ */
+static void deliverBatch( tLog_batchSink* sink )
+{
+    if( sink->count > 0U )
+    {
+        sink->batchFn( sink->events, sink->count, sink->batchData );
+        sink->count = 0U;
+        sink->length = 0U;
+    }
+}
+#endif
+
+#if LOG_USE_MMAP_SINK
+/**
+ * @brief Create the log file of a memory-mapped file sink, preallocate it and map it into memory.
+ *
+ * @param sink Memory-mapped file sink, with the path and segment size set.
+ * @return true if the log file has been mapped, otherwise false.
+ */
+static bool mapLogFile( tLog_mmapSink* sink )
+{
+    sink->map = NULL;
+    sink->length = 0U;
+    sink->syncedLength = 0U;
+    sink->fd = open( sink->path, O_RDWR | O_CREAT | O_TRUNC, 0644 );
+    bool mapped = ( sink->fd >= 0 ) && ( 0 == ftruncate( sink->fd, (off_t)sink->size ) );
+#if defined( __linux__ )
+    if( mapped )
+    {
+        (void)posix_fallocate( sink->fd, 0, (off_t)sink->size );  /* allocate the blocks now, or leave the file sparse if not supported */
+    }
+#endif
+    if( mapped )
+    {
+        void* map = mmap( NULL, sink->size, PROT_READ | PROT_WRITE, MAP_SHARED, sink->fd, 0 );
+        mapped = ( MAP_FAILED != map );
+        sink->map = mapped ? (char*)map : NULL;
+    }
+    if( !mapped && ( sink->fd >= 0 ) )
+    {
+        (void)close( sink->fd );
+        sink->fd = -1;
+    }
+    return mapped;
+}
+
+/**
+ * @brief Unmap the log file of a memory-mapped file sink, truncate it to the bytes written and close it.
+ *
+ * The written pages remain in the page cache and are written back by the 
+ * kernel, so they are preserved if the process crashes.
+ *
+ * @param sink Memory-mapped file sink.
+ */
+static void unmapLogFile( tLog_mmapSink* sink )
+{
+    if( NULL != sink->map )
+    {
+        (void)munmap( sink->map, sink->size );
+        sink->map = NULL;
+    }
+    if( sink->fd >= 0 )
+    {
+        (void)ftruncate( sink->fd, (off_t)sink->length );
+        (void)close( sink->fd );
+        sink->fd = -1;
+    }
+}
+
+/**
+ * @brief Rename the log file of a memory-mapped file sink to "<path>.1", after renaming each rotated log file to the next suffix.
+ *
+ * @param sink Memory-mapped file sink.
+ */
+static void rotateLogFiles( const tLog_mmapSink* sink )
+{
+    char from[LOG_MMAP_PATH_SIZE + 12U];
+    char to[LOG_MMAP_PATH_SIZE + 12U];
+    if( 0U == sink->maxFiles )
+    {
+        (void)unlink( sink->path );
+        return;
+    }
+    for( unsigned int i = sink->maxFiles - 1U; i > 0U; i-- )
+    {
+        (void)snprintf( from, sizeof( from ), "%s.%u", sink->path, i );
+        (void)snprintf( to, sizeof( to ), "%s.%u", sink->path, i + 1U );
+        (void)rename( from, to );  /* replaces the oldest rotated log file */
+    }
+    (void)snprintf( to, sizeof( to ), "%s.1", sink->path );
+    (void)rename( sink->path, to );
+}
+#endif
+
+#if LOG_USE_BINARY_SINK
+/**
+ * @brief Append an unsigned LEB128 variable length integer to a binary record.
+ *
+ * @param buffer Destination buffer.
+ * @param size Size of the destination buffer in bytes.
+ * @param length Number of bytes already in the buffer, or ( size + 1 ) if a previous value did not fit.
+ * @param value Value to be encoded.
+ * @return Number of bytes in the buffer, or ( size + 1 ) if the value does not fit.
+ */
+static size_t encodeVarint( uint8_t* buffer, size_t size, size_t length, uintmax_t value )
+{
+    do
+    {
+        if( length >= size )
+        {
+            return size + 1U;
+        }
+        uint8_t byte = (uint8_t)( value & 0x7FU );
+        value >>= 7;
+        buffer[length++] = ( 0U != value ) ? (uint8_t)( byte | 0x80U ) : byte;
+    } while( 0U != value );
+    return length;
+}
+
+/**
+ * @brief Append a zigzag encoded signed variable length integer to a binary record.
+ *
+ * @param buffer Destination buffer.
+ * @param size Size of the destination buffer in bytes.
+ * @param length Number of bytes already in the buffer, or ( size + 1 ) if a previous value did not fit.
+ * @param value Value to be encoded.
+ * @return Number of bytes in the buffer, or ( size + 1 ) if the value does not fit.
+ */
+static size_t encodeSigned( uint8_t* buffer, size_t size, size_t length, intmax_t value )
+{
+    uintmax_t zigzag = ( value < 0 ) ? ~( (uintmax_t)value << 1 ) : ( (uintmax_t)value << 1 );
+    return encodeVarint( buffer, size, length, zigzag );
+}
+
+/**
+ * @brief Append the printf arguments of a log message to a binary record.
+ *
+ * The format string is walked to determine the type of each argument. '*' 
+ * arguments and signed integers are zigzag encoded, unsigned integers, 
+ * characters and pointers are encoded as variable length integers, floating
+ * point values as 8 byte little endian doubles, and strings as their length 
+ * followed by their characters. Encoding stops at the first argument that does
+ * not fit in the record, except that a string is truncated to fit.
+ *
+ * @param buffer Destination buffer.
+ * @param size Size of the destination buffer in bytes.
+ * @param length Number of bytes already in the buffer.
+ * @param fmt printf format string.
+ * @param ap printf variadic arguments list.
+ * @param truncated Set to true if any arguments were discarded or truncated.
+ * @return Number of bytes in the buffer.
+ */
+static size_t encodeArgs( uint8_t* buffer, size_t size, size_t length, const char* fmt, va_list ap, bool* truncated )
+{
+    va_list args;
+    va_copy( args, ap );
+    while( ( '\0' != *fmt ) && ( !*truncated ) )
+    {
+        if( '%' != *fmt++ )
+        {
+            continue;
+        }
+
+        tConversion conv;
+        fmt = parseConversion( fmt, &conv );
+        size_t end = length;
+        if( conv.widthArg )
+        {
+            end = encodeSigned( buffer, size, end, va_arg( args, int ) );
+        }
+        if( conv.precisionArg )
+        {
+            int precision = va_arg( args, int );
+            conv.precision = ( precision >= 0 ) ? precision : -1;  /* negative precision argument is ignored */
+            end = encodeSigned( buffer, size, end, precision );
+        }
+
+        switch( conv.argType )
+        {
+            case ARG_SIGNED:
+                end = encodeSigned( buffer, size, end, readSignedArg( conv.lengthModifier, &args ) );
+                break;
+            case ARG_UNSIGNED:
+                end = encodeVarint( buffer, size, end, readUnsignedArg( conv.lengthModifier, &args ) );
+                break;
+            case ARG_CHAR:
+                end = encodeVarint( buffer, size, end, (unsigned char)va_arg( args, int ) );
+                break;
+            case ARG_POINTER:
+                end = encodeVarint( buffer, size, end, (uintptr_t)va_arg( args, const void* ) );
+                break;
+            case ARG_DOUBLE:
+            {
+                double d = ( LENGTH_BIG_L == conv.lengthModifier ) ? (double)va_arg( args, long double ) : va_arg( args, double );
+                uint64_t bits;
+                memcpy( &bits, &d, sizeof( bits ) );
+                if( ( end + sizeof( bits ) ) <= size )
+                {
+                    for( size_t i = 0U; i < sizeof( bits ); i++ )
+                    {
+                        buffer[end++] = (uint8_t)( bits >> ( 8U * i ) );
+                    }
+                }
+                else
+                {
+                    end = size + 1U;
+                }
+                break;
+            }
+            case ARG_STRING:
+            {
+                const char* str = va_arg( args, const char* );
+                str = ( NULL != str ) ? str : "(null)";
+                size_t strLength = stringLength( str, conv.precision );
+                if( ( end <= size ) && ( ( end + 2U + strLength ) > size ) )
+                {
+                    /* truncate the string to fit, leaving space for a length of up to 2 bytes */
+                    *truncated = true;
+                    strLength = ( ( end + 2U ) < size ) ? ( size - end - 2U ) : 0U;
+                }
+                end = encodeVarint( buffer, size, end, strLength );
+                if( end <= size )
+                {
+                    memcpy( &buffer[end], str, strLength );
+                    end += strLength;
+                }
+                break;
+            }
+            case ARG_COUNT:
+                (void)va_arg( args, void* );  /* "%n" is not supported: the argument is consumed but not written */
+                break;
+            default:
+                break;
+        }
+
+        if( end > size )
+        {
+            *truncated = true;  /* the argument, or one of its '*' arguments, did not fit */
+        }
+        else
+        {
+            length = end;
+        }
+    }
+    va_end( args );
+    return length;
+}
+
+/**
+ * @brief Prepend the length to an encoded binary record, and write it.
+ *
+ * @param sink Binary log sink.
+ * @param record Record buffer, whose body starts at index 2.
+ * @param length Number of bytes of the record body.
+ */
+static void writeBinaryRecord( tLog_binarySink* sink, uint8_t* record, size_t length )
+{
+    size_t start = ( length < 0x80U ) ? 1U : 0U;
+    uint8_t prefix[2U];
+    size_t prefixLength = encodeVarint( prefix, sizeof( prefix ), 0U, length );
+    memcpy( &record[start], prefix, prefixLength );
+    sink->writeFn( &record[start], prefixLength + length, sink->writeData );
+}
+#endif
+
+#if LOG_USE_ATOMICS
+#if defined( LOG_CRITICAL_SECTION_ENTER ) && defined( LOG_CRITICAL_SECTION_EXIT )
+/* Atomic operations are implemented with critical sections, e.g. for ARM Cortex-M0 processors without LDREX/STREX instructions */
+
+/**
+ * @brief Atomically read a value, with acquire semantics.
+ *
+ * @param value Pointer to the value.
+ * @return The value.
+ */
+static inline uint32_t atomicLoad( uint32_t* value )
+{
+    LOG_CRITICAL_SECTION_ENTER();
+    uint32_t result = *(volatile uint32_t*)value;
+    LOG_CRITICAL_SECTION_EXIT();
+    return result;
+}
+
+/**
+ * @brief Atomically write a value, with release semantics.
+ *
+ * @param value Pointer to the value.
+ * @param newValue Value to be written.
+ */
+static inline void atomicStore( uint32_t* value, uint32_t newValue )
+{
+    LOG_CRITICAL_SECTION_ENTER();
+    *(volatile uint32_t*)value = newValue;
+    LOG_CRITICAL_SECTION_EXIT();
+}
+
+/**
+ * @brief Atomically replace a value with desired, if it is equal to expected.
+ *
+ * @param value Pointer to the value.
+ * @param expected Expected value.
+ * @param desired Value to be written if the value is equal to expected.
+ * @return true if the value was replaced, or false if it was not equal to expected.
+ */
+static inline bool atomicCompareExchange( uint32_t* value, uint32_t expected, uint32_t desired )
+{
+    LOG_CRITICAL_SECTION_ENTER();
+    bool exchanged = ( expected == *(volatile uint32_t*)value );
+    if( exchanged )
+    {
+        *(volatile uint32_t*)value = desired;
+    }
+    LOG_CRITICAL_SECTION_EXIT();
+    return exchanged;
+}
+
+/**
+ * @brief Atomically add to a value, with sequentially consistent ordering.
+ *
+ * @param value Pointer to the value.
+ * @param delta Value to be added.
+ * @return The value before the addition.
+ */
+static inline uint32_t atomicFetchAdd( uint32_t* value, uint32_t delta )
+{
+    LOG_CRITICAL_SECTION_ENTER();
+    uint32_t result = *(volatile uint32_t*)value;
+    *(volatile uint32_t*)value = result + delta;
+    LOG_CRITICAL_SECTION_EXIT();
+    return result;
+}
+#elif defined( __GNUC__ )
+/* Atomic operations are implemented with GCC/Clang built-in functions */
+
+static inline uint32_t atomicLoad( uint32_t* value )
+{
+    return __atomic_load_n( value, __ATOMIC_ACQUIRE );
+}
+
+static inline void atomicStore( uint32_t* value, uint32_t newValue )
+{
+    __atomic_store_n( value, newValue, __ATOMIC_RELEASE );
+}
+
+static inline bool atomicCompareExchange( uint32_t* value, uint32_t expected, uint32_t desired )
+{
+    return __atomic_compare_exchange_n( value, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE );
+}
+
+static inline uint32_t atomicFetchAdd( uint32_t* value, uint32_t delta )
+{
+    return __atomic_fetch_add( value, delta, __ATOMIC_SEQ_CST );
+}
+#else
+#error "Asynchronous logging and the crash log require GCC/Clang atomic built-ins, or definition of LOG_CRITICAL_SECTION_ENTER() and LOG_CRITICAL_SECTION_EXIT()"
+#endif
+#endif
+
+#if LOG_USE_CALLBACKS
+/**
+ * @brief Acquire the lock of a logger context to change its callback registrations.
+ *
+ * A timed lock function is called without a timeout, because a registration 
+ * shall not be dropped like a log message.
+ *
+ * @param context Logger context.
+ * @return true if the lock was acquired.
+ */
+static bool lockRegistration( tLog_context* context )
+{
+    bool lockAcquired = true;  /* if no lock function is set, lock acquisition always succeeds */
+    if( NULL != context->timedLockFn )
+    {
+        lockAcquired = context->timedLockFn( true, LOG_LOCK_WAIT_FOREVER, context->lockData );
+    }
+    else if( NULL != context->lockFn )
+    {
+        lockAcquired = context->lockFn( true, context->lockData );
+    }
+    return lockAcquired;
+}
+
+/**
+ * @brief Remove the registration of a callback function, with the lock held.
+ *
+ * @param context Logger context.
+ * @param cbFn Logging callback function pointer.
+ * @param cbData Logging callback data object pointer.
+ * @return true if the callback function was registered.
+ */
+static bool removeCallback( tLog_context* context, tLog_callbackFn cbFn, void* cbData )
+{
+    bool removed = false;
+    for( size_t i = 0U; ( !removed ) && ( i < LOG_MAX_CALLBACKS ); i++ )
+    {
+        if( ( cbFn == context->callbacks[i].cbFn ) && ( cbData == context->callbacks[i].cbData ) )
+        {
+            /* Delete the previously registered function pointer */
+            context->callbacks[i] = (tCallback) { .cbFn = NULL, .cbData = NULL, .cbLogLevel = LOG_TRACE };
+            removed = true;
+        }
+    }
+    return removed;
+}
+
+/**
+ * @brief Rebuild the callback snapshot, sorted by ascending callback logging
+ *        level, after the callback registrations have changed.
+ *
+ * It is called with the lock held, which writeEvent() also holds while it 
+ * invokes the callbacks of the snapshot, so a snapshot is never rebuilt while 
+ * it is read.
+ *
+ * @param context Logger context.
+ */
+static void buildCallbackSnapshot( tLog_context* context )
+{
+    tCallbackSnapshot* snapshot = &context->snapshot;
+    snapshot->count = 0U;
+    for( size_t i = 0U; i < LOG_MAX_CALLBACKS; i++ )
+    {
+        tCallback* cb = &context->callbacks[i];
+        if( NULL != cb->cbFn )
+        {
+            /* insertion sort, which preserves the registration order of callbacks at the same level */
+            size_t j = snapshot->count++;
+            for( ; ( j > 0U ) && ( snapshot->callbacks[j - 1U].cbLogLevel > cb->cbLogLevel ); j-- )
+            {
+                snapshot->callbacks[j] = snapshot->callbacks[j - 1U];
+            }
+            snapshot->callbacks[j] = *cb;
+#if LOG_USE_STATS
+            snapshot->callbacks[j].slot = i;
+#endif
+        }
+    }
+}
+#endif
+
+#if LOG_USE_ASYNC
+
+/**
+ * @brief Get the oldest log message in a queue, without removing it.
+ *
+ * @param queue Queue.
+ * @return Queue slot that contains the oldest log message, or NULL if the queue is empty.
+ */
+static tQueueSlot* peekQueue( tQueue* queue )
+{
+    uint32_t position = queue->readPosition;
+    tQueueSlot* slot = &queue->slots[position & LOG_ASYNC_QUEUE_MASK];
+    bool published = ( (int32_t)( atomicLoad( &slot->sequence ) - ( position + 1U ) ) >= 0 );
+    return published ? slot : NULL;  /* the slot is empty until it has been published by a producer */
+}
+
+/**
+ * @brief Select the queue of the calling producer.
+ *
+ * @return Queue, which is selected by the context ID if there are several queues.
+ */
+static tQueue* producerQueue( void )
+{
+#if LOG_ASYNC_QUEUE_COUNT > 1U
+    uint32_t contextId = ( NULL != logConfig.contextIdFn ) ? logConfig.contextIdFn() : 0U;
+    return &logConfig.queues[contextId % LOG_ASYNC_QUEUE_COUNT];  /* each context has its own queue */
+#else
+    return &logConfig.queues[0];
+#endif
+}
+
+/**
+ * @brief Write a log message into the next free queue slot.
+ *
+ * Multiple producers, including ISRs, may call this function concurrently. A 
+ * producer reserves a slot by advancing the queue write position with an atomic
+ * compare-exchange, then publishes the slot to the consumer by updating the 
+ * slot sequence number after the log message has been written.
+ *
+ * The log message body is formatted into the slot, or if LOG_DEFERRED_FORMAT is
+ * enabled, the format string pointer and packed arguments are stored instead.
+ *
+ * @param ev Log event data.
+ * @param packedArgs Arguments that have already been packed by the caller of 
+ *        log_logPacked(), or NULL to pack the arguments of ev->ap.
+ * @param packedLength Number of bytes of packedArgs.
+ * @return Number of characters of the log message body (or bytes of packed 
+ *         arguments) that have been queued, or -1 if the queue is full.
+ */
+static int enqueue( tLog_event* ev, const uint8_t* packedArgs, size_t packedLength )
+{
+#if !LOG_DEFERRED_FORMAT
+    (void)packedArgs;  /* the arguments are only packed by the caller if LOG_DEFERRED_FORMAT is enabled */
+    (void)packedLength;
+#endif
+    tQueue* queue = producerQueue();
+    tQueueSlot* slot = NULL;
+    bool full = false;
+    uint32_t position = atomicLoad( &queue->writePosition );
+
+    while( ( NULL == slot ) && ( !full ) )
+    {
+        tQueueSlot* candidate = &queue->slots[position & LOG_ASYNC_QUEUE_MASK];
+        int32_t difference = (int32_t)( atomicLoad( &candidate->sequence ) - position );
+        if( ( 0 == difference ) && atomicCompareExchange( &queue->writePosition, position, position + 1U ) )
+        {
+            slot = candidate;  /* slot has been reserved */
+        }
+        else if( difference < 0 )
+        {
+            full = true;  /* slot has not yet been printed by the consumer */
+        }
+        else
+        {
+            position = atomicLoad( &queue->writePosition );  /* slot has been reserved by another producer: retry */
+        }
+    }
+
+    int result = -1;
+    if( NULL != slot )
+    {
+        slot->time = ev->time;
+        slot->level = ev->level;
+        slot->file = ev->file;
+        slot->line = ev->line;
+#if LOG_DEFERRED_FORMAT
+        slot->fmt = ev->fmt;
+        if( NULL != packedArgs )
+        {
+            slot->length = ( packedLength <= sizeof( slot->data ) ) ? packedLength : sizeof( slot->data );
+            memcpy( slot->data, packedArgs, slot->length );
+        }
+        else
+        {
+            slot->length = packArgs( slot->data, sizeof( slot->data ), ev->fmt, ev->ap, NULL );
+        }
+        result = (int)slot->length;
+#elif LOG_USE_CHUNK_OUTPUT
+        /* format the complete log message into the slot, so that it can be transmitted directly from the slot */
+        size_t prefixLength = log_formatPrefix( slot->data, sizeof( slot->data ), ev );
+#if LOG_USE_MESSAGE_BUFFER
+        size_t textLength;
+        const char* text = log_eventText( ev, &textLength );
+        size_t length = appendChars( slot->data, sizeof( slot->data ), prefixLength, text, textLength );
+#else
+        int printed = LOG_VSNPRINTF( &slot->data[prefixLength], sizeof( slot->data ) - prefixLength, ev->fmt, ev->ap );
+        size_t length = prefixLength + writtenLength( printed, sizeof( slot->data ) - prefixLength );
+#endif
+        slot->length = (uint32_t)length;
+        result = (int)( length - prefixLength );
+#elif LOG_USE_MESSAGE_BUFFER
+        /* copy the log message body that is formatted once for the queue and all callbacks */
+        size_t textLength;
+        const char* text = log_eventText( ev, &textLength );
+        result = ( textLength < sizeof( slot->data ) ) ? (int)textLength : ( (int)sizeof( slot->data ) - 1 );
+        memcpy( slot->data, text, (size_t)result );
+        slot->data[result] = '\0';
+#else
+        result = LOG_VSNPRINTF( slot->data, sizeof( slot->data ), ev->fmt, ev->ap );
+        if( result >= (int)sizeof( slot->data ) )
+        {
+            result = (int)sizeof( slot->data ) - 1;  /* log message body has been truncated */
+        }
+#endif
+        atomicStore( &slot->sequence, position + 1U );  /* publish the slot to the consumer */
+    }
+    return result;
+}
+
+#if LOG_USE_CHUNK_OUTPUT
+/**
+ * @brief Get the queue slot that contains a chunk handed to the chunk write function.
+ *
+ * @param chunk Chunk, which is the data of a queue slot.
+ * @return Queue slot.
+ */
+static tQueueSlot* chunkSlot( const char* chunk )
+{
+    return (tQueueSlot*)(uintptr_t)( (uintptr_t)chunk - offsetof( tQueueSlot, data ) );
+}
+#endif
+#endif
+
+#if LOG_USE_COALESCE
+/**
+ * @brief Detect a log message that is identical to the last log message.
+ *
+ * The log messages are identical if they have the same format string pointer,
+ * filename, line number, level and packed printf arguments, so a repeat is 
+ * detected without formatting it. A repeat is counted instead of being written,
+ * until LOG_COALESCE_TIMEOUT has elapsed since the last log message was 
+ * written. When a different log message arrives, or the timeout has elapsed,
+ * the repeat count of the last log message is written first.
+ *
+ * A log message that is written with the lock held is compared with the last
+ * log message of its logger context, under that lock. A log message that is 
+ * only queued for the console is compared with the last log message of its 
+ * queue, which is claimed without waiting, so that the asynchronous path stays
+ * lock-free. If another producer has claimed it, the log message is written 
+ * and counted in the coalesceSkipped statistic.
+ *
+ * @param context Logger context of the log message.
+ * @param ev Log event data, with the timestamp set.
+ * @param ap printf variadic arguments list.
+ * @param lockAcquired Flag that indicates the lock of the logger context is held.
+ * @return true if the log message is a repeat that has been counted, false if it shall be written.
+ */
+static bool coalesceEvent( tLog_context* context, const tLog_event* ev, va_list ap, bool lockAcquired )
+{
+    uint8_t args[LOG_COALESCE_ARGS_SIZE];
+    bool truncated = false;
+    size_t length = packArgs( args, sizeof( args ), ev->fmt, ap, &truncated );
+
+    tCoalesceState* last = &context->coalesce;
+#if LOG_USE_ASYNC
+    tQueue* queue = lockAcquired ? NULL : producerQueue();
+    if( NULL != queue )
+    {
+        last = atomicCompareExchange( &queue->coalesceBusy, 0U, 1U ) ? &queue->coalesce : NULL;
+        if( NULL == last )
+        {
+            countEvent( &context->stats.coalesceSkipped );  /* another producer is comparing a log message of the queue */
+        }
+    }
+#endif
+
+    bool isRepeat = false;
+    if( NULL != last )
+    {
+        bool identical = ( NULL != last->fmt ) && ( ev->fmt == last->fmt ) && ( ev->context == last->context ) && ( ev->file == last->file ) &&
+                         ( ev->line == last->line ) && ( ev->level == last->level ) && ( length == last->length ) &&
+                         ( 0 == memcmp( args, last->args, length ) );
+        if( identical && ( ( ev->time - last->time ) < LOG_COALESCE_TIMEOUT ) )
+        {
+            last->repeats++;
+            isRepeat = true;
+        }
+        else
+        {
+            flushRepeats( last, lockAcquired );
+            last->fmt = truncated ? NULL : ev->fmt;  /* a log message with truncated arguments cannot be compared */
+            last->context = ev->context;
+            last->file = ev->file;
+            last->line = ev->line;
+            last->level = ev->level;
+#if LOG_USE_MODULES
+            last->module = ev->module;
+#endif
+            last->time = ev->time;
+            last->length = length;
+            memcpy( last->args, args, length );
+        }
+    }
+#if LOG_USE_ASYNC
+    if( ( NULL != queue ) && ( NULL != last ) )
+    {
+        atomicStore( &queue->coalesceBusy, 0U );
+    }
+#endif
+    return isRepeat;
+}
+
+/**
+ * @brief Write the repeat count of the last log message, if it has been repeated, and reset it.
+ *
+ * @param last Last log message, which is held by the caller.
+ * @param lockAcquired Flag that indicates the lock of the logger context of the last log message is held.
+ */
+static void flushRepeats( tCoalesceState* last, bool lockAcquired )
+{
+    if( last->repeats > 0U )
+    {
+        tLog_event ev = {
+            .time    = getTimestamp(),
+            .level   = last->level,
+            .file    = last->file,
+            .line    = last->line,
+#if LOG_USE_MODULES
+            .module  = last->module,
+#endif
+            .context = last->context
+        };
+        writeRepeats( &ev, lockAcquired, log_repeatedFormat, (unsigned long)last->repeats );
+        last->repeats = 0U;
+    }
+}
+
+/**
+ * @brief Write the repeat count of a coalesced log message, which is not coalesced itself.
+ *
+ * The repeat count is written by the caller, which holds the last log message,
+ * so it is printed and passed to the callbacks only if the lock of the logger
+ * context is held, and otherwise it is only queued for the console.
+ *
+ * @param ev Log event data, with the timestamp, level, filename and line number of the repeated log message set.
+ * @param lockAcquired Flag that indicates the lock of the logger context is held.
+ * @param fmt printf format string of the repeat count.
+ * @param ... printf arguments.
+ */
+static void writeRepeats( tLog_event* ev, bool lockAcquired, const char* fmt, ... )
+{
+    tLog_context* context = eventContext( ev );
+    bool writeToConsole = writesToConsole( context, ev );
+#if LOG_USE_CALLBACKS
+    bool invokeCallbacks = ( ev->level >= context->callbackLevel );
+#else
+    bool invokeCallbacks = false;
+#endif
+#if LOG_USE_ASYNC
+    bool queueToConsole = writeToConsole && logConfig.asyncEnabled;
+#else
+    bool queueToConsole = false;
+#endif
+
+    ev->fmt = fmt;
+    va_list ap;
+    va_start( ap, fmt );
+#if LOG_USE_CRASH_LOG
+    if( ( writeToConsole || invokeCallbacks ) && !logConfig.crashLogReplay )
+    {
+        recordCrashEvent( ev, ap );
+    }
+#endif
+    (void)deliverEvent( context, ev, ap, queueToConsole, lockAcquired && writeToConsole && !queueToConsole, lockAcquired && invokeCallbacks );
+    va_end( ap );
+}
+#endif
+
+#if LOG_USE_CRASH_LOG
+/**
+ * @brief Update a CRC-32 with a block of data, using a 4-bit lookup table.
+ *
+ * @param crc CRC-32 of the preceding data, or 0 for the first block.
+ * @param data Data.
+ * @param size Size of the data in bytes.
+ * @return CRC-32 of the data.
+ */
+static uint32_t crc32( uint32_t crc, const void* data, size_t size )
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    crc = ~crc;
+    for( size_t i = 0U; i < size; i++ )
+    {
+        crc ^= bytes[i];
+        crc = ( crc >> 4 ) ^ crc32Nibbles[crc & 0x0FU];
+        crc = ( crc >> 4 ) ^ crc32Nibbles[crc & 0x0FU];
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Calculate the CRC-32 of the crash log header fields that identify a valid crash log.
+ *
+ * @return CRC-32 of the magic number, length and record size.
+ */
+static uint32_t crashLogHeaderCrc( void )
+{
+    uint32_t header[3] = { crashLog.magic, crashLog.length, crashLog.recordSize };
+    return crc32( 0U, header, sizeof( header ) );
+}
+
+#if LOG_CRASH_RECORD_CRC
+/**
+ * @brief Calculate the CRC-32 of a crash log record.
+ *
+ * @param record Crash log record.
+ * @return CRC-32 of the record from the filename pointer to the end of the packed printf arguments.
+ */
+static uint32_t crashRecordCrc( const tCrashRecord* record )
+{
+    return crc32( 0U, &record->file, offsetof( tCrashRecord, args ) - offsetof( tCrashRecord, file ) + record->length );
+}
+#endif
+
+/**
+ * @brief Empty the crash log and write a valid header.
+ */
+static void resetCrashLog( void )
+{
+    for( size_t i = 0U; i < LOG_CRASH_LOG_LENGTH; i++ )
+    {
+        crashLog.records[i].sequence = 0U;
+    }
+    crashLog.writePosition = 0U;
+    crashLog.magic = LOG_CRASH_LOG_MAGIC;
+    crashLog.length = LOG_CRASH_LOG_LENGTH;
+    crashLog.recordSize = (uint32_t)sizeof( tCrashRecord );
+    crashLog.crc = crashLogHeaderCrc();
+}
+
+/**
+ * @brief Store a log message in the next record of the crash log.
+ *
+ * The record holds the filename and format string pointers and the packed
+ * printf arguments, so the log message is not formatted. A writer reserves a
+ * position with an atomic increment of the write position, claims its record 
+ * by changing the sequence number to CRASH_RECORD_BUSY with a compare-and-swap,
+ * and commits it by storing its sequence number last, so a record that was 
+ * being written when the reset occurred is discarded by log_recoverCrashLog().
+ * If a writer that is LOG_CRASH_LOG_LENGTH positions behind or ahead holds the
+ * record, the log message is dropped, so a committed record is never torn by 
+ * two writers, even without a CRC. The CRC-32 of the record is only calculated
+ * if LOG_CRASH_RECORD_CRC is set.
+ *
+ * The first writer after startup validates the header, or resets the crash log,
+ * before any record is reserved. A writer that finds another one doing so drops
+ * its record, so the header is never reset after a record has been reserved.
+ *
+ * @param ev Log event data, with the timestamp set.
+ * @param ap printf variadic arguments list.
+ */
+static void recordCrashEvent( const tLog_event* ev, va_list ap )
+{
+    if( CRASH_LOG_READY != atomicLoad( &logConfig.crashLogState ) )
+    {
+        if( !atomicCompareExchange( &logConfig.crashLogState, CRASH_LOG_UNCHECKED, CRASH_LOG_CHECKING ) )
+        {
+            return;  /* another writer is checking the header: the record is dropped rather than waiting, e.g. in an ISR */
+        }
+        /* keep the records of a valid crash log, which have not been recovered */
+        if( ( LOG_CRASH_LOG_MAGIC != crashLog.magic ) || ( crashLogHeaderCrc() != crashLog.crc ) )
+        {
+            resetCrashLog();
+        }
+        else
+        {
+            for( size_t i = 0U; i < LOG_CRASH_LOG_LENGTH; i++ )
+            {
+                if( CRASH_RECORD_BUSY == crashLog.records[i].sequence )
+                {
+                    crashLog.records[i].sequence = 0U;  /* release a record that was being written when the reset occurred */
+                }
+            }
+        }
+        atomicStore( &logConfig.crashLogState, CRASH_LOG_READY );
+    }
+
+    uint32_t position = atomicFetchAdd( &crashLog.writePosition, 1U );
+    tCrashRecord* record = &crashLog.records[position & ( LOG_CRASH_LOG_LENGTH - 1U )];
+    uint32_t sequence = atomicLoad( &record->sequence );
+    if( ( CRASH_RECORD_BUSY == sequence ) || ( CRASH_RECORD_BUSY == ( position + 1U ) ) || ( 0U == ( position + 1U ) ) ||
+        !atomicCompareExchange( &record->sequence, sequence, CRASH_RECORD_BUSY ) )
+    {
+        return;  /* the record is held by another writer, or the position has no valid sequence number */
+    }
+    record->file = ev->file;
+    record->fmt = ev->fmt;
+    record->time = ev->time;
+    record->line = (int32_t)ev->line;
+    record->level = (uint8_t)ev->level;
+#if LOG_USE_MODULES
+    record->module = (int16_t)ev->module;
+#else
+    record->module = 0;
+#endif
+    record->length = (uint8_t)packArgs( record->args, sizeof( record->args ), ev->fmt, ap, NULL );
+#if LOG_CRASH_RECORD_CRC
+    record->crc = crashRecordCrc( record );
+#endif
+    atomicStore( &record->sequence, position + 1U );
+}
+
+/**
+ * @brief Write a log message recovered from the crash log, with its original timestamp.
+ *
+ * @param ev Log event data, with the timestamp, level, filename and line number set.
+ * @param fmt printf format string.
+ * @param ... printf arguments.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+static int replayEvent( tLog_event* ev, const char* fmt, ... )
+{
+    ev->fmt = fmt;
+    va_list ap;
+    va_start( ap, fmt );
+    int result = writeEvent( ev, ap );
+    va_end( ap );
+    return result;
+}
+#endif
+
+/**
+ * @brief Timestamp a log event and write it.
+ *
+ * @param ev Log event data, with the level, filename, line number and format string set.
+ * @param ap printf variadic arguments list.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+static int logEvent( tLog_event* ev, va_list ap )
+{
+    ev->time = getTimestamp();
+    return writeEvent( ev, ap );
+}
+
+#if LOG_DEFERRED_FORMAT
+/**
+ * @brief Timestamp and write a log event whose printf arguments have been packed by the caller.
+ *
+ * If the log message is only queued for the console, the packed arguments are
+ * copied into the queue slot as they are. Otherwise, the log message body is 
+ * formatted from the packed arguments and written with the format string "%s",
+ * so that the console, callbacks, coalescing and crash log receive the text.
+ *
+ * @param ev Log event data, with the level, filename, line number and format string set.
+ * @param args Packed printf arguments.
+ * @param argsLength Number of bytes of packed printf arguments.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+static int logPacked( tLog_event* ev, const uint8_t* args, size_t argsLength )
+{
+    int level = ev->level;
+    tLog_context* context = eventContext( ev );
+    bool writeToConsole = writesToConsole( context, ev );
+#if LOG_USE_CALLBACKS
+    bool invokeCallbacks = ( level >= context->callbackLevel );
+#else
+    bool invokeCallbacks = false;
+#endif
+
+#if !LOG_USE_COALESCE && !LOG_USE_CRASH_LOG
+    if( writeToConsole && !invokeCallbacks && logConfig.asyncEnabled )
+    {
+        ev->time = getTimestamp();
+#if LOG_USE_STATS
+        countEvent( &context->stats.calls[level] );
+#endif
+        int result = enqueue( ev, args, argsLength );
+        if( result < 0 )
+        {
+            countDropped( context, level, &context->stats.queueFull );
+        }
+        return result;
+    }
+#else
+    (void)writeToConsole;
+    (void)invokeCallbacks;
+#endif
+
+    char text[LOG_DEFERRED_RENDER_SIZE];
+    (void)renderArgs( text, sizeof( text ), ev->fmt, args, argsLength );
+    return logText( ev, "%s", text );
+}
+#endif
+
+/**
+ * @brief Write a log event to the console and pass it to the registered callbacks.
+ *
+ * @param ev Log event data, with the timestamp, level, filename, line number and format string set.
+ * @param ap printf variadic arguments list.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+static int writeEvent( tLog_event* ev, va_list ap )
+{
+    int level = ev->level;
+    tLog_context* context = eventContext( ev );
+#if LOG_USE_STATS
+    countEvent( &context->stats.calls[level] );
+#endif
+
+    bool writeToConsole = writesToConsole( context, ev );
+#if LOG_USE_CALLBACKS
+    bool invokeCallbacks = ( level >= context->callbackLevel );
+#else
+    bool invokeCallbacks = false;
+#endif
+
+#if LOG_USE_STATS
+    if( !writeToConsole && !invokeCallbacks )
+    {
+        countEvent( &context->stats.suppressed[level] );
+    }
+#endif
+
+#if LOG_USE_ASYNC
+    bool queueToConsole = writeToConsole && logConfig.asyncEnabled;  /* queued for printing by log_drain(), without taking the lock */
+#else
+    bool queueToConsole = false;
+#endif
+    bool lockRequired = ( writeToConsole && !queueToConsole ) || invokeCallbacks;
+    bool lockAcquired = lockRequired && lock( context );
+    if( lockRequired && !lockAcquired )
+    {
+        if( queueToConsole )
+        {
+            countEvent( &context->stats.callbackLockFailures );  /* not dropped: it is still printed by log_drain() */
+        }
+        else
+        {
+            countDropped( context, level, &context->stats.lockFailures );
+        }
+    }
+
+#if LOG_USE_FIELDS && ( LOG_USE_COALESCE || LOG_USE_CRASH_LOG )
+    if( writeToConsole || invokeCallbacks )
+    {
+        renderFields( ev );  /* coalescing and the crash log read the text of a structured log message */
+    }
+#endif
+
+#if LOG_USE_COALESCE
+    /* a repeat of the last log message is counted instead of written */
+    bool isRepeat = ( queueToConsole || lockAcquired ) && coalesceEvent( context, ev, ap, lockAcquired );
+#else
+    bool isRepeat = false;
+#endif
+
+#if LOG_USE_CRASH_LOG
+    if( !isRepeat && ( writeToConsole || invokeCallbacks ) && !logConfig.crashLogReplay )
+    {
+        recordCrashEvent( ev, ap );
+    }
+#endif
+
+    int result = 0;
+    if( !isRepeat )
+    {
+        result = deliverEvent( context, ev, ap, queueToConsole, lockAcquired && writeToConsole && !queueToConsole, lockAcquired && invokeCallbacks );
+    }
+
+    if( lockAcquired )
+    {
+        unlock( context );
+    }
+    return result;
+}
+
+/**
+ * @brief Queue and print a log event, and pass it to the registered callbacks.
+ *
+ * @param context Logger context of the log event.
+ * @param ev Log event data, with the timestamp, level, filename, line number and format string set.
+ * @param ap printf variadic arguments list.
+ * @param queueToConsole Flag to queue the log message for printing by log_drain().
+ * @param printToConsole Flag to print the log message to the console, which requires the lock to be held.
+ * @param invokeCallbacks Flag to invoke the registered callbacks, which requires the lock to be held.
+ * @return Number of characters printed or queued if successful. On error, it returns a negative value.
+ */
+static int deliverEvent( tLog_context* context, tLog_event* ev, va_list ap, bool queueToConsole, bool printToConsole, bool invokeCallbacks )
+{
+    int result = 0;
+
+#if LOG_USE_FIELDS
+#if LOG_USE_MESSAGE_BUFFER && LOG_LAZY_FORMAT
+    bool renderText = queueToConsole || printToConsole;  /* the callbacks format the text by log_eventText(), if they read it */
+#else
+    bool renderText = queueToConsole || printToConsole || invokeCallbacks;
+#endif
+    if( renderText )
+    {
+        renderFields( ev );
+    }
+#endif
+
+#if LOG_USE_MESSAGE_BUFFER
+    /* the log message body is formatted once, for the console and all callbacks, by the first call of log_eventText() */
+    char text[LOG_MESSAGE_BUFFER_SIZE];
+    ev->buffer = text;
+    ev->text = NULL;
+#if !LOG_LAZY_FORMAT
+#if LOG_DEFERRED_FORMAT
+    bool formatText = invokeCallbacks || printToConsole;
+#else
+    bool formatText = invokeCallbacks || printToConsole || queueToConsole;
+#endif
+    if( formatText )
+    {
+        va_copy( ev->ap, ap );
+        (void)log_eventText( ev, NULL );
+        va_end( ev->ap );
+    }
+#endif
+#endif
+
+#if LOG_USE_ASYNC
+    if( queueToConsole )
+    {
+        /* queue log message for printing by log_drain(), without taking the lock */
+        va_copy( ev->ap, ap );
+        result = enqueue( ev, NULL, 0U );
+        va_end( ev->ap );
+        if( result < 0 )
+        {
+            countDropped( context, ev->level, &context->stats.queueFull );
+        }
+    }
+#else
+    (void)queueToConsole;
+#endif
+
+    /* write log messages to console */
+    if( printToConsole )
+    {
+#if LOG_USE_STATS
+        tLog_timestamp printStart = getTimestamp();
+#endif
+        va_copy( ev->ap, ap );
+        result = log_print( ev );
+        va_end( ev->ap );
+#if LOG_USE_STATS
+        countDuration( context->stats.printTime, printStart );
+        context->stats.bytes += ( result > 0 ) ? (uint64_t)result : 0U;
+#endif
+    }
+
+#if LOG_USE_CALLBACKS
+    /* invoke the registered logging callbacks at or below the log message level */
+    if( invokeCallbacks )
+    {
+        const tCallbackSnapshot* snapshot = &context->snapshot;
+        for( size_t i = 0; ( i < snapshot->count ) && ( ev->level >= snapshot->callbacks[i].cbLogLevel ); i++ )
+        {
+            const tCallback* cb = &snapshot->callbacks[i];
+#if LOG_USE_STATS
+            tLog_timestamp callbackStart = getTimestamp();
+#endif
+            va_copy( ev->ap, ap );
+            cb->cbFn( ev, cb->cbData );
+            va_end( ev->ap );
+#if LOG_USE_STATS
+            countDuration( context->stats.callbackTime[cb->slot], callbackStart );
+            context->stats.callbackInvocations++;
+#endif
+        }
+    }
+#else
+    (void)context;
+    (void)invokeCallbacks;
+#endif
+
+#if LOG_USE_MESSAGE_BUFFER
+    ev->text = NULL;  /* the formatted log message body does not outlive this function */
+    ev->buffer = NULL;
+#endif
+    return result;
+}
+
+
+/* Public function definitions ----------------------------------------------*/
+
+#if LOG_USE_MESSAGE_BUFFER
+const char* log_eventText( tLog_event* ev, size_t* length )
+{
+    if( ( NULL == ev->text ) && ( NULL != ev->buffer ) )
+    {
+#if LOG_USE_FIELDS
+        renderFields( ev );  /* the text of a structured log message is the printf argument */
+#endif
+        va_list args;
+        va_copy( args, ev->ap );
+        int textLength = LOG_VSNPRINTF( ev->buffer, LOG_MESSAGE_BUFFER_SIZE, ev->fmt, args );
+        va_end( args );
+        ev->textLength = writtenLength( textLength, LOG_MESSAGE_BUFFER_SIZE );
+        ev->buffer[ev->textLength] = '\0';
+        ev->text = ev->buffer;
+    }
+    if( NULL != length )
+    {
+        *length = ( NULL != ev->text ) ? ev->textLength : 0U;
+    }
+    return ( NULL != ev->text ) ? ev->text : "";
+}
+#endif
+
+tLog_context* log_getDefaultContext( void )
+{
+    return &defaultContext;
+}
+
+#if LOG_MAX_CONTEXTS > 0U
+tLog_context* log_createContext( void )
+{
+    tLog_context* context = NULL;
+    if( contextCount < LOG_MAX_CONTEXTS )
+    {
+        context = &contextPool[contextCount++];
+        memset( context, 0, sizeof( *context ) );
+        context->lockTimeout = LOG_LOCK_WAIT_FOREVER;
+        context->level = LOG_TRACE;
+        updateEffectiveLevel( context );
+    }
+    return context;
+}
+#endif
+
+bool log_isContextEnabled( const tLog_context* context, int level )
+{
+    return level >= ( ( NULL != context ) ? context : &defaultContext )->effectiveLevel;
+}
+
+void log_setLockFn( tLog_lockFn lockFn, void* lockData )
+{
+    log_setContextLockFn( &defaultContext, lockFn, lockData );
+}
+
+void log_setContextLockFn( tLog_context* context, tLog_lockFn lockFn, void* lockData )
+{
+    context->timedLockFn = NULL;
+    context->lockFn = lockFn;
+    context->lockData = lockData;
+}
+
+void log_setTimedLockFn( tLog_timedLockFn lockFn, void* lockData )
+{
+    log_setContextTimedLockFn( &defaultContext, lockFn, lockData );
+}
+
+void log_setContextTimedLockFn( tLog_context* context, tLog_timedLockFn lockFn, void* lockData )
+{
+    context->lockFn = NULL;
+    context->timedLockFn = lockFn;
+    context->lockData = lockData;
+}
+
+void log_setLockTimeout( uint32_t timeout )
+{
+    log_setContextLockTimeout( &defaultContext, timeout );
+}
+
+void log_setContextLockTimeout( tLog_context* context, uint32_t timeout )
+{
+    context->lockTimeout = timeout;
+}
+
+void log_getStats( tLog_stats* stats )
+{
+    log_getContextStats( &defaultContext, stats );
+}
+
+void log_getContextStats( const tLog_context* context, tLog_stats* stats )
+{
+    *stats = context->stats;
+}
+
+void log_resetStats( void )
+{
+    log_resetContextStats( &defaultContext );
+}
+
+void log_resetContextStats( tLog_context* context )
+{
+    memset( &context->stats, 0, sizeof( context->stats ) );
+}
+
+#if LOG_USE_STATS
+int log_countSuppressed( tLog_context* context, int level )
+{
+    tLog_context* counted = ( NULL != context ) ? context : &defaultContext;
+    countEvent( &counted->stats.calls[level] );
+    countEvent( &counted->stats.suppressed[level] );
+    return 0;
+}
+#endif
+
+void log_setTimestampFn( tLog_timestampFn timestampFn )
+{
+    logConfig.timestampFn = timestampFn;
+}
+
+void log_setTimestampDivisor( uint32_t divisor )
+{
+    logConfig.timestampDivisor = divisor;
+}
+
+#if LOG_USE_CYCLE_COUNTER
+void log_enableCycleCounter( void )
+{
+#if defined( __arm__ )
+    DEM_CR |= DEM_CR_TRCENA;
+    DWT_LAR = 0xC5ACCE55UL;  /* unlock the DWT, which is required on Cortex-M7 and ignored by the other cores */
+    DWT_CYCCNT = 0U;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+#endif
+}
+#endif
+
+void log_setLevel( int level )
+{
+    log_setContextLevel( &defaultContext, level );
+}
+
+void log_setContextLevel( tLog_context* context, int level )
+{
+    context->level = level;
+    updateEffectiveLevel( context );
+}
+
+#if LOG_USE_SAMPLING
+bool log_setSampleRate( int level, uint32_t rate )
+{
+    bool validLevel = ( level >= LOG_TRACE ) && ( level <= LOG_FATAL );
+    if( validLevel )
+    {
+        log_sampleRate[level] = rate;
+    }
+    return validLevel;
+}
+#endif
+
+#if LOG_USE_MODULES
+bool log_setModuleLevel( int module, int level )
+{
+    bool validModule = ( module >= 0 ) && ( module < (int)LOG_MAX_MODULES );
+    if( validModule )
+    {
+        logConfig.moduleLevelSet[module] = ( LOG_LEVEL_INHERIT != level );
+        logConfig.moduleLevels[module] = (int8_t)level;
+        updateEffectiveLevel( &defaultContext );
+    }
+    return validModule;
+}
+#endif
+
+void log_off( void )
+{
+    log_contextOff( &defaultContext );
+}
+
+void log_contextOff( tLog_context* context )
+{
+    context->consoleLoggingDisabled = true;
+    updateEffectiveLevel( context );
+}
+
+void log_on( void )
+{
+    log_contextOn( &defaultContext );
+}
+
+void log_contextOn( tLog_context* context )
+{
+    context->consoleLoggingDisabled = false;
+    updateEffectiveLevel( context );
+}
+
+#if LOG_USE_CALLBACKS
+bool log_registerCallbackFn( tLog_callbackFn cbFn, void* cbData, int cbLogLevel )
+{
+    return log_registerContextCallbackFn( &defaultContext, cbFn, cbData, cbLogLevel );
+}
+
+bool log_registerContextCallbackFn( tLog_context* context, tLog_callbackFn cbFn, void* cbData, int cbLogLevel )
+{
+    bool registered = false;
+    if( lockRegistration( context ) )
+    {
+        (void)removeCallback( context, cbFn, cbData );  /* remove existing registration, if any, to prevent duplicates */
+        for( size_t i = 0U; ( !registered ) && ( i < LOG_MAX_CALLBACKS); i++ )
+        {
+            if( NULL == context->callbacks[i].cbFn )
+            {
+                /* Register the new callback function pointer, logging level and data object */
+                context->callbacks[i] = (tCallback) { .cbFn = cbFn, .cbData = cbData, .cbLogLevel = cbLogLevel };
+                registered = true;
+            }
+        }
+        buildCallbackSnapshot( context );
+        updateEffectiveLevel( context );
+        unlock( context );
+    }
+    return registered;
+}
+
+void log_unregisterCallbackFn( tLog_callbackFn cbFn, void* cbData )
+{
+    log_unregisterContextCallbackFn( &defaultContext, cbFn, cbData );
+}
+
+void log_unregisterContextCallbackFn( tLog_context* context, tLog_callbackFn cbFn, void* cbData )
+{
+    if( lockRegistration( context ) )
+    {
+        if( removeCallback( context, cbFn, cbData ) )
+        {
+            buildCallbackSnapshot( context );
+        }
+        updateEffectiveLevel( context );
+        unlock( context );
+    }
 }
 #endif
 
-int log_log( int level, const char* file, int line, const char* fmt, ... )
+#if LOG_USE_ASYNC
+void log_setContextIdFn( tLog_contextIdFn contextIdFn )
+{
+    logConfig.contextIdFn = contextIdFn;
+}
+
+void log_setAsync( bool async )
+{
+    if( async && !logConfig.queueInitialised )
+    {
+        for( size_t q = 0U; q < LOG_ASYNC_QUEUE_COUNT; q++ )
+        {
+            for( uint32_t i = 0U; i < LOG_ASYNC_QUEUE_LENGTH; i++ )
+            {
+                logConfig.queues[q].slots[i].sequence = i;  /* all slots are free */
+            }
+        }
+        logConfig.queueInitialised = true;
+    }
+    logConfig.asyncEnabled = async;
+}
+
+int log_drain( void )
 {
     int result = 0;
-    tLog_event ev = {
-        .level = level,
-        .file  = file,
-        .line  = line,
-        .fmt   = fmt
+    bool empty = !logConfig.queueInitialised;
+
+    while( !empty )
+    {
+        /* find the oldest log message at the head of all queues */
+        tQueue* queue = NULL;
+        tQueueSlot* slot = NULL;
+        for( size_t q = 0U; q < LOG_ASYNC_QUEUE_COUNT; q++ )
+        {
+            tQueueSlot* head = peekQueue( &logConfig.queues[q] );
+            if( ( NULL != head ) && ( ( NULL == slot ) || TIMESTAMP_BEFORE( head->time, slot->time ) ) )
+            {
+                queue = &logConfig.queues[q];
+                slot = head;
+            }
+        }
+
+        if( NULL == slot )
+        {
+            empty = true;  /* no slot has been published by a producer */
+        }
+        else
+        {
+            uint32_t position = queue->readPosition;
+#if LOG_USE_STATS
+            tLog_timestamp printStart = getTimestamp();
+#endif
+#if LOG_USE_CHUNK_OUTPUT
+            bool handedOut = false;
+            int printResult = 0;
+            uint32_t length = slot->length;  /* a handed out slot may be released by log_releaseChunk() before the driver returns */
+            if( NULL != logConfig.chunkWriteFn )
+            {
+                /* hand the log message to the driver, which holds a reference until it has been transmitted */
+                atomicStore( &slot->references, 1U );
+                handedOut = logConfig.chunkWriteFn( slot->data, length, logConfig.chunkWriteData );
+                if( handedOut )
+                {
+                    printResult = (int)length;
+                }
+                else
+                {
+                    atomicStore( &slot->references, 0U );
+                    empty = true;  /* the driver is busy: the log message is handed out again by the next call */
+                }
+            }
+            else
+            {
+                printResult = LOG_WRITE_LINE( slot->data, length );
+            }
+#else
+            tLog_event ev = {
+                .time  = slot->time,
+                .level = slot->level,
+                .file  = slot->file,
+                .line  = slot->line
+            };
+#if LOG_DEFERRED_FORMAT
+            char message[LOG_DEFERRED_RENDER_SIZE];
+            renderArgs( message, sizeof( message ), slot->fmt, slot->data, slot->length );
+            int printResult = log_printText( &ev, message );
+#else
+            int printResult = log_printText( &ev, slot->data );
+#endif
+#endif
+#if LOG_USE_STATS
+            if( printResult > 0 )
+            {
+                countDuration( defaultContext.stats.printTime, printStart );  /* not a busy chunk write driver */
+                defaultContext.stats.bytes += (uint64_t)printResult;
+            }
+#endif
+            if( ( result >= 0 ) && ( printResult >= 0 ) )
+            {
+                result += printResult;
+            }
+            else
+            {
+                result = -1;
+            }
+#if LOG_USE_CHUNK_OUTPUT
+            if( !empty )
+            {
+                if( !handedOut )
+                {
+                    atomicStore( &slot->sequence, position + LOG_ASYNC_QUEUE_LENGTH );  /* release the slot to producers */
+                }
+                queue->readPosition = position + 1U;  /* a handed out slot is released by log_releaseChunk() */
+            }
+#else
+            atomicStore( &slot->sequence, position + LOG_ASYNC_QUEUE_LENGTH );  /* release the slot to producers */
+            queue->readPosition = position + 1U;
+#endif
+        }
+    }
+    return result;
+}
+#endif
+
+#if LOG_USE_CHUNK_OUTPUT
+void log_setChunkWriteFn( tLog_chunkWriteFn writeFn, void* writeData )
+{
+    logConfig.chunkWriteData = writeData;
+    logConfig.chunkWriteFn = writeFn;
+}
+
+void log_retainChunk( const char* chunk )
+{
+    (void)atomicFetchAdd( &chunkSlot( chunk )->references, 1U );
+}
+
+void log_releaseChunk( const char* chunk )
+{
+    tQueueSlot* slot = chunkSlot( chunk );
+    if( 1U == atomicFetchAdd( &slot->references, (uint32_t)-1 ) )
+    {
+        /* the last reference has been released: the published sequence number is the queue position plus one */
+        atomicStore( &slot->sequence, atomicLoad( &slot->sequence ) - 1U + LOG_ASYNC_QUEUE_LENGTH );
+    }
+}
+#endif
+
+#if LOG_USE_BATCH_SINK
+void log_batchSinkInit( tLog_batchSink* sink, tLog_batchCallbackFn batchFn, void* batchData, size_t maxEvents, size_t maxBytes, tLog_timestamp maxAge )
+{
+    sink->batchFn = batchFn;
+    sink->batchData = batchData;
+    sink->maxEvents = ( ( 0U == maxEvents ) || ( maxEvents > LOG_BATCH_MAX_EVENTS ) ) ? LOG_BATCH_MAX_EVENTS : maxEvents;
+    sink->maxBytes = ( ( 0U == maxBytes ) || ( maxBytes > LOG_BATCH_BUFFER_SIZE ) ) ? LOG_BATCH_BUFFER_SIZE : maxBytes;
+    sink->maxAge = maxAge;
+    sink->count = 0U;
+    sink->length = 0U;
+}
+
+void log_batchCallback( tLog_event* ev, void* cbData )
+{
+    tLog_batchSink* sink = cbData;
+    size_t textLength = formatEventText( &sink->text[sink->length], sink->maxBytes - sink->length, ev );
+    if( ( ( sink->length + textLength ) >= sink->maxBytes ) && ( sink->count > 0U ) )
+    {
+        /* the log message body does not fit: deliver the batch, then format the body at the start of the buffer */
+        deliverBatch( sink );
+        textLength = formatEventText( sink->text, sink->maxBytes, ev );
+    }
+    if( textLength >= ( sink->maxBytes - sink->length ) )
+    {
+        textLength = sink->maxBytes - sink->length - 1U;  /* log message body has been truncated */
+    }
+
+    sink->events[sink->count++] = (tLog_batchEvent) {
+        .time = ev->time,
+        .level = ev->level,
+        .file = ev->file,
+        .line = ev->line,
+        .text = &sink->text[sink->length],
+        .textLength = textLength
     };
-    ev.time = getTimestamp();
+    sink->length += textLength + 1U;
 
-    bool lockAcquired = lock();
+    bool full = ( sink->count >= sink->maxEvents ) || ( sink->length >= sink->maxBytes );
+    bool expired = ( sink->maxAge > 0U ) && ( ( ev->time - sink->events[0U].time ) >= sink->maxAge );
+    if( full || expired )
+    {
+        deliverBatch( sink );
+    }
+}
+#endif
 
-    if( lockAcquired )
+#if LOG_USE_MMAP_SINK
+bool log_mmapSinkOpen( tLog_mmapSink* sink, const char* path, size_t segmentSize, unsigned int maxFiles, size_t syncBytes )
+{
+    long pageSize = sysconf( _SC_PAGESIZE );
+    *sink = (tLog_mmapSink) {
+        .fd = -1,
+        .map = NULL,
+        .size = segmentSize,
+        .syncBytes = syncBytes,
+        .pageSize = ( pageSize > 0 ) ? (size_t)pageSize : 4096U,
+        .maxFiles = maxFiles,
+        .rotations = 0U
+    };
+    size_t pathLength = strlen( path );
+    bool opened = ( pathLength < sizeof( sink->path ) ) && ( segmentSize > 0U );
+    if( opened )
     {
-        /* write log messages to console */
-        if( !logConfig.consoleLoggingDisabled && ( level >= logConfig.level ) )
+        memcpy( sink->path, path, pathLength + 1U );
+        rotateLogFiles( sink );  /* keep the log file of the previous run */
+        opened = mapLogFile( sink );
+    }
+    return opened;
+}
+
+bool log_mmapSinkSync( tLog_mmapSink* sink )
+{
+    bool synced = ( NULL != sink->map ) && ( 0 == msync( sink->map, sink->size, MS_SYNC ) );
+    if( synced )
+    {
+        sink->syncedLength = sink->length;
+    }
+    return synced;
+}
+
+void log_mmapSinkClose( tLog_mmapSink* sink )
+{
+    unmapLogFile( sink );
+}
+
+void log_mmapCallback( tLog_event* ev, void* cbData )
+{
+    tLog_mmapSink* sink = cbData;
+    char record[LOG_MMAP_RECORD_SIZE + 1U];
+    size_t length = log_formatPrefix( record, sizeof( record ), ev );
+    size_t textLength = formatEventText( &record[length], sizeof( record ) - length, ev );
+    length = ( textLength < ( sizeof( record ) - length ) ) ? ( length + textLength ) : ( sizeof( record ) - 1U );
+    if( ( 0U == length ) || ( '\n' != record[length - 1U] ) )
+    {
+        /* terminate the record with a newline, replacing the last character if the record has been truncated */
+        length = ( length < LOG_MMAP_RECORD_SIZE ) ? length : ( LOG_MMAP_RECORD_SIZE - 1U );
+        record[length++] = '\n';
+    }
+
+    if( ( NULL != sink->map ) && ( ( sink->length + length ) > sink->size ) )
+    {
+        /* the log message does not fit: rotate the log file */
+        unmapLogFile( sink );
+        rotateLogFiles( sink );
+        (void)mapLogFile( sink );
+        sink->rotations++;
+    }
+    if( NULL != sink->map )
+    {
+        length = ( length <= sink->size ) ? length : sink->size;
+        memcpy( &sink->map[sink->length], record, length );
+        sink->length += length;
+        if( ( sink->syncBytes > 0U ) && ( ( sink->length - sink->syncedLength ) >= sink->syncBytes ) )
         {
-            va_start( ev.ap, fmt );
-            result = log_print( &ev );
-            va_end( ev.ap );
+            /* start write-back of the pages written since the last msync(), without waiting for completion */
+            size_t start = sink->syncedLength & ~( sink->pageSize - 1U );
+            (void)msync( &sink->map[start], sink->length - start, MS_ASYNC );
+            sink->syncedLength = sink->length;
         }
+    }
+}
+#endif
 
-#if LOG_USE_CALLBACKS
-        /* invoke all registered logging callbacks */
-        for( size_t i = 0; i < LOG_MAX_CALLBACKS; i++ )
+#if LOG_USE_BATCH_SINK || LOG_USE_COALESCE
+bool log_flush( void )
+{
+    bool flushed = true;
+    /* flush the default context, then each allocated logger context, with its lock held */
+#if LOG_MAX_CONTEXTS > 0U
+    size_t contextTotal = 1U + contextCount;
+#else
+    size_t contextTotal = 1U;
+#endif
+    for( size_t c = 0U; flushed && ( c < contextTotal ); c++ )
+    {
+#if LOG_MAX_CONTEXTS > 0U
+        tLog_context* context = ( 0U == c ) ? &defaultContext : &contextPool[c - 1U];
+#else
+        tLog_context* context = &defaultContext;
+#endif
+        flushed = lock( context );
+        if( flushed )
+        {
+#if LOG_USE_COALESCE
+            flushRepeats( &context->coalesce, true );
+#endif
+#if LOG_USE_BATCH_SINK
+            const tCallbackSnapshot* snapshot = &context->snapshot;
+            for( size_t i = 0; i < snapshot->count; i++ )
+            {
+                if( log_batchCallback == snapshot->callbacks[i].cbFn )
+                {
+                    deliverBatch( snapshot->callbacks[i].cbData );
+                }
+            }
+#endif
+            unlock( context );
+        }
+    }
+#if LOG_USE_COALESCE && LOG_USE_ASYNC
+    /* the repeat count of the last log message of a queue is only queued */
+    for( size_t q = 0U; flushed && ( q < LOG_ASYNC_QUEUE_COUNT ); q++ )
+    {
+        tQueue* queue = &logConfig.queues[q];
+        flushed = atomicCompareExchange( &queue->coalesceBusy, 0U, 1U );
+        if( flushed )
+        {
+            flushRepeats( &queue->coalesce, false );
+            atomicStore( &queue->coalesceBusy, 0U );
+        }
+    }
+#endif
+    return flushed;
+}
+#endif
+
+#if LOG_USE_RATELIMIT
+bool log_ratelimit( tLog_ratelimit* ratelimit, uint32_t burst, tLog_timestamp interval, uint32_t* suppressed )
+{
+    tLog_timestamp time = getTimestamp();
+    if( ( time - ratelimit->start ) >= interval )
+    {
+        /* the previous interval has elapsed: start a new interval */
+        ratelimit->start = time;
+        ratelimit->count = 0U;
+    }
+
+    bool allowed = ( ratelimit->count < burst );
+    if( allowed )
+    {
+        ratelimit->count++;
+        *suppressed = ratelimit->suppressed;
+        ratelimit->suppressed = 0U;
+    }
+    else
+    {
+        ratelimit->suppressed++;
+    }
+    return allowed;
+}
+#endif
+
+#if LOG_USE_CRASH_LOG
+int log_recoverCrashLog( void )
+{
+    int count = 0;
+    if( ( LOG_CRASH_LOG_MAGIC == crashLog.magic ) && ( crashLogHeaderCrc() == crashLog.crc ) )
+    {
+        uint32_t end = crashLog.writePosition;
+        uint32_t position = ( end > LOG_CRASH_LOG_LENGTH ) ? ( end - LOG_CRASH_LOG_LENGTH ) : 0U;
+        logConfig.crashLogReplay = true;
+        for( ; position != end; position++ )
         {
-            tCallback* cb = &logConfig.callbacks[i];
-            if( (NULL != cb->cbFn ) && ( level >= cb->cbLogLevel ) )
+            const tCrashRecord* record = &crashLog.records[position & ( LOG_CRASH_LOG_LENGTH - 1U )];
+            bool valid = ( ( position + 1U ) == record->sequence ) && ( record->length <= LOG_CRASH_ARGS_SIZE ) && ( record->level <= LOG_FATAL );
+#if LOG_CRASH_RECORD_CRC
+            valid = valid && ( crashRecordCrc( record ) == record->crc );
+#endif
+            if( valid )
             {
-                va_start( ev.ap, fmt );
-                cb->cbFn( &ev, cb->cbData );
-                va_end( ev.ap );
+                char text[LOG_DEFERRED_RENDER_SIZE];
+                (void)renderArgs( text, sizeof( text ), record->fmt, record->args, record->length );
+                tLog_event ev = {
+                    .time  = record->time,
+                    .level = record->level,
+                    .file  = record->file,
+                    .line  = record->line,
+#if LOG_USE_MODULES
+                    .module = ( ( record->module >= 0 ) && ( record->module < (int)LOG_MAX_MODULES ) ) ? record->module : 0,
+#endif
+                };
+                (void)replayEvent( &ev, "%s", text );
+                count++;
             }
         }
+        logConfig.crashLogReplay = false;
+    }
+    log_discardCrashLog();
+    return count;
+}
+
+void log_discardCrashLog( void )
+{
+    resetCrashLog();
+    atomicStore( &logConfig.crashLogState, CRASH_LOG_READY );
+}
+#endif
+
+#if LOG_USE_BINARY_SINK
+void log_binarySinkInit( tLog_binarySink* sink, tLog_binaryWriteFn writeFn, void* writeData )
+{
+    *sink = (tLog_binarySink) { writeFn, writeData, 0U, false };
+}
+
+void log_binaryCallback( tLog_event* ev, void* cbData )
+{
+    tLog_binarySink* sink = cbData;
+    uint8_t record[2U + LOG_BINARY_RECORD_SIZE];  /* length prefix, followed by the record body */
+    uint8_t* body = &record[2U];
+
+    if( !sink->synced )
+    {
+        size_t length = 0U;
+        body[length++] = BINARY_RECORD_SYNC;
+        body[length++] = BINARY_FORMAT_VERSION;
+        length = encodeVarint( body, LOG_BINARY_RECORD_SIZE, length, ev->time );
+        length = encodeVarint( body, LOG_BINARY_RECORD_SIZE, length, sizeof( tLog_timestamp ) * 8U );  /* timestamp width in bits */
+        writeBinaryRecord( sink, record, length );
+        sink->time = ev->time;
+        sink->synced = true;
+    }
+
+    /* the record header fits, because LOG_BINARY_RECORD_SIZE is at least 32 bytes */
+    uint8_t recordType = BINARY_RECORD_MESSAGE;
+    size_t length = 1U;
+    length = encodeVarint( body, LOG_BINARY_RECORD_SIZE, length, (tLog_timestamp)( ev->time - sink->time ) );
+#if LOG_USE_STRING_TABLE
+    uint16_t siteId = ( NULL != ev->site ) ? log_siteId( ev->site ) : LOG_SITE_ID_INVALID;
+    if( siteId != LOG_SITE_ID_INVALID )
+    {
+        /* the call site ID replaces the filename, line number and format string */
+        recordType = BINARY_RECORD_SITE;
+        length = encodeVarint( body, LOG_BINARY_RECORD_SIZE, length, siteId );
+    }
+    else
+#endif
+    {
+        uintptr_t anchor = (uintptr_t)log_binaryAnchor;
+        length = encodeSigned( body, LOG_BINARY_RECORD_SIZE, length, (intptr_t)( (uintptr_t)ev->file - anchor ) );
+        length = encodeVarint( body, LOG_BINARY_RECORD_SIZE, length, (uint32_t)ev->line );
+        length = encodeSigned( body, LOG_BINARY_RECORD_SIZE, length, (intptr_t)( (uintptr_t)ev->fmt - anchor ) );
+    }
+    bool truncated = false;
+#if LOG_USE_FIELDS
+    renderFields( ev );  /* the text of a structured log message is encoded as its printf argument */
+#endif
+    length = encodeArgs( body, LOG_BINARY_RECORD_SIZE, length, ev->fmt, ev->ap, &truncated );
+    body[0U] = (uint8_t)( recordType | (uint8_t)ev->level | ( truncated ? BINARY_RECORD_TRUNCATED : 0U ) );
+    writeBinaryRecord( sink, record, length );
+    sink->time = ev->time;
+}
 #endif
 
-        unlock();
+#if LOG_USE_MINIMAL_PRINTF
+int log_vsnprintf( char* buffer, size_t size, const char* fmt, va_list ap )
+{
+    tFormatOutput out = { buffer, size, 0U };
+    va_list args;
+    va_copy( args, ap );
+    while( '\0' != *fmt )
+    {
+        const char* literal = fmt;
+        while( ( '\0' != *fmt ) && ( '%' != *fmt ) )
+        {
+            fmt++;
+        }
+        outputChars( &out, literal, (size_t)( fmt - literal ) );
+        if( '%' == *fmt )
+        {
+            tConversion conv;
+            const char* spec = fmt;
+            fmt = parseConversion( fmt + 1, &conv );
+            formatConversion( &out, &conv, spec, (size_t)( fmt - spec ), &args );
+        }
+    }
+    va_end( args );
+    if( size > 0U )
+    {
+        buffer[( out.length < size ) ? out.length : ( size - 1U )] = '\0';
     }
+    return (int)out.length;
+}
+#endif
+
+int log_log( int level, const char* file, int line, const char* fmt, ... )
+{
+    tLog_event ev = {
+        .level = level,
+        .file  = file,
+        .line  = line,
+        .fmt   = fmt
+    };
+    va_list ap;
+    va_start( ap, fmt );
+    int result = logEvent( &ev, ap );
+    va_end( ap );
+    return result;
+}
+
+int log_logContext( tLog_context* context, int level, const char* file, int line, const char* fmt, ... )
+{
+    tLog_event ev = {
+        .level   = level,
+        .file    = file,
+        .line    = line,
+        .fmt     = fmt,
+        .context = ( &defaultContext != context ) ? context : NULL
+    };
+    va_list ap;
+    va_start( ap, fmt );
+    int result = logEvent( &ev, ap );
+    va_end( ap );
+    return result;
+}
+
+#if LOG_USE_MODULES
+int log_logModule( int module, int level, const char* file, int line, const char* fmt, ... )
+{
+    tLog_event ev = {
+        .level  = level,
+        .file   = file,
+        .line   = line,
+        .fmt    = fmt,
+        .module = ( ( module >= 0 ) && ( module < (int)LOG_MAX_MODULES ) ) ? module : 0
+    };
+    va_list ap;
+    va_start( ap, fmt );
+    int result = logEvent( &ev, ap );
+    va_end( ap );
+    return result;
+}
+#endif
+
+#if LOG_USE_FIELDS
+int log_logFields( int level, const char* file, int line, const char* msg, const tLog_field* fields, size_t fieldCount )
+{
+    char text[LOG_FIELDS_TEXT_SIZE];
+    text[0] = '\0';
+    tLog_event ev = {
+        .level      = level,
+        .file       = file,
+        .line       = line,
+        .fields     = fields,
+        .fieldCount = fieldCount,
+        .fieldsMsg  = msg,
+        .fieldsText = text
+    };
+    return logText( &ev, "%s", text );  /* the text is formatted by renderFields() when it is first read */
+}
+
+#if LOG_USE_MODULES
+int log_logModuleFields( int module, int level, const char* file, int line, const char* msg, const tLog_field* fields, size_t fieldCount )
+{
+    char text[LOG_FIELDS_TEXT_SIZE];
+    text[0] = '\0';
+    tLog_event ev = {
+        .level      = level,
+        .file       = file,
+        .line       = line,
+        .module     = ( ( module >= 0 ) && ( module < (int)LOG_MAX_MODULES ) ) ? module : 0,
+        .fields     = fields,
+        .fieldCount = fieldCount,
+        .fieldsMsg  = msg,
+        .fieldsText = text
+    };
+    return logText( &ev, "%s", text );  /* the text is formatted by renderFields() when it is first read */
+}
+#endif
+#endif
+
+#if LOG_DEFERRED_FORMAT
+int log_logPacked( int level, const char* file, int line, const char* fmt, const uint8_t* args, size_t argsLength )
+{
+    tLog_event ev = {
+        .level = level,
+        .file  = file,
+        .line  = line,
+        .fmt   = fmt
+    };
+    return logPacked( &ev, args, argsLength );
+}
+
+#if LOG_USE_MODULES
+int log_logModulePacked( int module, int level, const char* file, int line, const char* fmt, const uint8_t* args, size_t argsLength )
+{
+    tLog_event ev = {
+        .level  = level,
+        .file   = file,
+        .line   = line,
+        .fmt    = fmt,
+        .module = ( ( module >= 0 ) && ( module < (int)LOG_MAX_MODULES ) ) ? module : 0
+    };
+    return logPacked( &ev, args, argsLength );
+}
+#endif
+#endif
+
+#if LOG_USE_STRING_TABLE
+int log_logSite( const tLog_site* site, const char* fmt, ... )
+{
+    tLog_event ev = {
+        .level = site->level,
+        .file  = site->file,
+        .line  = site->line,
+        .fmt   = fmt,
+#if LOG_USE_MODULES
+        .module = ( ( site->module >= 0 ) && ( site->module < (int)LOG_MAX_MODULES ) ) ? site->module : 0,
+#endif
+        .site  = site
+    };
+    va_list ap;
+    va_start( ap, fmt );
+    int result = logEvent( &ev, ap );
+    va_end( ap );
+    return result;
+}
+
+int log_logContextSite( tLog_context* context, const tLog_site* site, const char* fmt, ... )
+{
+    tLog_event ev = {
+        .level   = site->level,
+        .file    = site->file,
+        .line    = site->line,
+        .fmt     = fmt,
+        .context = ( &defaultContext != context ) ? context : NULL,
+        .site    = site
+    };
+    va_list ap;
+    va_start( ap, fmt );
+    int result = logEvent( &ev, ap );
+    va_end( ap );
     return result;
 }
+
+uint16_t log_siteId( const tLog_site* site )
+{
+    uintptr_t address = (uintptr_t)site;
+    bool inTable = ( address >= (uintptr_t)__start_log_ec_sites ) && ( address < (uintptr_t)__stop_log_ec_sites );
+    size_t index = inTable ? (size_t)( site - __start_log_ec_sites ) : LOG_SITE_ID_INVALID;
+    return ( index < LOG_SITE_ID_INVALID ) ? (uint16_t)index : LOG_SITE_ID_INVALID;  /* the ID of the 65536th entry would be ambiguous */
+}
+
+const tLog_site* log_getSite( uint16_t id )
+{
+    size_t count = (size_t)( __stop_log_ec_sites - __start_log_ec_sites );
+    return ( ( id < count ) && ( id != LOG_SITE_ID_INVALID ) ) ? &__start_log_ec_sites[id] : NULL;
+}
+#endif
@@ -42,21 +42,430 @@ extern "C" {
 /* To override the standard library functions printf() and vprintf() with 
  * user-defined functions, define the macro OVERRIDE_PRINTF and define the
  * macros CONSOLE_PRINTF() and CONSOLE_VPRINTF() in the header file
- * console_printf.h.
+ * console_printf.h. Optionally, also define the macro CONSOLE_WRITE( BUF, LEN )
+ * to write each complete log message to the console with a single call.
  */
 #include "console_printf.h"
 #endif
 
 /* Public macro definitions -------------------------------------------------*/
 
-#define FILE_NAME ( strrchr( __FILE__, '/' ) ? strrchr( __FILE__, '/' ) + 1 : __FILE__ )
+#if defined( LOG_FILE_NAME )
+#define FILE_NAME LOG_FILE_NAME  /* Source file basename, defined per source file by the build system */
+#elif defined( __FILE_NAME__ )
+#define FILE_NAME __FILE_NAME__  /* Source file basename, defined by the compiler (GCC 12+, Clang 9+) */
+#else
+#define FILE_NAME ( strrchr( __FILE__, '/' ) ? strrchr( __FILE__, '/' ) + 1 : __FILE__ )  /* Fallback: find basename at runtime */
+#endif
+
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 0  /* Default: log messages at all levels are compiled (0 = LOG_TRACE ... 5 = LOG_FATAL, 6 = none) */
+#endif
+
+/** Macro that discards a log message below LOG_COMPILE_LEVEL: the arguments are type checked, but not evaluated */
+#define LOG_DISCARD( ... ) ( 0 ? log_discard( __VA_ARGS__ ) : 0 )
+
+#ifndef LOG_MAX_MODULES
+#define LOG_MAX_MODULES 0U  /* Default: per-module logging levels are disabled */
+#endif
+
+/** Macro that evaluates 'true' if log messages have per-module logging levels */
+#define LOG_USE_MODULES ( LOG_MAX_MODULES > 0U )
+
+#ifndef LOG_MODULE
+#define LOG_MODULE 0  /* Default: module index of the log messages of this translation unit */
+#endif
+
+#if LOG_USE_MODULES
+/** Macro that evaluates 'true' if a log message at LEVEL would be written to the console or passed to a callback */
+#define LOG_IS_ENABLED( LEVEL ) ( ( LEVEL ) >= log_effectiveModuleLevel[LOG_MODULE] )
+#else
+/** Macro that evaluates 'true' if a log message at LEVEL would be written to the console or passed to a callback */
+#define LOG_IS_ENABLED( LEVEL ) ( ( LEVEL ) >= log_effectiveLevel )
+#endif
+
+#ifndef LOG_USE_STATS
+#define LOG_USE_STATS 0  /* Default: only dropped log messages are counted in the logging statistics */
+#endif
+
+#if LOG_USE_STATS
+/** Macro that counts a log message at LEVEL that the logging macros suppress without calling the logging function, and evaluates to 0 */
+#define LOG_COUNT_SUPPRESSED( CONTEXT, LEVEL ) log_countSuppressed( CONTEXT, LEVEL )
+#else
+/** Macro that evaluates to 0 for a log message that the logging macros suppress, which is not counted */
+#define LOG_COUNT_SUPPRESSED( CONTEXT, LEVEL ) 0
+#endif
+
+#ifndef LOG_USE_STRING_TABLE
+#define LOG_USE_STRING_TABLE 0  /* Default: log messages are not recorded in the call site table */
+#endif
+
+#if LOG_USE_STRING_TABLE
+#if !defined( __GNUC__ )
+#error "LOG_USE_STRING_TABLE requires GCC/Clang section attributes and statement expressions"
+#endif
+
+#if defined( LOG_FILE_NAME ) || defined( __FILE_NAME__ )
+#define LOG_SITE_FILE_NAME FILE_NAME  /* Source file basename, which is a string literal */
+#else
+#define LOG_SITE_FILE_NAME __FILE__  /* The call site table requires a constant: the full source file path */
+#endif
+
+/** Macro that evaluates to the format string, which is the first of the arguments of a logging macro */
+#define LOG_FORMAT_STRING( FMT, ... ) FMT
+
+/** Section attributes of a call site table entry: pointer aligned, so that the entries form an array */
+#define LOG_SITE_ATTRIBUTES __attribute__(( section( "log_ec_sites" ), used, aligned( sizeof( void* ) ) ))
+
+/** Macro that records the log message in the call site table, and calls log_logSite() only if the log message would be written to the console or passed to a callback */
+#define LOG_LOG( LEVEL, ... ) __extension__ ({ \
+    static const tLog_site LOG_SITE_ATTRIBUTES log_site = { LOG_SITE_FILE_NAME, LOG_FORMAT_STRING( __VA_ARGS__, 0 ), __LINE__, LEVEL, LOG_MODULE }; \
+    LOG_IS_ENABLED( LEVEL ) ? log_logSite( &log_site, __VA_ARGS__ ) : LOG_COUNT_SUPPRESSED( NULL, LEVEL ); })
+#elif LOG_USE_MODULES
+/** Macro that calls log_logModule() only if the log message would be written to the console or passed to a callback */
+#define LOG_LOG( LEVEL, ... ) ( LOG_IS_ENABLED( LEVEL ) ? log_logModule( LOG_MODULE, LEVEL, FILE_NAME, __LINE__, __VA_ARGS__ ) : LOG_COUNT_SUPPRESSED( NULL, LEVEL ) )
+#else
+/** Macro that calls log_log() only if the log message would be written to the console or passed to a callback */
+#define LOG_LOG( LEVEL, ... ) ( LOG_IS_ENABLED( LEVEL ) ? log_log( LEVEL, FILE_NAME, __LINE__, __VA_ARGS__ ) : LOG_COUNT_SUPPRESSED( NULL, LEVEL ) )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 0
+#define log_trace( ... ) LOG_LOG( LOG_TRACE, __VA_ARGS__ )
+#else
+#define log_trace( ... ) LOG_DISCARD( __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 1
+#define log_debug( ... ) LOG_LOG( LOG_DEBUG, __VA_ARGS__ )
+#else
+#define log_debug( ... ) LOG_DISCARD( __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 2
+#define log_info( ... )  LOG_LOG( LOG_INFO,  __VA_ARGS__ )
+#else
+#define log_info( ... )  LOG_DISCARD( __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 3
+#define log_warn( ... )  LOG_LOG( LOG_WARN,  __VA_ARGS__ )
+#else
+#define log_warn( ... )  LOG_DISCARD( __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 4
+#define log_error( ... ) LOG_LOG( LOG_ERROR, __VA_ARGS__ )
+#else
+#define log_error( ... ) LOG_DISCARD( __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 5
+#define log_fatal( ... ) LOG_LOG( LOG_FATAL, __VA_ARGS__ )
+#else
+#define log_fatal( ... ) LOG_DISCARD( __VA_ARGS__ )
+#endif
+
+#ifndef LOG_MAX_CONTEXTS
+#define LOG_MAX_CONTEXTS 0U  /* Default: only the default logger context, and log_createContext() is not defined */
+#endif
+
+#if LOG_USE_STRING_TABLE
+/** Macro that records the log message in the call site table, and calls log_logContextSite() only if the log message would be written to the console or passed to a callback by the logger context, which is evaluated once */
+#define LOG_LOG_CONTEXT( CONTEXT, LEVEL, ... ) __extension__ ({ \
+    static const tLog_site LOG_SITE_ATTRIBUTES log_site = { LOG_SITE_FILE_NAME, LOG_FORMAT_STRING( __VA_ARGS__, 0 ), __LINE__, LEVEL, LOG_MODULE }; \
+    tLog_context* log_macroContext = ( CONTEXT ); \
+    log_isContextEnabled( log_macroContext, LEVEL ) ? log_logContextSite( log_macroContext, &log_site, __VA_ARGS__ ) : LOG_COUNT_SUPPRESSED( log_macroContext, LEVEL ); })
+#elif defined( __GNUC__ )
+/** Macro that calls log_logContext() only if the log message would be written to the console or passed to a callback by the logger context, which is evaluated once */
+#define LOG_LOG_CONTEXT( CONTEXT, LEVEL, ... ) __extension__ ({ \
+    tLog_context* log_macroContext = ( CONTEXT ); \
+    log_isContextEnabled( log_macroContext, LEVEL ) ? log_logContext( log_macroContext, LEVEL, FILE_NAME, __LINE__, __VA_ARGS__ ) : LOG_COUNT_SUPPRESSED( log_macroContext, LEVEL ); })
+#else
+/** Macro that calls log_logContext() only if the log message would be written to the console or passed to a callback by the logger context, which is evaluated twice, so it shall not have side effects */
+#define LOG_LOG_CONTEXT( CONTEXT, LEVEL, ... ) ( log_isContextEnabled( CONTEXT, LEVEL ) ? log_logContext( CONTEXT, LEVEL, FILE_NAME, __LINE__, __VA_ARGS__ ) : LOG_COUNT_SUPPRESSED( CONTEXT, LEVEL ) )
+#endif
+
+/** Macro that discards a log message of a logger context below LOG_COMPILE_LEVEL: the context and the arguments are type checked, but not evaluated */
+#define LOG_DISCARD_CONTEXT( CONTEXT, ... ) ( 0 ? ( (void)log_isContextEnabled( CONTEXT, LOG_TRACE ), log_discard( __VA_ARGS__ ) ) : 0 )
+
+#if LOG_COMPILE_LEVEL <= 0
+#define log_trace_ctx( CONTEXT, ... ) LOG_LOG_CONTEXT( CONTEXT, LOG_TRACE, __VA_ARGS__ )
+#else
+#define log_trace_ctx( CONTEXT, ... ) LOG_DISCARD_CONTEXT( CONTEXT, __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 1
+#define log_debug_ctx( CONTEXT, ... ) LOG_LOG_CONTEXT( CONTEXT, LOG_DEBUG, __VA_ARGS__ )
+#else
+#define log_debug_ctx( CONTEXT, ... ) LOG_DISCARD_CONTEXT( CONTEXT, __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 2
+#define log_info_ctx( CONTEXT, ... )  LOG_LOG_CONTEXT( CONTEXT, LOG_INFO,  __VA_ARGS__ )
+#else
+#define log_info_ctx( CONTEXT, ... )  LOG_DISCARD_CONTEXT( CONTEXT, __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 3
+#define log_warn_ctx( CONTEXT, ... )  LOG_LOG_CONTEXT( CONTEXT, LOG_WARN,  __VA_ARGS__ )
+#else
+#define log_warn_ctx( CONTEXT, ... )  LOG_DISCARD_CONTEXT( CONTEXT, __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 4
+#define log_error_ctx( CONTEXT, ... ) LOG_LOG_CONTEXT( CONTEXT, LOG_ERROR, __VA_ARGS__ )
+#else
+#define log_error_ctx( CONTEXT, ... ) LOG_DISCARD_CONTEXT( CONTEXT, __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 5
+#define log_fatal_ctx( CONTEXT, ... ) LOG_LOG_CONTEXT( CONTEXT, LOG_FATAL, __VA_ARGS__ )
+#else
+#define log_fatal_ctx( CONTEXT, ... ) LOG_DISCARD_CONTEXT( CONTEXT, __VA_ARGS__ )
+#endif
+
+#ifndef LOG_USE_RATELIMIT
+#define LOG_USE_RATELIMIT 0  /* Default: the rate limited logging macros are not defined */
+#endif
+
+#ifndef LOG_RATELIMIT_BURST
+#define LOG_RATELIMIT_BURST 10U  /* Default: maximum number of log messages written by a rate limited call site per interval */
+#endif
+
+#ifndef LOG_RATELIMIT_INTERVAL
+#define LOG_RATELIMIT_INTERVAL 1000U  /* Default: rate limit interval, in timestamp ticks (1 s with millisecond ticks) */
+#endif
+
+#if LOG_USE_RATELIMIT
+/** Format string of the log message that reports the number of log messages suppressed by a rate limited call site */
+#define LOG_RATELIMIT_SUPPRESSED_FORMAT "%lu log messages suppressed"
+
+/** Macro that writes a log message only if its call site has not exceeded LOG_RATELIMIT_BURST log messages in the current LOG_RATELIMIT_INTERVAL, after the number of suppressed log messages */
+#define LOG_LOG_RATELIMITED( LEVEL, ... ) do { \
+    static tLog_ratelimit log_ratelimitState; \
+    uint32_t log_suppressed = 0U; \
+    if( !LOG_IS_ENABLED( LEVEL ) ) \
+    { \
+        (void)LOG_COUNT_SUPPRESSED( NULL, LEVEL ); \
+    } \
+    else if( log_ratelimit( &log_ratelimitState, LOG_RATELIMIT_BURST, LOG_RATELIMIT_INTERVAL, &log_suppressed ) ) \
+    { \
+        if( log_suppressed > 0U ) \
+        { \
+            (void)LOG_LOG( LEVEL, LOG_RATELIMIT_SUPPRESSED_FORMAT, (unsigned long)log_suppressed ); \
+        } \
+        (void)LOG_LOG( LEVEL, __VA_ARGS__ ); \
+    } } while( 0 )
+
+#if LOG_COMPILE_LEVEL <= 0
+#define log_trace_ratelimited( ... ) LOG_LOG_RATELIMITED( LOG_TRACE, __VA_ARGS__ )
+#else
+#define log_trace_ratelimited( ... ) (void)LOG_DISCARD( __VA_ARGS__ )
+#endif
 
-#define log_trace( ... ) log_log( LOG_TRACE, FILE_NAME, __LINE__, __VA_ARGS__ )
-#define log_debug( ... ) log_log( LOG_DEBUG, FILE_NAME, __LINE__, __VA_ARGS__ )
-#define log_info( ... )  log_log( LOG_INFO,  FILE_NAME, __LINE__, __VA_ARGS__ )
-#define log_warn( ... )  log_log( LOG_WARN,  FILE_NAME, __LINE__, __VA_ARGS__ )
-#define log_error( ... ) log_log( LOG_ERROR, FILE_NAME, __LINE__, __VA_ARGS__ )
-#define log_fatal( ... ) log_log( LOG_FATAL, FILE_NAME, __LINE__, __VA_ARGS__ )
+#if LOG_COMPILE_LEVEL <= 1
+#define log_debug_ratelimited( ... ) LOG_LOG_RATELIMITED( LOG_DEBUG, __VA_ARGS__ )
+#else
+#define log_debug_ratelimited( ... ) (void)LOG_DISCARD( __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 2
+#define log_info_ratelimited( ... )  LOG_LOG_RATELIMITED( LOG_INFO,  __VA_ARGS__ )
+#else
+#define log_info_ratelimited( ... )  (void)LOG_DISCARD( __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 3
+#define log_warn_ratelimited( ... )  LOG_LOG_RATELIMITED( LOG_WARN,  __VA_ARGS__ )
+#else
+#define log_warn_ratelimited( ... )  (void)LOG_DISCARD( __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 4
+#define log_error_ratelimited( ... ) LOG_LOG_RATELIMITED( LOG_ERROR, __VA_ARGS__ )
+#else
+#define log_error_ratelimited( ... ) (void)LOG_DISCARD( __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 5
+#define log_fatal_ratelimited( ... ) LOG_LOG_RATELIMITED( LOG_FATAL, __VA_ARGS__ )
+#else
+#define log_fatal_ratelimited( ... ) (void)LOG_DISCARD( __VA_ARGS__ )
+#endif
+#endif
+
+#ifndef LOG_USE_SAMPLING
+#define LOG_USE_SAMPLING 0  /* Default: the sampled logging macros are not defined */
+#endif
+
+#if LOG_USE_SAMPLING
+/** Macro that writes every RATE-th occurrence of a log message at its call site, which are counted only while the log message would be written */
+#define LOG_LOG_SAMPLED( LEVEL, RATE, ... ) do { \
+    static uint32_t log_sampleCount; \
+    if( !LOG_IS_ENABLED( LEVEL ) ) \
+    { \
+        (void)LOG_COUNT_SUPPRESSED( NULL, LEVEL ); \
+    } \
+    else if( ++log_sampleCount >= ( RATE ) ) \
+    { \
+        log_sampleCount = 0U; \
+        (void)LOG_LOG( LEVEL, __VA_ARGS__ ); \
+    } } while( 0 )
+
+#if LOG_COMPILE_LEVEL <= 0
+#define log_trace_sampled( ... ) LOG_LOG_SAMPLED( LOG_TRACE, log_sampleRate[LOG_TRACE], __VA_ARGS__ )
+#else
+#define log_trace_sampled( ... ) (void)LOG_DISCARD( __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 1
+#define log_debug_sampled( ... ) LOG_LOG_SAMPLED( LOG_DEBUG, log_sampleRate[LOG_DEBUG], __VA_ARGS__ )
+#else
+#define log_debug_sampled( ... ) (void)LOG_DISCARD( __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 2
+#define log_info_sampled( ... )  LOG_LOG_SAMPLED( LOG_INFO,  log_sampleRate[LOG_INFO],  __VA_ARGS__ )
+#else
+#define log_info_sampled( ... )  (void)LOG_DISCARD( __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 3
+#define log_warn_sampled( ... )  LOG_LOG_SAMPLED( LOG_WARN,  log_sampleRate[LOG_WARN],  __VA_ARGS__ )
+#else
+#define log_warn_sampled( ... )  (void)LOG_DISCARD( __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 4
+#define log_error_sampled( ... ) LOG_LOG_SAMPLED( LOG_ERROR, log_sampleRate[LOG_ERROR], __VA_ARGS__ )
+#else
+#define log_error_sampled( ... ) (void)LOG_DISCARD( __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 5
+#define log_fatal_sampled( ... ) LOG_LOG_SAMPLED( LOG_FATAL, log_sampleRate[LOG_FATAL], __VA_ARGS__ )
+#else
+#define log_fatal_sampled( ... ) (void)LOG_DISCARD( __VA_ARGS__ )
+#endif
+#endif
+
+#ifndef LOG_USE_FIELDS
+#define LOG_USE_FIELDS 0  /* Default: the structured key/value logging macros are not defined */
+#endif
+
+#ifndef LOG_FIELDS_TEXT_SIZE
+#define LOG_FIELDS_TEXT_SIZE 128U  /* Default: maximum size of the text of a structured log message, including the null terminator */
+#endif
+
+#if LOG_USE_FIELDS
+/* Typed key/value field initialisers, which are the arguments of the structured logging macros that follow the message */
+#define LOG_I32( KEY, VALUE )  { .key = ( KEY ), .type = LOG_FIELD_I32,  .value.i32 = ( VALUE ) }
+#define LOG_U32( KEY, VALUE )  { .key = ( KEY ), .type = LOG_FIELD_U32,  .value.u32 = ( VALUE ) }
+#define LOG_I64( KEY, VALUE )  { .key = ( KEY ), .type = LOG_FIELD_I64,  .value.i64 = ( VALUE ) }
+#define LOG_U64( KEY, VALUE )  { .key = ( KEY ), .type = LOG_FIELD_U64,  .value.u64 = ( VALUE ) }
+#define LOG_F32( KEY, VALUE )  { .key = ( KEY ), .type = LOG_FIELD_F32,  .value.f32 = ( VALUE ) }
+#define LOG_F64( KEY, VALUE )  { .key = ( KEY ), .type = LOG_FIELD_F64,  .value.f64 = ( VALUE ) }
+#define LOG_BOOL( KEY, VALUE ) { .key = ( KEY ), .type = LOG_FIELD_BOOL, .value.b   = ( VALUE ) }
+#define LOG_STR( KEY, VALUE )  { .key = ( KEY ), .type = LOG_FIELD_STR,  .value.str = ( VALUE ) }
+
+/** Macro that evaluates to the number of fields of a structured log message, without evaluating them */
+#define LOG_FIELD_COUNT( ... ) ( sizeof( (const tLog_field[]){ __VA_ARGS__ } ) / sizeof( tLog_field ) )
+
+#if LOG_USE_MODULES
+/** Macro that calls log_logModuleFields() only if the structured log message would be written to the console or passed to a callback */
+#define LOG_LOG_KV( LEVEL, MSG, ... ) ( LOG_IS_ENABLED( LEVEL ) ? \
+    log_logModuleFields( LOG_MODULE, LEVEL, FILE_NAME, __LINE__, MSG, (const tLog_field[]){ __VA_ARGS__ }, LOG_FIELD_COUNT( __VA_ARGS__ ) ) : LOG_COUNT_SUPPRESSED( NULL, LEVEL ) )
+#else
+/** Macro that calls log_logFields() only if the structured log message would be written to the console or passed to a callback */
+#define LOG_LOG_KV( LEVEL, MSG, ... ) ( LOG_IS_ENABLED( LEVEL ) ? \
+    log_logFields( LEVEL, FILE_NAME, __LINE__, MSG, (const tLog_field[]){ __VA_ARGS__ }, LOG_FIELD_COUNT( __VA_ARGS__ ) ) : LOG_COUNT_SUPPRESSED( NULL, LEVEL ) )
+#endif
+
+/** Macro that discards a structured log message that is below LOG_COMPILE_LEVEL: the fields are type checked, but not evaluated */
+#define LOG_DISCARD_KV( MSG, ... ) ( 0 ? log_discardFields( MSG, LOG_FIELD_COUNT( __VA_ARGS__ ) ) : 0 )
+
+#if LOG_COMPILE_LEVEL <= 0
+#define log_trace_kv( ... ) LOG_LOG_KV( LOG_TRACE, __VA_ARGS__ )
+#else
+#define log_trace_kv( ... ) LOG_DISCARD_KV( __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 1
+#define log_debug_kv( ... ) LOG_LOG_KV( LOG_DEBUG, __VA_ARGS__ )
+#else
+#define log_debug_kv( ... ) LOG_DISCARD_KV( __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 2
+#define log_info_kv( ... )  LOG_LOG_KV( LOG_INFO,  __VA_ARGS__ )
+#else
+#define log_info_kv( ... )  LOG_DISCARD_KV( __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 3
+#define log_warn_kv( ... )  LOG_LOG_KV( LOG_WARN,  __VA_ARGS__ )
+#else
+#define log_warn_kv( ... )  LOG_DISCARD_KV( __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 4
+#define log_error_kv( ... ) LOG_LOG_KV( LOG_ERROR, __VA_ARGS__ )
+#else
+#define log_error_kv( ... ) LOG_DISCARD_KV( __VA_ARGS__ )
+#endif
+
+#if LOG_COMPILE_LEVEL <= 5
+#define log_fatal_kv( ... ) LOG_LOG_KV( LOG_FATAL, __VA_ARGS__ )
+#else
+#define log_fatal_kv( ... ) LOG_DISCARD_KV( __VA_ARGS__ )
+#endif
+#endif
+
+#ifndef LOG_USE_SPANS
+#define LOG_USE_SPANS 0  /* Default: the timing span macros LOG_SPAN_BEGIN() etc. write nothing */
+#endif
+
+#ifndef LOG_SPAN_LEVEL
+#define LOG_SPAN_LEVEL 0  /* Default: logging level of span records (0 = LOG_TRACE ... 5 = LOG_FATAL) */
+#endif
+
+#define LOG_SPAN_BEGIN_FORMAT "span B %s\n"  /* Format string of a span begin record, which is parsed by tools/log_ec_trace.py */
+#define LOG_SPAN_END_FORMAT "span E\n"       /* Format string of a span end record, which ends the most recent span that has begun */
+
+#if LOG_USE_SPANS && ( LOG_COMPILE_LEVEL <= LOG_SPAN_LEVEL )
+/** Macro that writes a span begin record, with the timestamp, filename and line number of a log message */
+#define LOG_SPAN_BEGIN( NAME ) ( (void)LOG_LOG( LOG_SPAN_LEVEL, LOG_SPAN_BEGIN_FORMAT, NAME ) )
+
+/** Macro that writes a span end record, which ends the most recent span that has begun */
+#define LOG_SPAN_END() ( (void)LOG_LOG( LOG_SPAN_LEVEL, LOG_SPAN_END_FORMAT ) )
+
+#if defined( __GNUC__ )
+/** Macros that evaluate to a variable name that is unique to the line number, so that a block may hold several scoped spans */
+#define LOG_SPAN_PASTE( PREFIX, LINE ) PREFIX ## LINE
+#define LOG_SPAN_NAME( PREFIX, LINE ) LOG_SPAN_PASTE( PREFIX, LINE )
+
+#if LOG_USE_STRING_TABLE
+/** Macro that begins a span which ends when the enclosing scope is left, by any path, and records its end record in the call site table */
+#define LOG_SPAN_SCOPE( NAME ) \
+    static const tLog_site LOG_SITE_ATTRIBUTES LOG_SPAN_NAME( log_spanEndSite, __LINE__ ) = \
+        { LOG_SITE_FILE_NAME, LOG_SPAN_END_FORMAT, __LINE__, LOG_SPAN_LEVEL, LOG_MODULE }; \
+    __attribute__(( cleanup( log_spanScopeEnd ), unused )) const tLog_spanScope LOG_SPAN_NAME( log_spanScope, __LINE__ ) = \
+    { ( LOG_SPAN_BEGIN( NAME ), &LOG_SPAN_NAME( log_spanEndSite, __LINE__ ) ) }
+#else
+/** Macro that begins a span which ends when the enclosing scope is left, by any path */
+#define LOG_SPAN_SCOPE( NAME ) \
+    __attribute__(( cleanup( log_spanScopeEnd ), unused )) const tLog_spanScope LOG_SPAN_NAME( log_spanScope, __LINE__ ) = \
+    { ( LOG_SPAN_BEGIN( NAME ), FILE_NAME ), __LINE__ }
+#endif
+#else
+/** Macro that is a compilation error that names the limitation, because a scoped span requires the GCC/Clang cleanup attribute */
+#define LOG_SPAN_SCOPE( NAME ) LOG_SPAN_SCOPE_requires_the_GCC_Clang_cleanup_attribute
+#endif
+#else
+#define LOG_SPAN_BEGIN( NAME ) ( (void)0 )
+#define LOG_SPAN_END() ( (void)0 )
+#define LOG_SPAN_SCOPE( NAME ) ( (void)0 )
+#endif
 
 #ifndef LOG_MAX_CALLBACKS
 #define LOG_MAX_CALLBACKS 0U  /* Default: logging callbacks are disabled */
@@ -65,6 +474,126 @@ extern "C" {
 /** Macro that evaluates 'true' if logging callbacks are enabled */
 #define LOG_USE_CALLBACKS ( LOG_MAX_CALLBACKS > 0U )
 
+#ifndef LOG_ASYNC_QUEUE_LENGTH
+#define LOG_ASYNC_QUEUE_LENGTH 0U  /* Default: asynchronous logging is disabled */
+#endif
+
+/** Macro that evaluates 'true' if asynchronous logging is enabled */
+#define LOG_USE_ASYNC ( LOG_ASYNC_QUEUE_LENGTH > 0U )
+
+#ifndef LOG_ASYNC_QUEUE_COUNT
+#define LOG_ASYNC_QUEUE_COUNT 1U  /* Default: a single asynchronous logging queue is shared by all cores, threads and ISRs */
+#endif
+
+#ifndef LOG_ASYNC_MESSAGE_SIZE
+#define LOG_ASYNC_MESSAGE_SIZE 64U  /* Default: maximum size of a queued log message body, including the null terminator */
+#endif
+
+#ifndef LOG_DEFERRED_FORMAT
+#define LOG_DEFERRED_FORMAT 0  /* Default: queued log messages are formatted by the caller of log_log() */
+#endif
+
+#ifndef LOG_DEFERRED_RENDER_SIZE
+#define LOG_DEFERRED_RENDER_SIZE 128U  /* Default: maximum size of a log message body formatted by log_drain(), including the null terminator */
+#endif
+
+#ifndef LOG_USE_CHUNK_OUTPUT
+#define LOG_USE_CHUNK_OUTPUT 0  /* Default: log_drain() writes queued log messages to the console */
+#endif
+
+#ifndef LOG_CHUNK_ALIGNMENT
+#define LOG_CHUNK_ALIGNMENT 4U  /* Default: alignment in bytes of the queued log messages handed to the chunk write function */
+#endif
+
+#ifndef LOG_MESSAGE_BUFFER_SIZE
+#define LOG_MESSAGE_BUFFER_SIZE 0U  /* Default: the log message body is formatted separately for the console and each callback */
+#endif
+
+/** Macro that evaluates 'true' if the log message body is formatted once, into a buffer */
+#define LOG_USE_MESSAGE_BUFFER ( LOG_MESSAGE_BUFFER_SIZE > 0U )
+
+#ifndef LOG_LAZY_FORMAT
+#define LOG_LAZY_FORMAT 0  /* Default: the message buffer is formatted before the log message is written, if it is written */
+#endif
+
+#ifndef LOG_USE_BATCH_SINK
+#define LOG_USE_BATCH_SINK 0  /* Default: the batching callback log_batchCallback() is not compiled */
+#endif
+
+#ifndef LOG_BATCH_MAX_EVENTS
+#define LOG_BATCH_MAX_EVENTS 16U  /* Default: maximum number of log messages in a batch */
+#endif
+
+#ifndef LOG_BATCH_BUFFER_SIZE
+#define LOG_BATCH_BUFFER_SIZE 512U  /* Default: size in bytes of the buffer that holds the log message bodies of a batch */
+#endif
+
+#ifndef LOG_USE_COALESCE
+#define LOG_USE_COALESCE 0  /* Default: identical consecutive log messages are all written */
+#endif
+
+#ifndef LOG_COALESCE_ARGS_SIZE
+#define LOG_COALESCE_ARGS_SIZE 32U  /* Default: maximum size of the packed printf arguments of a log message that can be coalesced */
+#endif
+
+#ifndef LOG_COALESCE_TIMEOUT
+#define LOG_COALESCE_TIMEOUT 1000U  /* Default: maximum time over which repeats of a log message are coalesced, in timestamp ticks (1 s with millisecond ticks) */
+#endif
+
+#ifndef LOG_USE_CRASH_LOG
+#define LOG_USE_CRASH_LOG 0  /* Default: log messages are not recorded in the crash-persistent RAM log */
+#endif
+
+#ifndef LOG_CRASH_LOG_LENGTH
+#define LOG_CRASH_LOG_LENGTH 16U  /* Default: number of log message records in the crash-persistent RAM log (a power of 2) */
+#endif
+
+#ifndef LOG_CRASH_ARGS_SIZE
+#define LOG_CRASH_ARGS_SIZE 24U  /* Default: maximum size of the packed printf arguments of a crash log record */
+#endif
+
+#ifndef LOG_CRASH_RECORD_CRC
+#define LOG_CRASH_RECORD_CRC 0  /* Default: a crash log record is validated by its sequence number, without a CRC-32 */
+#endif
+
+#ifndef LOG_USE_BINARY_SINK
+#define LOG_USE_BINARY_SINK 0  /* Default: the binary log record encoder is not compiled */
+#endif
+
+#ifndef LOG_BINARY_RECORD_SIZE
+#define LOG_BINARY_RECORD_SIZE 64U  /* Default: maximum size of an encoded binary log record, excluding its length prefix */
+#endif
+
+#ifndef LOG_STATS_BUCKETS
+#define LOG_STATS_BUCKETS 16U  /* Default: number of log2 buckets of each duration histogram in the logging statistics */
+#endif
+
+#ifndef LOG_USE_MMAP_SINK
+#define LOG_USE_MMAP_SINK 0  /* Default: the memory-mapped file sink log_mmapCallback() is not compiled */
+#endif
+
+#ifndef LOG_MMAP_PATH_SIZE
+#define LOG_MMAP_PATH_SIZE 256U  /* Default: maximum size of the path of a memory-mapped log file, including the null terminator */
+#endif
+
+#ifndef LOG_MMAP_RECORD_SIZE
+#define LOG_MMAP_RECORD_SIZE 256U  /* Default: maximum size of a log message written to a memory-mapped log file, including the newline */
+#endif
+
+#ifndef LOG_TIMESTAMP_64
+#define LOG_TIMESTAMP_64 0  /* Default: timestamps are 32-bit unsigned integers */
+#endif
+
+#ifndef LOG_USE_CYCLE_COUNTER
+#define LOG_USE_CYCLE_COUNTER 0  /* Default: timestamps are read by the timestamp function set by log_setTimestampFn() */
+#endif
+
+#if defined( __GNUC__ )
+#define LOG_PRINTF_FORMAT( FMT_INDEX, ARG_INDEX ) __attribute__(( format( printf, FMT_INDEX, ARG_INDEX ) ))  /* Compiler checks printf format arguments */
+#else
+#define LOG_PRINTF_FORMAT( FMT_INDEX, ARG_INDEX )
+#endif
+
 #ifndef CONSOLE_PRINTF
 #define CONSOLE_PRINTF( FMT, ... ) printf( FMT, __VA_ARGS__ )  /* Default: use printf() to write log message prefix to the console */
 #endif
@@ -73,16 +602,137 @@ extern "C" {
 #define CONSOLE_VPRINTF( FMT, ARG ) vprintf( FMT, ARG )  /* Default: use vprintf() to write log message body to the console */
 #endif
 
+#ifdef CONSOLE_WRITE
+#define LOG_USE_CONSOLE_WRITE 1  /* CONSOLE_WRITE( BUF, LEN ) writes the log message prefix and body to the console in a single call */
+#else
+#define LOG_USE_CONSOLE_WRITE 0  /* Default: use CONSOLE_PRINTF() and CONSOLE_VPRINTF() to write the log message prefix and body */
+#endif
+
+#ifndef LOG_CONSOLE_LINE_SIZE
+#define LOG_CONSOLE_LINE_SIZE 128U  /* Default: maximum size of a log message written by CONSOLE_WRITE(), including the null terminator */
+#endif
+
+#ifndef LOG_PREFIX_SIZE
+#define LOG_PREFIX_SIZE 64U  /* Default: size of the buffer of the timestamp, logging level and line number of a log message prefix written by CONSOLE_PRINTF() (at least 64) */
+#endif
+
+#ifndef LOG_USE_MINIMAL_PRINTF
+#define LOG_USE_MINIMAL_PRINTF 0  /* Default: log message bodies are formatted by the C standard library */
+#endif
+
+#ifndef LOG_MINIMAL_PRINTF_FLOAT
+#define LOG_MINIMAL_PRINTF_FLOAT 0  /* Default: the minimal printf formatter does not support the %f conversion */
+#endif
+
+#ifndef LOG_VSNPRINTF
+#if LOG_USE_MINIMAL_PRINTF
+#define LOG_VSNPRINTF( BUF, SIZE, FMT, ARG ) log_vsnprintf( BUF, SIZE, FMT, ARG )  /* use the built-in minimal printf formatter */
+#else
+#define LOG_VSNPRINTF( BUF, SIZE, FMT, ARG ) vsnprintf( BUF, SIZE, FMT, ARG )  /* Default: use vsnprintf() to format log message body into a buffer */
+#endif
+#endif
+
 /* Public type definitions --------------------------------------------------*/
 
+#if LOG_TIMESTAMP_64
+typedef uint64_t tLog_timestamp;  //!< Timestamp value
+#else
+typedef uint32_t tLog_timestamp;  //!< Timestamp value
+#endif
+
+#if LOG_USE_STRING_TABLE
+/** Call site table entry, which is placed in the "log_ec_sites" linker section by the logging macros */
+typedef struct {
+    const char* file;  //!< Filename
+    const char* fmt;   //!< printf format string
+    int line;          //!< Line number
+    int16_t level;     //!< Logging level
+    int16_t module;    //!< Module index (LOG_MODULE)
+} tLog_site;
+
+#define LOG_SITE_ID_INVALID UINT16_MAX  /* Call site ID of an entry that is not in the call site table, which holds at most 65535 entries */
+#endif
+
+#if LOG_USE_RATELIMIT
+/** Rate limit state of a call site, which shall be zero initialised */
+typedef struct {
+    tLog_timestamp start; //!< Timestamp at the start of the current interval
+    uint32_t count;       //!< Number of log messages written in the current interval
+    uint32_t suppressed;  //!< Number of log messages suppressed since the last log message was written
+} tLog_ratelimit;
+#endif
+
+#if LOG_USE_FIELDS
+/** Type of the value of a structured log message field */
+typedef enum {
+    LOG_FIELD_I32,   //!< int32_t value
+    LOG_FIELD_U32,   //!< uint32_t value
+    LOG_FIELD_I64,   //!< int64_t value
+    LOG_FIELD_U64,   //!< uint64_t value
+    LOG_FIELD_F32,   //!< float value
+    LOG_FIELD_F64,   //!< double value
+    LOG_FIELD_BOOL,  //!< bool value
+    LOG_FIELD_STR    //!< Null terminated string
+} tLog_fieldType;
+
+/** Typed key/value field of a structured log message */
+typedef struct {
+    const char* key;      //!< Field name
+    tLog_fieldType type;  //!< Type of the field value
+    union {
+        int32_t i32;
+        uint32_t u32;
+        int64_t i64;
+        uint64_t u64;
+        float f32;
+        double f64;
+        bool b;
+        const char* str;
+    } value;              //!< Field value, which is the union member selected by type
+} tLog_field;
+#endif
+
+#if LOG_USE_SPANS && defined( __GNUC__ )
+/** Span that has been begun by LOG_SPAN_SCOPE(), and is ended by log_spanScopeEnd() when its scope is left */
+typedef struct {
+#if LOG_USE_STRING_TABLE
+    const tLog_site* site;  //!< Call site table entry of the span end record, with the filename and line number of the span begin record
+#else
+    const char* file;       //!< Filename of the span begin record
+    int line;               //!< Line number of the span begin record
+#endif
+} tLog_spanScope;
+#endif
+
+/** Logger context: the logging level, lock, callbacks and statistics of a logger instance, which is opaque */
+typedef struct tLog_context tLog_context;
+
 /** Log event type */
 typedef struct {
-    uint32_t time;      //!< Timestamp value
+    tLog_timestamp time;  //!< Timestamp value
     int level;          //!< Logging level of this log message
     const char *file;   //!< Filename
     int line;           //!< Line number
     const char* fmt;    //!< printf format string
     va_list ap;         //!< printf variadic arguments list
+#if LOG_USE_MODULES
+    int module;         //!< Module index of this log message
+#endif
+#if LOG_USE_STRING_TABLE
+    const tLog_site* site;  //!< Call site table entry, or NULL if the log message was written by log_log()
+#endif
+#if LOG_USE_MESSAGE_BUFFER
+    const char* text;   //!< Formatted, null terminated log message body (truncated to LOG_MESSAGE_BUFFER_SIZE - 1 characters), or NULL
+    size_t textLength;  //!< Number of characters of the formatted log message body
+    char* buffer;       //!< Message buffer into which log_eventText() formats the log message body, or NULL
+#endif
+#if LOG_USE_FIELDS
+    const tLog_field* fields;  //!< Fields of a structured log message, whose text is the only printf argument of fmt "%s", or NULL
+    size_t fieldCount;         //!< Number of fields of a structured log message
+    const char* fieldsMsg;     //!< Message of a structured log message whose text has not been formatted yet, or NULL
+    char* fieldsText;          //!< Buffer of LOG_FIELDS_TEXT_SIZE bytes into which the text of a structured log message is formatted
+#endif
+    tLog_context* context;  //!< Logger context that wrote the log message, or NULL for the default context
 } tLog_event;
 
 #if LOG_USE_CALLBACKS
@@ -98,6 +748,102 @@ typedef struct {
 typedef void (*tLog_callbackFn)( tLog_event* ev, void* cbData );
 #endif
 
+#if LOG_USE_BATCH_SINK
+/** Log message that has been accumulated in a batch */
+typedef struct {
+    tLog_timestamp time;  //!< Timestamp value
+    int level;          //!< Logging level of this log message
+    const char* file;   //!< Filename
+    int line;           //!< Line number
+    const char* text;   //!< Formatted, null terminated log message body
+    size_t textLength;  //!< Number of characters of the log message body
+} tLog_batchEvent;
+
+/**
+ * @brief Batch callback function type.
+ * 
+ * The batch callback function is invoked with an array of the log messages
+ * that have been accumulated by a batch sink, e.g. to program a flash page or 
+ * to publish an MQTT packet. The log messages are only valid until the 
+ * function returns.
+ * 
+ * @param events Array of log messages, in the order they were written.
+ * @param count Number of log messages (at least 1).
+ * @param batchData Pointer to application-specific data, if required, or NULL.
+ */
+typedef void (*tLog_batchCallbackFn)( const tLog_batchEvent* events, size_t count, void* batchData );
+
+/** Batch sink state, which is passed to log_batchCallback() as its callback data */
+typedef struct {
+    tLog_batchCallbackFn batchFn;                 //!< Batch callback function
+    void* batchData;                              //!< Batch callback function data
+    size_t maxEvents;                             //!< Number of log messages at which the batch is delivered
+    size_t maxBytes;                              //!< Maximum number of bytes of log message bodies in the batch, including null terminators
+    tLog_timestamp maxAge;                        //!< Age of the oldest log message at which the batch is delivered, or 0
+    size_t count;                                 //!< Number of accumulated log messages
+    size_t length;                                //!< Number of bytes of accumulated log message bodies
+    tLog_batchEvent events[LOG_BATCH_MAX_EVENTS];  //!< Accumulated log messages
+    char text[LOG_BATCH_BUFFER_SIZE];             //!< Accumulated log message bodies
+} tLog_batchSink;
+#endif
+
+#if LOG_USE_BINARY_SINK
+/**
+ * @brief Binary log record write function type.
+ * 
+ * The write function stores or transmits an encoded binary log record, e.g. by
+ * appending it to a flash log or a network packet.
+ * 
+ * @param record Encoded record, including its length prefix.
+ * @param length Number of bytes of the record.
+ * @param writeData Pointer to application-specific data, if required, or NULL.
+ */
+typedef void (*tLog_binaryWriteFn)( const uint8_t* record, size_t length, void* writeData );
+
+/** Binary log sink state, which is passed to log_binaryCallback() as its callback data */
+typedef struct {
+    tLog_binaryWriteFn writeFn;  //!< Record write function
+    void* writeData;             //!< Record write function data
+    tLog_timestamp time;         //!< Timestamp of the previous record
+    bool synced;                 //!< A sync record has been written
+} tLog_binarySink;
+#endif
+
+#if LOG_USE_MMAP_SINK
+/** Memory-mapped file sink state, which is passed to log_mmapCallback() as its callback data */
+typedef struct {
+    char path[LOG_MMAP_PATH_SIZE];  //!< Path of the current log file; rotated log files have the suffix ".1" (newest) to ".<maxFiles>"
+    int fd;                         //!< File descriptor of the current log file, or -1 if it is not open
+    char* map;                      //!< Mapped segment of the current log file, or NULL if it is not mapped
+    size_t size;                    //!< Size of the mapped segment in bytes, at which the log file is rotated
+    size_t length;                  //!< Number of bytes written to the current log file
+    size_t syncBytes;               //!< Number of bytes written between calls of msync(), or 0 to leave write-back to the kernel
+    size_t syncedLength;            //!< Number of bytes of the current log file at the last call of msync()
+    size_t pageSize;                //!< Page size, to which msync() addresses are aligned
+    unsigned int maxFiles;          //!< Number of rotated log files that are kept
+    uint32_t rotations;             //!< Number of times the log file has been rotated
+} tLog_mmapSink;
+#endif
+
+#if LOG_USE_ASYNC && LOG_USE_CHUNK_OUTPUT
+/**
+ * @brief Log chunk write function type.
+ * 
+ * The optional chunk write function starts the transmission of a complete,
+ * queued log message directly from the queue memory, e.g. by a UART DMA 
+ * transfer or an RTT up-buffer. If it accepts the chunk, then the chunk 
+ * remains valid until log_releaseChunk() is called, e.g. by the DMA transfer
+ * complete ISR.
+ * 
+ * @param chunk Log message prefix and body, null terminated and aligned to LOG_CHUNK_ALIGNMENT bytes.
+ * @param length Number of characters of the chunk, excluding the null terminator.
+ * @param writeData Pointer to application-specific data, if required, or NULL.
+ * 
+ * @return true if the chunk has been accepted, or false if the driver is busy.
+ */
+typedef bool (*tLog_chunkWriteFn)( const char* chunk, size_t length, void* writeData );
+#endif
+
 /**
  * @brief Log lock function type.
  * 
@@ -114,19 +860,55 @@ typedef void (*tLog_callbackFn)( tLog_event* ev, void* cbData );
  */
 typedef bool (*tLog_lockFn)( bool lock, void* lockData );
 
+/** Lock timeout that waits until the mutex is acquired */
+#define LOG_LOCK_WAIT_FOREVER UINT32_MAX
+
 /**
- * @brief Log timestamp function type.
+ * @brief Log timed lock function type.
  * 
- * The optional timestamp function returns the current time as an unsigned
- * integer value (uint32_t). The timestamp value units are application-specific,
- * but are normally milliseconds since boot-time.
+ * The timed lock function is a lock function that limits the time for which 
+ * the caller waits to acquire the mutex. If the mutex cannot be acquired 
+ * within the timeout, the lock function returns false, and the log message is
+ * dropped and counted in the statistics returned by log_getStats(). The 
+ * timeout is in lock function units (e.g. RTOS ticks), and is not used when 
+ * the mutex is released.
  * 
- * @return timestamp value, as an unsigned integer.
+ * @param lock true to acquire the mutex that enables printing of log messages, false to release the mutex.
+ * @param timeout Maximum time to wait to acquire the mutex: 0 to try once without waiting, or LOG_LOCK_WAIT_FOREVER.
+ * @param lockData Pointer to application-specific data, if required, or NULL.
+ * 
+ * @return true if the mutex was successfully acquired or released, or false on failure or timeout.
  */
-typedef uint32_t (*tLog_timestampFn)( void );
+typedef bool (*tLog_timedLockFn)( bool lock, uint32_t timeout, void* lockData );
 
 /**
- * @brief Log level enum.
+ * @brief Log timestamp function type.
+ * 
+ * The optional timestamp function returns the current time as an unsigned
+ * integer value (uint32_t, or uint64_t if LOG_TIMESTAMP_64 is set). The 
+ * timestamp value units are application-specific, but are normally 
+ * milliseconds since boot-time.
+ * 
+ * @return timestamp value, as an unsigned integer.
+ */
+typedef tLog_timestamp (*tLog_timestampFn)( void );
+
+#if LOG_USE_ASYNC
+/**
+ * @brief Log context ID function type.
+ * 
+ * The optional context ID function returns an identifier of the calling 
+ * context, e.g. the current CPU core number or RTOS task number. When 
+ * LOG_ASYNC_QUEUE_COUNT is greater than 1, asynchronous log messages are 
+ * written to the queue whose index is the context ID modulo LOG_ASYNC_QUEUE_COUNT.
+ * 
+ * @return context ID, as an unsigned integer.
+ */
+typedef uint32_t (*tLog_contextIdFn)( void );
+#endif
+
+/**
+ * @brief Log level enum.
  */
 typedef enum {
     LOG_TRACE,
@@ -137,6 +919,66 @@ typedef enum {
     LOG_FATAL
 } tLog_level;
 
+/**
+ * @brief Logging statistics, which are read by log_getStats().
+ *
+ * Bucket 0 of a duration histogram counts durations of 0 timestamp ticks, and 
+ * bucket n counts durations of 2^(n-1) to 2^n - 1 ticks. The last bucket also 
+ * counts all longer durations.
+ */
+typedef struct {
+    uint32_t dropped[LOG_FATAL + 1];  //!< Number of log messages dropped at each logging level
+    uint32_t lockFailures;            //!< Number of log messages dropped because the lock was not acquired
+    uint32_t queueFull;               //!< Number of log messages dropped because the asynchronous logging queue was full
+    uint32_t callbackLockFailures;    //!< Number of log messages queued for the console, but not passed to the callbacks because the lock was not acquired
+#if LOG_USE_COALESCE
+    uint32_t coalesceSkipped;         //!< Number of queued log messages that were not compared for coalescing because another producer held the last log message of the queue
+#endif
+#if LOG_USE_STATS
+    uint32_t calls[LOG_FATAL + 1];       //!< Number of log_log() calls at each logging level
+    uint32_t suppressed[LOG_FATAL + 1];  //!< Number of log_log() calls at each logging level that were below the console and callback levels
+    uint64_t bytes;                      //!< Number of characters written to the console
+    uint32_t callbackInvocations;        //!< Number of calls of logging callback functions
+    uint32_t printTime[LOG_STATS_BUCKETS];  //!< Histogram of the duration of writing a log message to the console, in timestamp ticks
+#if LOG_MAX_CALLBACKS > 0U
+    uint32_t callbackTime[LOG_MAX_CALLBACKS][LOG_STATS_BUCKETS];  //!< Histogram of the duration of each callback, by registration slot, in timestamp ticks
+#endif
+#endif
+} tLog_stats;
+
+#if LOG_USE_MODULES
+#define LOG_LEVEL_INHERIT ( -1 )  /* Module logging level: use the logging level set by log_setLevel() */
+#endif
+
+/* Public variable declarations ---------------------------------------------*/
+
+/**
+ * Lowest logging level at which a log message is written to the console or
+ * passed to a registered callback. It is read by the logging macros so that
+ * suppressed log messages cost a single load and compare. It is maintained by
+ * the logging API functions and shall not be written by the application.
+ */
+extern int log_effectiveLevel;
+
+#if LOG_USE_MODULES
+/**
+ * Lowest logging level at which a log message of each module is written to 
+ * the console or passed to a registered callback, which is read by the logging
+ * macros. It is maintained by the logging API functions and shall not be 
+ * written by the application.
+ */
+extern int8_t log_effectiveModuleLevel[LOG_MAX_MODULES];
+#endif
+
+#if LOG_USE_SAMPLING
+/**
+ * Sample rate of the sampled logging macros at each logging level, which is 
+ * read by the macros. It is set by log_setSampleRate() and shall not be 
+ * written by the application.
+ */
+extern uint32_t log_sampleRate[LOG_FATAL + 1];
+#endif
+
 /* Public function declarations ---------------------------------------------*/
 
 /**
@@ -149,6 +991,36 @@ typedef enum {
  */
 void log_setLevel( int level );
 
+#if LOG_USE_MODULES
+/**
+ * @brief Set the logging level of a module.
+ *
+ * Log messages of the module are printed at or above the module logging level,
+ * instead of the logging level set by log_setLevel(), e.g. to trace a single 
+ * subsystem while the other modules log at LOG_WARN. 
+ *
+ * @param module Module index, which is less than LOG_MAX_MODULES.
+ * @param level Module logging level, or LOG_LEVEL_INHERIT to use the logging level set by log_setLevel().
+ * @return true on success, or false if the module index is out of range.
+ */
+bool log_setModuleLevel( int module, int level );
+#endif
+
+#if LOG_USE_SAMPLING
+/**
+ * @brief Set the sample rate of the sampled logging macros at a logging level.
+ *
+ * Each call site of log_trace_sampled() ... log_fatal_sampled() counts its log
+ * messages that would be written, and writes only every rate-th of them. A 
+ * sampled out log message costs an increment and a compare, in the macro.
+ *
+ * @param level Logging level.
+ * @param rate Number of log messages per written log message, or 0 or 1 to write all log messages.
+ * @return true on success, or false if the logging level is out of range.
+ */
+bool log_setSampleRate( int level, uint32_t rate );
+#endif
+
 /**
  * @brief Disable the printing of log messages to the console.
  */
@@ -168,6 +1040,12 @@ void log_on( void );
  * passed to the callback function are the log message and metadata, along with
  * the callback's associated data object cbData.
  *
+ * Callbacks are invoked in ascending order of cbLogLevel. Registration takes 
+ * the lock, waiting without a timeout if a timed lock function is set, so it 
+ * may run concurrently with logging and with other registrations, but shall 
+ * not be called from a logging callback. Registration fails if the lock is 
+ * not acquired.
+ *
  * @param cbFn Logging callback function pointer.
  * @param cbData Logging callback data object pointer, if required, or NULL if not used.
  * @param cbLogLevel Lowest logging level at which the callback will be invoked.
@@ -183,12 +1061,205 @@ bool log_registerCallbackFn( tLog_callbackFn cbFn, void* cbData, int cbLogLevel
  * different callback data objects. If that is the case, then only the callback
  * function instance with matching callback data will be unregistered. After
  * unregistering a callback function, that function will no longer be invoked
- * when log messages are written.
+ * when log messages are written. The same concurrency restrictions apply as 
+ * for log_registerCallbackFn(), and the registration is not changed if the 
+ * lock is not acquired.
  *
  * @param cbFn Logging callback function pointer.
  * @param cbData Logging callback data object pointer, or NULL.
  */
 void log_unregisterCallbackFn( tLog_callbackFn cbFn, void* cbData );
+
+/**
+ * @brief Register a logging callback function of a logger context, as log_registerCallbackFn() does for the default context.
+ *
+ * Each context has up to LOG_MAX_CALLBACKS callbacks.
+ *
+ * @param context Logger context.
+ * @param cbFn Logging callback function pointer.
+ * @param cbData Logging callback data object pointer, if required, or NULL if not used.
+ * @param cbLogLevel Lowest logging level at which the callback will be invoked.
+ * @return true on success, or false if the maximum number of callback functions of the context has been exceeded.
+ */
+bool log_registerContextCallbackFn( tLog_context* context, tLog_callbackFn cbFn, void* cbData, int cbLogLevel );
+
+/**
+ * @brief Unregister a logging callback function of a logger context, as log_unregisterCallbackFn() does for the default context.
+ *
+ * @param context Logger context.
+ * @param cbFn Logging callback function pointer.
+ * @param cbData Logging callback data object pointer, or NULL.
+ */
+void log_unregisterContextCallbackFn( tLog_context* context, tLog_callbackFn cbFn, void* cbData );
+#endif
+
+#if LOG_USE_MESSAGE_BUFFER
+/**
+ * @brief Get the formatted log message body of a log event.
+ *
+ * The log message body is formatted into the message buffer on the first call
+ * for a log message, and the same text is returned to the console and to all 
+ * later callbacks. If LOG_LAZY_FORMAT is set, then the log message body is only
+ * formatted if a sink calls this function, so callbacks that only read the 
+ * level, filename and line number, the typed fields of a structured log 
+ * message, or that encode the printf arguments, cost no formatting. It shall
+ * only be called from a logging callback, with the log event passed to the 
+ * callback, before ev->ap is read by the callback.
+ *
+ * @param ev Log event data passed to a logging callback.
+ * @param length Destination for the number of characters of the log message body, or NULL.
+ * @return Formatted, null terminated log message body (truncated to LOG_MESSAGE_BUFFER_SIZE - 1 characters).
+ */
+const char* log_eventText( tLog_event* ev, size_t* length );
+#endif
+
+#if LOG_USE_BATCH_SINK
+/**
+ * @brief Initialize a batch sink.
+ *
+ * Register log_batchCallback() with a pointer to the sink as its callback data
+ * to accumulate log messages. The batch is delivered to the batch callback 
+ * function when it holds maxEvents log messages, when the next log message body
+ * would not fit in maxBytes, when the oldest log message is maxAge timestamp 
+ * units older than the newest, or when log_flush() is called.
+ *
+ * @param sink Batch sink.
+ * @param batchFn Batch callback function.
+ * @param batchData Batch callback function data, if required, or NULL if not used.
+ * @param maxEvents Number of log messages at which the batch is delivered (limited to LOG_BATCH_MAX_EVENTS), or 0 for LOG_BATCH_MAX_EVENTS.
+ * @param maxBytes Maximum size of the log message bodies of the batch (limited to LOG_BATCH_BUFFER_SIZE), or 0 for LOG_BATCH_BUFFER_SIZE.
+ * @param maxAge Age of the oldest log message at which the batch is delivered, or 0 to disable the time threshold.
+ */
+void log_batchSinkInit( tLog_batchSink* sink, tLog_batchCallbackFn batchFn, void* batchData, size_t maxEvents, size_t maxBytes, tLog_timestamp maxAge );
+
+/**
+ * @brief Logging callback function that accumulates log messages in a batch sink.
+ *
+ * @param ev Log event data.
+ * @param cbData Pointer to the tLog_batchSink.
+ */
+void log_batchCallback( tLog_event* ev, void* cbData );
+#endif
+
+#if LOG_USE_BATCH_SINK || LOG_USE_COALESCE
+/**
+ * @brief Deliver the log messages that are held back by the library.
+ *
+ * Writes the repeat count of the last log message of each logger context and
+ * asynchronous queue, if LOG_USE_COALESCE is set and it has been repeated, and
+ * delivers the log messages accumulated by all registered batch sinks, if 
+ * LOG_USE_BATCH_SINK is set.
+ *
+ * @return true on success, or false if the lock could not be acquired.
+ */
+bool log_flush( void );
+#endif
+
+#if LOG_USE_CRASH_LOG
+/**
+ * @brief Replay the log messages recorded in the crash-persistent RAM log.
+ *
+ * Call once after reset, after the console and callbacks are set up and before
+ * any other log message is written. Every log message is stored in the crash 
+ * log as a record that holds its timestamp, level, line number, filename and 
+ * format string pointers and packed printf arguments, without formatting. The
+ * records survive a reset because the crash log is placed in a section that is
+ * not initialized at startup. If the crash log header is valid, the committed 
+ * records (which pass their CRC check, if LOG_CRASH_RECORD_CRC is set) are 
+ * formatted and written to the console and callbacks, oldest first, with their
+ * original timestamps. The crash log is then emptied.
+ *
+ * The filename and format string pointers are only valid if the firmware image 
+ * is unchanged, so the crash log shall be discarded by log_discardCrashLog() 
+ * after a firmware update.
+ *
+ * @return Number of log messages replayed, or 0 if the crash log is not valid.
+ */
+int log_recoverCrashLog( void );
+
+/**
+ * @brief Empty the crash-persistent RAM log without replaying its log messages.
+ */
+void log_discardCrashLog( void );
+#endif
+
+#if LOG_USE_BINARY_SINK
+/**
+ * @brief Initialize a binary log sink.
+ *
+ * The sink writes a sync record, which holds the absolute timestamp, before 
+ * its first log message record. Register log_binaryCallback() with a pointer to
+ * the sink as its callback data to encode log messages as binary records.
+ *
+ * @param sink Binary log sink.
+ * @param writeFn Record write function.
+ * @param writeData Record write function data, if required, or NULL if not used.
+ */
+void log_binarySinkInit( tLog_binarySink* sink, tLog_binaryWriteFn writeFn, void* writeData );
+
+/**
+ * @brief Logging callback function that encodes log messages as binary records.
+ *
+ * The record holds the timestamp delta, the logging level, the addresses of the
+ * filename and the format string, which are decoded from the string table of 
+ * the ELF file by tools/log_ec_decode.py, the line number and the printf 
+ * arguments. The format string is not formatted on the target.
+ *
+ * @param ev Log event data.
+ * @param cbData Pointer to the tLog_binarySink.
+ */
+void log_binaryCallback( tLog_event* ev, void* cbData );
+#endif
+
+#if LOG_USE_MMAP_SINK
+/**
+ * @brief Open a memory-mapped file sink.
+ *
+ * An existing log file at the path is rotated. The new log file is 
+ * preallocated to segmentSize bytes and mapped into memory, so log messages 
+ * are written with a memory copy instead of a system call. When the next log 
+ * message does not fit, the log file is truncated to the bytes written and 
+ * renamed to "<path>.1", the existing rotated log files are renamed to the next
+ * suffix, the oldest is deleted, and a new log file is mapped. Register 
+ * log_mmapCallback() with a pointer to the sink as its callback data. This sink
+ * requires a POSIX host, e.g. a Linux simulator or gateway build.
+ *
+ * @param sink Memory-mapped file sink.
+ * @param path Path of the log file, which shall be shorter than LOG_MMAP_PATH_SIZE characters.
+ * @param segmentSize Size of each log file in bytes, at which it is rotated.
+ * @param maxFiles Number of rotated log files that are kept, or 0 to discard the log file when it is rotated.
+ * @param syncBytes Number of bytes written between asynchronous msync() calls, or 0 to leave write-back to the kernel.
+ * @return true if the log file has been opened and mapped, otherwise false.
+ */
+bool log_mmapSinkOpen( tLog_mmapSink* sink, const char* path, size_t segmentSize, unsigned int maxFiles, size_t syncBytes );
+
+/**
+ * @brief Write the mapped segment of a memory-mapped file sink back to its log file, and wait for completion.
+ *
+ * @param sink Memory-mapped file sink.
+ * @return true on success, or false if the log file is not open or msync() failed.
+ */
+bool log_mmapSinkSync( tLog_mmapSink* sink );
+
+/**
+ * @brief Close a memory-mapped file sink, truncating the log file to the bytes written.
+ *
+ * Unregister log_mmapCallback() before closing the sink.
+ *
+ * @param sink Memory-mapped file sink.
+ */
+void log_mmapSinkClose( tLog_mmapSink* sink );
+
+/**
+ * @brief Logging callback function that appends log messages to a memory-mapped log file.
+ *
+ * The log message is written in the console format, with its prefix, terminated by
+ * a newline, and truncated to LOG_MMAP_RECORD_SIZE bytes.
+ *
+ * @param ev Log event data.
+ * @param cbData Pointer to the tLog_mmapSink.
+ */
+void log_mmapCallback( tLog_event* ev, void* cbData );
 #endif
 
 /**
@@ -199,6 +1270,32 @@ void log_unregisterCallbackFn( tLog_callbackFn cbFn, void* cbData );
  */
 void log_setTimestampFn( tLog_timestampFn timestampFn );
 
+/**
+ * @brief Set the divisor that scales timestamps when log messages are printed.
+ *
+ * Timestamps are captured in the units of the timestamp source, e.g. CPU 
+ * cycles, and divided when the log message prefix is formatted, e.g. by the
+ * number of cycles per microsecond. Log events passed to callbacks hold the
+ * unscaled timestamp.
+ *
+ * @param divisor Number of timestamp ticks per printed unit, or 0 or 1 to print unscaled timestamps.
+ */
+void log_setTimestampDivisor( uint32_t divisor );
+
+#if LOG_USE_CYCLE_COUNTER
+/**
+ * @brief Enable the built-in cycle counter timestamp source.
+ *
+ * When LOG_USE_CYCLE_COUNTER is set, timestamps are read directly from the 
+ * CPU cycle counter (DWT->CYCCNT on Cortex-M, the time stamp counter on x86, 
+ * the virtual counter on AArch64, or CLOCK_MONOTONIC_RAW nanoseconds on other
+ * POSIX hosts), instead of calling the timestamp function. On Cortex-M, this 
+ * function enables the DWT cycle counter, and the other sources do not need to
+ * be enabled.
+ */
+void log_enableCycleCounter( void );
+#endif
+
 /**
  * @brief Register a logging lock function.
  *
@@ -210,6 +1307,329 @@ void log_setTimestampFn( tLog_timestampFn timestampFn );
  */
 void log_setLockFn( tLog_lockFn lockFn, void* lockData );
 
+/**
+ * @brief Register a logging lock function that waits for at most the lock timeout.
+ *
+ * The timed lock function replaces a lock function registered by 
+ * log_setLockFn(), and vice versa.
+ * 
+ * @param lockFn Timed lock function.
+ * @param lockData Lock user data, if required, or NULL if not used.
+ */
+void log_setTimedLockFn( tLog_timedLockFn lockFn, void* lockData );
+
+/**
+ * @brief Set the timeout that is passed to the timed lock function.
+ *
+ * @param timeout Maximum time to wait to acquire the mutex: 0 to try once without waiting, or LOG_LOCK_WAIT_FOREVER (default).
+ */
+void log_setLockTimeout( uint32_t timeout );
+
+/**
+ * @brief Read the logging statistics.
+ *
+ * A log message is dropped if the lock is not acquired, when it would have 
+ * been printed to the console or passed to a callback and it is not queued, 
+ * or if it is written asynchronously and the queue is full. If LOG_USE_STATS 
+ * is set, the calls, suppressed log messages (including those suppressed by 
+ * the level check of the logging macros), bytes written and callback 
+ * invocations are also counted, and the durations of console writes and 
+ * callbacks are measured with the timestamp source. The statistics are read 
+ * without the lock, so a counter may be read while a log message is being 
+ * written.
+ *
+ * @param[out] stats Logging statistics.
+ */
+void log_getStats( tLog_stats* stats );
+
+/**
+ * @brief Reset all logging statistics to zero.
+ */
+void log_resetStats( void );
+
+#if LOG_USE_STATS
+/**
+ * @brief Count a log message that is suppressed by the level check of a logging macro, without calling the logging function.
+ *
+ * It is called by the logging macros, so that the calls and suppressed log 
+ * messages are counted even though the logging function is not called.
+ *
+ * @param context Logger context, or NULL for the default context.
+ * @param level Logging level of the log message.
+ * @return 0, which is the value of a suppressed logging macro.
+ */
+int log_countSuppressed( tLog_context* context, int level );
+#endif
+
+/**
+ * @brief Get the default logger context, which is used by log_log(), the logging macros and the functions without a context parameter.
+ *
+ * @return Default logger context.
+ */
+tLog_context* log_getDefaultContext( void );
+
+#if LOG_MAX_CONTEXTS > 0U
+/**
+ * @brief Allocate a logger context, e.g. for a subsystem, from a pool of LOG_MAX_CONTEXTS contexts.
+ *
+ * A logger context has its own logging level, console enable, lock, callbacks
+ * and statistics, so that its log messages do not contend on the lock of the
+ * other contexts. Each context also coalesces its own log messages, by 
+ * comparing them with its own last log message. The timestamp source, the 
+ * asynchronous queues, the crash log and the module logging levels are shared
+ * by all contexts. A new context logs at LOG_TRACE to the console, without a 
+ * lock or callbacks. Contexts cannot be freed, and shall be allocated during
+ * initialisation, not concurrently.
+ *
+ * @return Logger context, or NULL if all contexts have been allocated.
+ */
+tLog_context* log_createContext( void );
+#endif
+
+/**
+ * @brief Check whether a log message would be written to the console or passed to a callback by a logger context.
+ *
+ * @param context Logger context, or NULL for the default context.
+ * @param level Logging level.
+ * @return true if a log message at the logging level would be written.
+ */
+bool log_isContextEnabled( const tLog_context* context, int level );
+
+/**
+ * @brief Set the current logging level of a logger context, as log_setLevel() does for the default context.
+ *
+ * @param context Logger context.
+ * @param level Currently set logging level.
+ */
+void log_setContextLevel( tLog_context* context, int level );
+
+/**
+ * @brief Disable the printing of the log messages of a logger context to the console.
+ *
+ * @param context Logger context.
+ */
+void log_contextOff( tLog_context* context );
+
+/**
+ * @brief Enable the printing of the log messages of a logger context to the console.
+ *
+ * @param context Logger context.
+ */
+void log_contextOn( tLog_context* context );
+
+/**
+ * @brief Register the lock function of a logger context, as log_setLockFn() does for the default context.
+ *
+ * The contexts may share a lock function with different lock data, e.g. one
+ * mutex per context. If the contexts write to the same console, and the 
+ * console is not thread-safe, they should share a mutex or only one context
+ * should write to the console.
+ *
+ * @param context Logger context.
+ * @param lockFn Lock function.
+ * @param lockData Lock user data, if required, or NULL if not used.
+ */
+void log_setContextLockFn( tLog_context* context, tLog_lockFn lockFn, void* lockData );
+
+/**
+ * @brief Register the timed lock function of a logger context, as log_setTimedLockFn() does for the default context.
+ *
+ * @param context Logger context.
+ * @param lockFn Timed lock function.
+ * @param lockData Lock user data, if required, or NULL if not used.
+ */
+void log_setContextTimedLockFn( tLog_context* context, tLog_timedLockFn lockFn, void* lockData );
+
+/**
+ * @brief Set the timeout that is passed to the timed lock function of a logger context.
+ *
+ * @param context Logger context.
+ * @param timeout Maximum time to wait to acquire the mutex: 0 to try once without waiting, or LOG_LOCK_WAIT_FOREVER (default).
+ */
+void log_setContextLockTimeout( tLog_context* context, uint32_t timeout );
+
+/**
+ * @brief Read the logging statistics of a logger context.
+ *
+ * The durations and bytes of the log messages that are printed by log_drain()
+ * are counted in the statistics of the default context.
+ *
+ * @param context Logger context.
+ * @param[out] stats Logging statistics.
+ */
+void log_getContextStats( const tLog_context* context, tLog_stats* stats );
+
+/**
+ * @brief Reset all logging statistics of a logger context to zero.
+ *
+ * @param context Logger context.
+ */
+void log_resetContextStats( tLog_context* context );
+
+#if LOG_USE_ASYNC
+/**
+ * @brief Enable or disable asynchronous printing of log messages to the console.
+ *
+ * When asynchronous printing is enabled, log_log() formats the log message body
+ * into a lock-free queue and returns immediately, without calling the lock 
+ * function or waiting for the console. The queued log messages are printed to
+ * the console by log_drain(). Log messages are dropped if the queue is full.
+ * If LOG_DEFERRED_FORMAT is enabled, log_log() queues the format string pointer 
+ * and the binary printf arguments instead, and log_drain() formats the log 
+ * message body.
+ * Logging callbacks are still invoked by log_log(), while holding the lock.
+ *
+ * @param async true to queue log messages for printing by log_drain(), false to print them immediately.
+ */
+void log_setAsync( bool async );
+
+/**
+ * @brief Register a function that identifies the calling context (e.g. CPU core).
+ *
+ * When LOG_ASYNC_QUEUE_COUNT is greater than 1, each context writes asynchronous
+ * log messages to its own queue, so that producers on different cores do not
+ * contend on the same queue. If no context ID function is registered, all log
+ * messages are written to the first queue.
+ *
+ * @param contextIdFn Context ID function, or NULL.
+ */
+void log_setContextIdFn( tLog_contextIdFn contextIdFn );
+
+#if LOG_USE_CHUNK_OUTPUT
+/**
+ * @brief Register a function that transmits queued log messages without copying them.
+ *
+ * When a chunk write function is registered, log_drain() hands each queued log 
+ * message to it instead of writing it to the console. The queue slot of the
+ * log message is not reused until all references to the chunk have been 
+ * released by log_releaseChunk(). If no function is registered, log_drain() 
+ * writes the queued log messages to the console.
+ *
+ * @param writeFn Chunk write function, or NULL.
+ * @param writeData Chunk write function data, if required, or NULL if not used.
+ */
+void log_setChunkWriteFn( tLog_chunkWriteFn writeFn, void* writeData );
+
+/**
+ * @brief Add a reference to a chunk that has been accepted by the chunk write function.
+ *
+ * This enables a chunk to be transmitted by more than one driver. It shall be
+ * called before the reference that is held by the caller has been released.
+ *
+ * @param chunk Chunk passed to the chunk write function.
+ */
+void log_retainChunk( const char* chunk );
+
+/**
+ * @brief Release a reference to a chunk, e.g. when its transmission is complete.
+ *
+ * When the last reference has been released, the queue slot of the chunk is 
+ * returned to the producers. This function may be called from an ISR.
+ *
+ * @param chunk Chunk passed to the chunk write function.
+ */
+void log_releaseChunk( const char* chunk );
+#endif
+
+/**
+ * @brief Print all queued log messages to the console.
+ *
+ * This function shall be called from a single thread or RTOS task, e.g. a low 
+ * priority background task. If LOG_ASYNC_QUEUE_COUNT is greater than 1, the
+ * queued log messages of all queues are merged in timestamp order.
+ *
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+int log_drain( void );
+#endif
+
+#if LOG_USE_STRING_TABLE
+/**
+ * @brief Logging function called by the logging macros when the call site table is enabled.
+ *
+ * @param site Call site table entry of the log message.
+ * @param fmt printf format string, which is the same as site->fmt.
+ * @param ... printf arguments.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+int log_logSite( const tLog_site* site, const char* fmt, ... ) LOG_PRINTF_FORMAT( 2, 3 );
+
+/**
+ * @brief Logging function called by the log_trace_ctx() ... log_fatal_ctx() macros when the call site table is enabled, as log_logContext() is otherwise.
+ *
+ * @param context Logger context, or NULL for the default context.
+ * @param site Call site table entry of the log message.
+ * @param fmt printf format string, which is the same as site->fmt.
+ * @param ... printf arguments.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+int log_logContextSite( tLog_context* context, const tLog_site* site, const char* fmt, ... ) LOG_PRINTF_FORMAT( 3, 4 );
+
+/**
+ * @brief Get the ID of a call site, which is its index in the call site table.
+ *
+ * IDs are assigned by the linker, and are only valid for the image that 
+ * contains the call site table, which may hold up to 65535 call sites. The 
+ * POST_BUILD step of log_ec_generate_string_table() rejects larger tables.
+ *
+ * @param site Call site table entry.
+ * @return Call site ID, or LOG_SITE_ID_INVALID if the entry is not one of the first 65535 entries of the table.
+ */
+uint16_t log_siteId( const tLog_site* site );
+
+/**
+ * @brief Get a call site table entry.
+ *
+ * @param id Call site ID.
+ * @return Call site table entry, or NULL if the ID is not in the table.
+ */
+const tLog_site* log_getSite( uint16_t id );
+#endif
+
+#if LOG_USE_RATELIMIT
+/**
+ * @brief Apply a rate limit to a call site, before its log message is formatted.
+ *
+ * Up to burst log messages are allowed in each interval, which starts at the 
+ * first log message after the previous interval has elapsed. The other log 
+ * messages are counted and suppressed. When a log message is allowed after 
+ * log messages have been suppressed, their number is returned, so that the 
+ * call site can first write the log message LOG_RATELIMIT_SUPPRESSED_FORMAT
+ * through the same module and call site table entry point as its own log 
+ * messages, as LOG_LOG_RATELIMITED() does. The state is not protected by the 
+ * lock, so the count of concurrent log messages from the same call site is 
+ * approximate.
+ *
+ * @param ratelimit Rate limit state of the call site.
+ * @param burst Maximum number of log messages per interval.
+ * @param interval Interval, in timestamp ticks.
+ * @param[out] suppressed Number of log messages suppressed since the last allowed log message, if the log message is allowed.
+ * @return true if the log message shall be written, false if it is suppressed.
+ */
+bool log_ratelimit( tLog_ratelimit* ratelimit, uint32_t burst, tLog_timestamp interval, uint32_t* suppressed );
+#endif
+
+#if LOG_USE_MINIMAL_PRINTF
+/**
+ * @brief Format a string with the built-in minimal printf formatter.
+ *
+ * A compact replacement for vsnprintf() that supports the conversions %d, %i,
+ * %u, %x, %X, %o, %c, %s, %p and %%, the flags '-', '0', '+' and ' ', field
+ * width and precision (including '*'), and the length modifiers hh, h, l, ll, 
+ * j, z and t. If LOG_MINIMAL_PRINTF_FLOAT is set, %f and %F are also supported,
+ * with a precision of up to 9 digits, for values smaller than 2^64. Other 
+ * conversions are copied to the output unformatted. The function does not 
+ * recurse or allocate memory, and its stack usage is bounded.
+ *
+ * @param buffer Destination buffer.
+ * @param size Size of the destination buffer.
+ * @param fmt printf format string.
+ * @param ap printf variadic arguments list.
+ * @return Number of characters that would have been written if the buffer were large enough, excluding the null terminator.
+ */
+int log_vsnprintf( char* buffer, size_t size, const char* fmt, va_list ap );
+#endif
+
 /**
  * @brief Main logging function.
  * 
@@ -219,8 +1639,186 @@ void log_setLockFn( tLog_lockFn lockFn, void* lockData );
  * @param fmt printf format string.
  * @param ... printf variadic arguments.
  * @return Number of characters printed if successful. On error, it returns a negative value.
+ *         When asynchronous printing is enabled, the number of characters of 
+ *         the log message body (or bytes of printf arguments, if 
+ *         LOG_DEFERRED_FORMAT is enabled) that have been queued, or a negative
+ *         value if the queue is full.
+ */
+int log_log( int level, const char* file, int line, const char* fmt, ... ) LOG_PRINTF_FORMAT( 4, 5 );
+
+/**
+ * @brief Logging function called by the log_trace_ctx() ... log_fatal_ctx() macros, which writes a log message with a logger context.
+ *
+ * The log message is written to the console if it is at or above the logging
+ * level of the context, and passed to the callbacks of the context, with the
+ * lock of the context held. log_log() writes log messages with the default 
+ * context.
+ *
+ * @param context Logger context, or NULL for the default context.
+ * @param level Logging level.
+ * @param file Source file that is printing the log message.
+ * @param line Source code line number that is printing the log message.
+ * @param fmt printf format string.
+ * @param ... printf variadic arguments.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+int log_logContext( tLog_context* context, int level, const char* file, int line, const char* fmt, ... ) LOG_PRINTF_FORMAT( 5, 6 );
+
+#if LOG_USE_MODULES
+/**
+ * @brief Logging function called by the logging macros when per-module logging levels are enabled.
+ *
+ * log_log() writes log messages of module 0.
+ *
+ * @param module Module index, which is less than LOG_MAX_MODULES.
+ * @param level Logging level.
+ * @param file Source file that is printing the log message.
+ * @param line Source code line number that is printing the log message.
+ * @param fmt printf format string.
+ * @param ... printf variadic arguments.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+int log_logModule( int module, int level, const char* file, int line, const char* fmt, ... ) LOG_PRINTF_FORMAT( 5, 6 );
+#endif
+
+#if LOG_USE_FIELDS
+/**
+ * @brief Structured logging function, which is called by the log_info_kv() etc. macros.
+ *
+ * The message and fields are formatted as the text "msg key=value key=value\n",
+ * without parsing a format string, and written as a log message with the format 
+ * string "%s". String values are enclosed in double quotes. The callbacks also
+ * receive the typed fields in the log event, so that they can encode them 
+ * without parsing the text.
+ *
+ * @param level Logging level.
+ * @param file Source file that is printing the log message.
+ * @param line Source code line number that is printing the log message.
+ * @param msg Message, which precedes the fields in the text of the log message.
+ * @param fields Array of typed key/value fields.
+ * @param fieldCount Number of fields.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+int log_logFields( int level, const char* file, int line, const char* msg, const tLog_field* fields, size_t fieldCount );
+
+#if LOG_USE_MODULES
+/**
+ * @brief Structured logging function called by the logging macros when per-module logging levels are enabled.
+ *
+ * @param module Module index, which is less than LOG_MAX_MODULES.
+ * @param level Logging level.
+ * @param file Source file that is printing the log message.
+ * @param line Source code line number that is printing the log message.
+ * @param msg Message, which precedes the fields in the text of the log message.
+ * @param fields Array of typed key/value fields.
+ * @param fieldCount Number of fields.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
  */
-int log_log( int level, const char* file, int line, const char* fmt, ... );
+int log_logModuleFields( int module, int level, const char* file, int line, const char* msg, const tLog_field* fields, size_t fieldCount );
+#endif
+
+/**
+ * @brief Discard a structured log message that is below LOG_COMPILE_LEVEL.
+ *
+ * @param msg Message.
+ * @param fieldCount Number of fields, which are not evaluated.
+ * @return 0, because nothing is printed.
+ */
+static inline int log_discardFields( const char* msg, size_t fieldCount )
+{
+    (void) msg;
+    (void) fieldCount;
+    return 0;
+}
+#endif
+
+#if LOG_DEFERRED_FORMAT
+/**
+ * @brief Logging function called by the C++ front end (log_ec.hpp), with printf arguments that have been packed by the caller.
+ *
+ * The arguments are packed in the order of the format string conversions, in
+ * native byte order: each '*' width or precision argument and each integer of
+ * no more than 32 bits as int32_t, other integers as int64_t, floating point 
+ * values as double, characters as int32_t, pointers as const void*, and 
+ * strings are copied with their null terminator.
+ *
+ * If the log message is only queued for the console, the packed arguments are
+ * copied into the queue without formatting. Otherwise, the log message body is
+ * formatted by the library and written with the format string "%s".
+ *
+ * @param level Logging level.
+ * @param file Source file that is printing the log message.
+ * @param line Source code line number that is printing the log message.
+ * @param fmt printf format string.
+ * @param args Packed printf arguments.
+ * @param argsLength Number of bytes of packed printf arguments.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+int log_logPacked( int level, const char* file, int line, const char* fmt, const uint8_t* args, size_t argsLength );
+
+#if LOG_USE_MODULES
+/**
+ * @brief Packed argument logging function called by the C++ front end when per-module logging levels are enabled.
+ *
+ * @param module Module index, which is less than LOG_MAX_MODULES.
+ * @param level Logging level.
+ * @param file Source file that is printing the log message.
+ * @param line Source code line number that is printing the log message.
+ * @param fmt printf format string.
+ * @param args Packed printf arguments.
+ * @param argsLength Number of bytes of packed printf arguments.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+int log_logModulePacked( int module, int level, const char* file, int line, const char* fmt, const uint8_t* args, size_t argsLength );
+#endif
+#endif
+
+/**
+ * @brief Discard a log message that is below LOG_COMPILE_LEVEL.
+ *
+ * It is only called in the unevaluated operand of LOG_DISCARD(), so the 
+ * compiler still checks the format string against the arguments, but the
+ * arguments are not evaluated, and the call and the format string are not
+ * compiled into the application, even without optimisation.
+ *
+ * @param fmt printf format string.
+ * @param ... printf variadic arguments.
+ * @return 0, because nothing is printed.
+ */
+static inline int log_discard( const char* fmt, ... ) LOG_PRINTF_FORMAT( 1, 2 );
+static inline int log_discard( const char* fmt, ... )
+{
+    (void) fmt;
+    return 0;
+}
+
+#if LOG_USE_SPANS && ( LOG_COMPILE_LEVEL <= LOG_SPAN_LEVEL ) && defined( __GNUC__ )
+/**
+ * @brief Write the span end record of a span begun by LOG_SPAN_SCOPE(), at the filename and line number of its begin record.
+ *
+ * It is called when the scope of the span is left, as the cleanup function of
+ * the span variable.
+ *
+ * @param span Span that is ended.
+ */
+static inline void log_spanScopeEnd( const tLog_spanScope* span )
+{
+    if( LOG_IS_ENABLED( LOG_SPAN_LEVEL ) )
+    {
+#if LOG_USE_STRING_TABLE
+        (void)log_logSite( span->site, LOG_SPAN_END_FORMAT );
+#elif LOG_USE_MODULES
+        (void)log_logModule( LOG_MODULE, LOG_SPAN_LEVEL, span->file, span->line, LOG_SPAN_END_FORMAT );
+#else
+        (void)log_log( LOG_SPAN_LEVEL, span->file, span->line, LOG_SPAN_END_FORMAT );
+#endif
+    }
+    else
+    {
+        (void)LOG_COUNT_SUPPRESSED( NULL, LOG_SPAN_LEVEL );
+    }
+}
+#endif
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,704 @@
+/**
+ * ****************************************************************************
+ * @file   : log_ec.hpp
+ * @brief  : C++17 front end of the logging library for embedded C
+ * ****************************************************************************
+ *
+ * Copyright (c) 2025 Tony Bayley
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Include this header instead of log_ec.h in C++17 source files. It redefines
+ * the LOG_LOG() macro, on which log_trace() ... log_fatal() and the rate
+ * limited, sampled and span macros are built, so that:
+ *
+ * - the format string, which shall be a string literal, is checked against the
+ *   argument types at compile time, and a mismatch is a compilation error;
+ * - if LOG_DEFERRED_FORMAT is enabled, the arguments are packed by templates,
+ *   without a va_list, and passed to log_logPacked().
+ *
+ * It also redefines the LOG_LOG_CONTEXT() macro of log_trace_ctx() ... 
+ * log_fatal_ctx(), so that their format strings are checked in the same way,
+ * but their arguments are passed to log_logContext() as in C. The structured
+ * logging macros log_trace_kv() ... log_fatal_kv() have no format string, and
+ * their field initialisers are C99 compound literals, so they are not 
+ * available in C++.
+ */
+
+#ifndef LOG_EC_HPP
+#define LOG_EC_HPP
+
+#if !defined( __cplusplus ) || ( __cplusplus < 201703L )
+#error "log_ec.hpp requires C++17"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "log_ec.h"
+
+/* Public macro definitions -------------------------------------------------*/
+
+/** Macro that evaluates to the format string, which is the first of the arguments of a logging macro */
+#define LOG_EC_FORMAT_STRING( FMT, ... ) FMT
+
+/** Macro that evaluates to the template arguments of the format string check of the arguments of a logging macro */
+#define LOG_EC_FORMAT_CHECK( ... ) \
+    ::log_ec::detail::checkFormat( LOG_EC_FORMAT_STRING( __VA_ARGS__, 0 ), decltype( ::log_ec::detail::argTypes( __VA_ARGS__ ) ){} ).valid, \
+    ::log_ec::detail::checkFormat( LOG_EC_FORMAT_STRING( __VA_ARGS__, 0 ), decltype( ::log_ec::detail::argTypes( __VA_ARGS__ ) ){} ).narrowing
+
+#undef LOG_LOG
+#if LOG_USE_STRING_TABLE
+/** Macro that records the log message in the call site table, checks its format string, and calls log_logSite() only if the log message would be written to the console or passed to a callback */
+#define LOG_LOG( LEVEL, ... ) __extension__ ({ \
+    static const tLog_site LOG_SITE_ATTRIBUTES log_site = { LOG_SITE_FILE_NAME, LOG_FORMAT_STRING( __VA_ARGS__, 0 ), __LINE__, LEVEL, LOG_MODULE }; \
+    LOG_IS_ENABLED( LEVEL ) ? ::log_ec::logSite< LOG_EC_FORMAT_CHECK( __VA_ARGS__ ) >( &log_site, __VA_ARGS__ ) : LOG_COUNT_SUPPRESSED( NULL, LEVEL ); })
+#else
+/** Macro that checks the format string of a log message, and writes it only if it would be written to the console or passed to a callback */
+#define LOG_LOG( LEVEL, ... ) ( LOG_IS_ENABLED( LEVEL ) ? \
+    ::log_ec::logMessage< LOG_EC_FORMAT_CHECK( __VA_ARGS__ ) >( LOG_MODULE, LEVEL, FILE_NAME, __LINE__, __VA_ARGS__ ) : LOG_COUNT_SUPPRESSED( NULL, LEVEL ) )
+#endif
+
+#undef LOG_LOG_CONTEXT
+#if LOG_USE_STRING_TABLE
+/** Macro that records the log message of a logger context, which is evaluated once, in the call site table, checks its format string, and calls log_logContextSite() only if the log message would be written to the console or passed to a callback by the context */
+#define LOG_LOG_CONTEXT( CONTEXT, LEVEL, ... ) __extension__ ({ \
+    static const tLog_site LOG_SITE_ATTRIBUTES log_site = { LOG_SITE_FILE_NAME, LOG_FORMAT_STRING( __VA_ARGS__, 0 ), __LINE__, LEVEL, LOG_MODULE }; \
+    tLog_context* log_macroContext = ( CONTEXT ); \
+    log_isContextEnabled( log_macroContext, LEVEL ) ? \
+        ::log_ec::logContextSite< LOG_EC_FORMAT_CHECK( __VA_ARGS__ ) >( log_macroContext, &log_site, __VA_ARGS__ ) : LOG_COUNT_SUPPRESSED( log_macroContext, LEVEL ); })
+#elif defined( __GNUC__ )
+/** Macro that checks the format string of a log message of a logger context, which is evaluated once, and writes it only if it would be written to the console or passed to a callback by the context */
+#define LOG_LOG_CONTEXT( CONTEXT, LEVEL, ... ) __extension__ ({ \
+    tLog_context* log_macroContext = ( CONTEXT ); \
+    log_isContextEnabled( log_macroContext, LEVEL ) ? \
+        ::log_ec::logContext< LOG_EC_FORMAT_CHECK( __VA_ARGS__ ) >( log_macroContext, LEVEL, FILE_NAME, __LINE__, __VA_ARGS__ ) : LOG_COUNT_SUPPRESSED( log_macroContext, LEVEL ); })
+#else
+/** Macro that checks the format string of a log message of a logger context, which is evaluated twice, so it shall not have side effects, and writes it only if it would be written to the console or passed to a callback by the context */
+#define LOG_LOG_CONTEXT( CONTEXT, LEVEL, ... ) ( log_isContextEnabled( CONTEXT, LEVEL ) ? \
+    ::log_ec::logContext< LOG_EC_FORMAT_CHECK( __VA_ARGS__ ) >( CONTEXT, LEVEL, FILE_NAME, __LINE__, __VA_ARGS__ ) : LOG_COUNT_SUPPRESSED( CONTEXT, LEVEL ) )
+#endif
+
+namespace log_ec {
+namespace detail {
+
+/* Private type definitions -------------------------------------------------*/
+
+/** List of the argument types of a logging macro, which is not instantiated at runtime */
+template<typename... Args>
+struct TypeList {};
+
+/** Category of a printf argument type */
+enum class ArgKind {
+    Integer,     //!< Integer, character, bool or enumeration type
+    Floating,    //!< float or double
+    LongDouble,  //!< long double
+    String,      //!< Pointer to char
+    Pointer,     //!< Other object pointer, or nullptr
+    Other        //!< Type that cannot be a printf argument
+};
+
+/** printf argument type information */
+struct ArgInfo {
+    ArgKind kind;      //!< Category of the type
+    std::size_t size;  //!< Size of the type in bytes
+};
+
+/** printf length modifier */
+enum class Length { None, HH, H, L, LL, J, Z, T, BigL };
+
+/** Conversion of a packed argument by its conversion specification, which is stored in 3 bits per argument */
+enum Narrowing : std::uint64_t {
+    NARROW_NONE = 0U,           //!< No conversion
+    NARROW_SCHAR = 1U,          //!< Integer converted to signed char
+    NARROW_UCHAR = 2U,          //!< Integer converted to unsigned char
+    NARROW_SHORT = 3U,          //!< Integer converted to short
+    NARROW_USHORT = 4U,         //!< Integer converted to unsigned short
+    NARROW_POINTER = 5U,        //!< String of a "%p" conversion, packed as a pointer
+    NARROW_PRECISION_ARG = 6U,  //!< String copied up to the precision given by the preceding '*' argument
+    NARROW_PRECISION = 7U       //!< String copied up to the precision of its conversion specification
+};
+
+/** Result of the check of a format string against the argument types */
+struct FormatInfo {
+    bool valid;               //!< The format string matches the argument types
+    std::uint64_t narrowing;  //!< Conversion of each of the first 21 arguments, 3 bits per argument
+};
+
+/* Private function definitions ---------------------------------------------*/
+
+/**
+ * @brief Capture the argument types of a logging macro, after array to pointer decay. Used only in decltype().
+ */
+template<typename... Args>
+TypeList<Args...> argTypes( Args... args );
+
+/**
+ * @brief Get the type information of a printf argument type.
+ *
+ * @return Category and size of the type.
+ */
+template<typename T>
+constexpr ArgInfo argInfo()
+{
+    if constexpr( std::is_integral_v<T> || std::is_enum_v<T> )
+    {
+        return { ArgKind::Integer, sizeof( T ) };
+    }
+    else if constexpr( std::is_same_v<T, long double> )
+    {
+        return { ArgKind::LongDouble, sizeof( T ) };
+    }
+    else if constexpr( std::is_floating_point_v<T> )
+    {
+        return { ArgKind::Floating, sizeof( T ) };
+    }
+    else if constexpr( std::is_pointer_v<T> && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<T>>, char> )
+    {
+        return { ArgKind::String, sizeof( T ) };
+    }
+    else if constexpr( std::is_same_v<T, std::nullptr_t> || ( std::is_pointer_v<T> && !std::is_function_v<std::remove_pointer_t<T>> ) )
+    {
+        return { ArgKind::Pointer, sizeof( const void* ) };
+    }
+    else
+    {
+        return { ArgKind::Other, 0U };
+    }
+}
+
+/**
+ * @brief Check that an integer argument type matches the length modifier of its conversion.
+ *
+ * Without a length modifier, any integer type that is promoted to int matches.
+ *
+ * @param length Length modifier.
+ * @param arg Argument type information.
+ * @return true if the argument type matches.
+ */
+constexpr bool integerMatches( Length length, ArgInfo arg )
+{
+    if( ArgKind::Integer != arg.kind )
+    {
+        return false;
+    }
+    switch( length )
+    {
+        case Length::None: return arg.size <= sizeof( int );
+        case Length::HH:   return arg.size == sizeof( char );
+        case Length::H:    return arg.size == sizeof( short );
+        case Length::L:    return arg.size == sizeof( long );
+        case Length::LL:   return arg.size == sizeof( long long );
+        case Length::J:    return arg.size == sizeof( std::intmax_t );
+        case Length::Z:    return arg.size == sizeof( std::size_t );
+        case Length::T:    return arg.size == sizeof( std::ptrdiff_t );
+        default:           return false;
+    }
+}
+
+/**
+ * @brief Check a format string against the types of its arguments.
+ *
+ * The conversions "%d", "%i", "%u", "%o", "%x" and "%X" require an integer of
+ * the size given by the length modifier, "%c" and '*' require a type that is
+ * promoted to int, "%f", "%e", "%g" and "%a" require a floating point type
+ * (long double with 'L'), "%s" requires a pointer to char, and "%p" requires
+ * an object pointer, including a pointer to char. "%n" and unknown 
+ * conversions are rejected, and the number of arguments shall be equal to the
+ * number of conversions. If LOG_DEFERRED_FORMAT is enabled, a "%s" conversion
+ * with a precision, or a "%p" conversion of a pointer to char, after the 21st
+ * argument is rejected, because its conversion is not recorded.
+ *
+ * @param fmt printf format string.
+ * @return Result of the check, and the conversions of the arguments.
+ */
+template<typename... Args>
+constexpr FormatInfo parseFormat( std::string_view fmt )
+{
+    constexpr ArgInfo args[] = { argInfo<Args>()..., { ArgKind::Other, 0U } };  /* the last entry is not an argument */
+    constexpr std::size_t count = sizeof...( Args );
+    FormatInfo info = { false, 0U };
+    std::size_t index = 0U;
+    std::size_t i = 0U;
+    while( i < fmt.size() )
+    {
+        if( '%' != fmt[i++] )
+        {
+            continue;
+        }
+
+        /* flags, field width and precision */
+        while( ( i < fmt.size() ) && ( ( '-' == fmt[i] ) || ( '+' == fmt[i] ) || ( ' ' == fmt[i] ) || ( '#' == fmt[i] ) || ( '0' == fmt[i] ) ) )
+        {
+            i++;
+        }
+        bool precision = false;
+        bool precisionArg = false;
+        for( int part = 0; part < 2; part++ )  /* field width, then precision if it follows a '.' */
+        {
+            if( 1 == part )
+            {
+                if( ( i >= fmt.size() ) || ( '.' != fmt[i] ) )
+                {
+                    break;  /* no precision */
+                }
+                precision = true;
+                i++;
+            }
+            if( ( i < fmt.size() ) && ( '*' == fmt[i] ) )
+            {
+                if( ( index >= count ) || !integerMatches( Length::None, args[index++] ) )
+                {
+                    return info;  /* '*' requires an int argument */
+                }
+                precisionArg = ( 1 == part );
+                i++;
+            }
+            while( ( i < fmt.size() ) && ( fmt[i] >= '0' ) && ( fmt[i] <= '9' ) )
+            {
+                i++;
+            }
+        }
+
+        /* length modifier */
+        Length length = Length::None;
+        if( i < fmt.size() )
+        {
+            switch( fmt[i] )
+            {
+                case 'h': length = ( ( ( i + 1U ) < fmt.size() ) && ( 'h' == fmt[i + 1U] ) ) ? Length::HH : Length::H; break;
+                case 'l': length = ( ( ( i + 1U ) < fmt.size() ) && ( 'l' == fmt[i + 1U] ) ) ? Length::LL : Length::L; break;
+                case 'j': length = Length::J; break;
+                case 'z': length = Length::Z; break;
+                case 't': length = Length::T; break;
+                case 'L': length = Length::BigL; break;
+                default: break;
+            }
+            i += ( Length::None == length ) ? 0U : ( ( Length::HH == length ) || ( Length::LL == length ) ) ? 2U : 1U;
+        }
+        if( i >= fmt.size() )
+        {
+            return info;  /* incomplete conversion specification */
+        }
+
+        /* conversion specifier */
+        char specifier = fmt[i++];
+        if( '%' == specifier )
+        {
+            continue;
+        }
+        if( index >= count )
+        {
+            return info;  /* too few arguments */
+        }
+        ArgInfo arg = args[index];
+        bool matches = false;
+        std::uint64_t narrowing = NARROW_NONE;
+        switch( specifier )
+        {
+            case 'd':
+            case 'i':
+                matches = integerMatches( length, arg );
+                narrowing = ( Length::HH == length ) ? NARROW_SCHAR : ( Length::H == length ) ? NARROW_SHORT : NARROW_NONE;
+                break;
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+                matches = integerMatches( length, arg );
+                narrowing = ( Length::HH == length ) ? NARROW_UCHAR : ( Length::H == length ) ? NARROW_USHORT : NARROW_NONE;
+                break;
+            case 'c':
+                matches = ( Length::None == length ) && integerMatches( length, arg );
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                matches = ( Length::BigL == length ) ? ( ArgKind::LongDouble == arg.kind ) :
+                          ( ( Length::None == length ) || ( Length::L == length ) ) && ( ArgKind::Floating == arg.kind );
+                break;
+            case 's':
+                matches = ( Length::None == length ) && ( ArgKind::String == arg.kind );
+                narrowing = precisionArg ? NARROW_PRECISION_ARG : precision ? NARROW_PRECISION : NARROW_NONE;
+                break;
+            case 'p':
+                matches = ( Length::None == length ) && ( ( ArgKind::Pointer == arg.kind ) || ( ArgKind::String == arg.kind ) );
+                narrowing = ( ArgKind::String == arg.kind ) ? NARROW_POINTER : NARROW_NONE;
+                break;
+            default:
+                break;  /* "%n" and unknown conversions */
+        }
+        if( !matches )
+        {
+            return info;
+        }
+        if( index < 21U )
+        {
+            info.narrowing |= narrowing << ( 3U * index );
+        }
+#if LOG_DEFERRED_FORMAT
+        else if( NARROW_POINTER <= narrowing )
+        {
+            return info;  /* the string would be copied instead of packed as a pointer, or without its precision */
+        }
+#endif
+        index++;
+    }
+    info.valid = ( index == count );  /* too many arguments if not all have been consumed */
+    return info;
+}
+
+/**
+ * @brief Check a format string against the argument types of a logging macro.
+ *
+ * @param fmt printf format string, which is the first of the arguments.
+ * @return Result of the check, and the narrowing conversions of the arguments.
+ */
+template<typename Fmt, typename... Args>
+constexpr FormatInfo checkFormat( std::string_view fmt, TypeList<Fmt, Args...> )
+{
+    return parseFormat<Args...>( fmt );
+}
+
+/**
+ * @brief Convert an argument for a call of a variadic C function: enumerations are passed as their underlying type.
+ *
+ * @param arg Argument.
+ * @return Argument value.
+ */
+template<typename T>
+constexpr auto varArg( T arg )
+{
+    if constexpr( std::is_enum_v<T> )
+    {
+        return static_cast<std::underlying_type_t<T>>( arg );
+    }
+    else
+    {
+        return arg;
+    }
+}
+
+#if LOG_DEFERRED_FORMAT
+/** Destination buffer of packed printf arguments */
+struct PackBuffer {
+    std::uint8_t* data;  //!< Packed printf arguments
+    std::size_t size;    //!< Size of the buffer in bytes
+    std::size_t length;  //!< Number of bytes of packed printf arguments
+    bool full;           //!< An argument did not fit, so packing has stopped
+    int lastInt;         //!< Value of the last int argument, which is the precision of a "%.*s" string argument
+};
+
+/**
+ * @brief Pack a fixed size argument value, unless it does not fit in the buffer.
+ *
+ * @param buffer Destination buffer.
+ * @param value Argument value.
+ */
+template<typename T>
+inline void packValue( PackBuffer& buffer, T value )
+{
+    if( !buffer.full && ( ( buffer.length + sizeof( value ) ) <= buffer.size ) )
+    {
+        std::memcpy( &buffer.data[buffer.length], &value, sizeof( value ) );
+        buffer.length += sizeof( value );
+    }
+    else
+    {
+        buffer.full = true;
+    }
+}
+
+/**
+ * @brief Get the precision of the conversion specification of an argument, from the format string.
+ *
+ * @param fmt printf format string.
+ * @param index Index of the argument, counting '*' arguments.
+ * @return Precision, or -1 if the conversion has no precision or a '*' precision.
+ */
+inline int formatPrecision( const char* fmt, std::size_t index )
+{
+    std::size_t argIndex = 0U;
+    while( '\0' != *fmt )
+    {
+        if( '%' != *fmt++ )
+        {
+            continue;
+        }
+        while( ( '\0' != *fmt ) && ( nullptr != std::strchr( "-+ #0", *fmt ) ) )
+        {
+            fmt++;
+        }
+        int precision = -1;
+        for( int part = 0; part < 2; part++ )  /* field width, then precision if it follows a '.' */
+        {
+            if( 1 == part )
+            {
+                if( '.' != *fmt )
+                {
+                    break;
+                }
+                fmt++;
+                precision = 0;
+            }
+            if( '*' == *fmt )
+            {
+                argIndex++;
+                fmt++;
+                precision = -1;
+            }
+            while( ( *fmt >= '0' ) && ( *fmt <= '9' ) )
+            {
+                precision = ( 1 == part ) ? ( ( precision * 10 ) + ( *fmt - '0' ) ) : precision;
+                fmt++;
+            }
+        }
+        while( ( '\0' != *fmt ) && ( nullptr != std::strchr( "hljztL", *fmt ) ) )
+        {
+            fmt++;
+        }
+        if( ( '\0' == *fmt ) || ( '%' == *fmt++ ) )
+        {
+            continue;  /* "%%" has no argument */
+        }
+        if( index == argIndex++ )
+        {
+            return precision;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Copy a string argument with its null terminator, truncating it if necessary.
+ *
+ * As printf does, no more than precision characters of the string are read, so
+ * the string need not be null terminated if a precision is specified.
+ *
+ * @param buffer Destination buffer.
+ * @param str String argument.
+ * @param precision Precision of the conversion specification, or -1 if not specified.
+ */
+inline void packString( PackBuffer& buffer, const char* str, int precision )
+{
+    if( buffer.full || ( buffer.length >= buffer.size ) )
+    {
+        buffer.full = true;
+        return;
+    }
+    str = ( nullptr != str ) ? str : "(null)";
+    std::size_t strLength = 0U;
+    while( ( ( precision < 0 ) || ( strLength < static_cast<std::size_t>( precision ) ) ) && ( '\0' != str[strLength] ) )
+    {
+        strLength++;
+    }
+    std::size_t strSize = strLength + 1U;
+    std::size_t copySize = ( strSize <= ( buffer.size - buffer.length ) ) ? strSize : ( buffer.size - buffer.length );
+    std::memcpy( &buffer.data[buffer.length], str, copySize - 1U );
+    buffer.data[buffer.length + copySize - 1U] = '\0';
+    buffer.length += copySize;
+}
+
+/**
+ * @brief Pack an argument in the format that is read by the library, as log_logPacked() requires.
+ *
+ * @tparam Narrow Conversion of the argument by its conversion specification.
+ * @tparam Index Index of the argument.
+ * @param buffer Destination buffer.
+ * @param fmt printf format string.
+ * @param arg Argument.
+ */
+template<std::uint64_t Narrow, std::size_t Index, typename T>
+inline void packArg( PackBuffer& buffer, const char* fmt, T arg )
+{
+    constexpr ArgKind kind = argInfo<T>().kind;
+    if constexpr( ( ArgKind::String == kind ) && ( NARROW_PRECISION_ARG == Narrow ) )
+    {
+        packString( buffer, arg, ( buffer.lastInt >= 0 ) ? buffer.lastInt : -1 );  /* negative precision argument is ignored */
+    }
+    else if constexpr( ( ArgKind::String == kind ) && ( NARROW_PRECISION == Narrow ) )
+    {
+        packString( buffer, arg, formatPrecision( fmt, Index ) );
+    }
+    else if constexpr( ( ArgKind::String == kind ) && ( NARROW_POINTER != Narrow ) )
+    {
+        packString( buffer, arg, -1 );
+    }
+    else if constexpr( ( ArgKind::Pointer == kind ) || ( ArgKind::String == kind ) )
+    {
+        packValue( buffer, (const void*)arg );
+    }
+    else if constexpr( ( ArgKind::Floating == kind ) || ( ArgKind::LongDouble == kind ) )
+    {
+        packValue( buffer, static_cast<double>( arg ) );
+    }
+    else if constexpr( NARROW_SCHAR == Narrow )
+    {
+        packValue( buffer, static_cast<std::int32_t>( static_cast<signed char>( arg ) ) );
+    }
+    else if constexpr( NARROW_UCHAR == Narrow )
+    {
+        packValue( buffer, static_cast<std::int32_t>( static_cast<unsigned char>( arg ) ) );
+    }
+    else if constexpr( NARROW_SHORT == Narrow )
+    {
+        packValue( buffer, static_cast<std::int32_t>( static_cast<short>( arg ) ) );
+    }
+    else if constexpr( NARROW_USHORT == Narrow )
+    {
+        packValue( buffer, static_cast<std::int32_t>( static_cast<unsigned short>( arg ) ) );
+    }
+    else if constexpr( sizeof( T ) <= sizeof( std::int32_t ) )
+    {
+        buffer.lastInt = static_cast<int>( arg );
+        packValue( buffer, static_cast<std::int32_t>( arg ) );
+    }
+    else
+    {
+        packValue( buffer, static_cast<std::int64_t>( arg ) );
+    }
+}
+
+/**
+ * @brief Pack the arguments of a log message, in order.
+ *
+ * @tparam Narrowing Conversions of the arguments, 3 bits per argument.
+ * @param buffer Destination buffer.
+ * @param fmt printf format string.
+ * @param args Arguments.
+ */
+template<std::uint64_t Narrowing, std::size_t... Index, typename... Args>
+inline void packArgs( PackBuffer& buffer, const char* fmt, std::index_sequence<Index...>, Args... args )
+{
+    ( packArg<( Index < 21U ) ? ( ( Narrowing >> ( 3U * Index ) ) & 0x7U ) : NARROW_NONE, Index>( buffer, fmt, args ), ... );
+}
+#endif
+
+}  // namespace detail
+
+/* Public function definitions ----------------------------------------------*/
+
+/**
+ * @brief Write a log message whose format string has been checked, which is called by the LOG_LOG() macro.
+ *
+ * If LOG_DEFERRED_FORMAT is enabled, the arguments are packed into a buffer of
+ * LOG_ASYNC_MESSAGE_SIZE bytes and passed to log_logPacked(). Otherwise, they
+ * are passed to log_log(), or log_logModule() if per-module logging levels are
+ * enabled.
+ *
+ * @tparam Valid The format string matches the argument types.
+ * @tparam Narrowing Conversions of the arguments.
+ * @param module Module index.
+ * @param level Logging level.
+ * @param file Source file that is printing the log message.
+ * @param line Source code line number that is printing the log message.
+ * @param fmt printf format string.
+ * @param args printf arguments.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+template<bool Valid, std::uint64_t Narrowing, typename... Args>
+inline int logMessage( int module, int level, const char* file, int line, const char* fmt, Args... args )
+{
+    static_assert( Valid, "log_ec: the printf format string does not match the types of the arguments" );
+#if LOG_DEFERRED_FORMAT
+    std::uint8_t data[LOG_ASYNC_MESSAGE_SIZE];
+    detail::PackBuffer buffer = { data, sizeof( data ), 0U, false, -1 };
+    detail::packArgs<Narrowing>( buffer, fmt, std::index_sequence_for<Args...>{}, args... );
+#if LOG_USE_MODULES
+    return log_logModulePacked( module, level, file, line, fmt, data, buffer.length );
+#else
+    (void)module;
+    return log_logPacked( level, file, line, fmt, data, buffer.length );
+#endif
+#elif LOG_USE_MODULES
+    return log_logModule( module, level, file, line, fmt, detail::varArg( args )... );
+#else
+    (void)module;
+    return log_log( level, file, line, fmt, detail::varArg( args )... );
+#endif
+}
+
+/**
+ * @brief Write a log message of a logger context whose format string has been checked, which is called by the LOG_LOG_CONTEXT() macro.
+ *
+ * @tparam Valid The format string matches the argument types.
+ * @param context Logger context.
+ * @param level Logging level.
+ * @param file Source file that is printing the log message.
+ * @param line Source code line number that is printing the log message.
+ * @param fmt printf format string.
+ * @param args printf arguments.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+template<bool Valid, std::uint64_t Narrowing, typename... Args>
+inline int logContext( tLog_context* context, int level, const char* file, int line, const char* fmt, Args... args )
+{
+    static_assert( Valid, "log_ec: the printf format string does not match the types of the arguments" );
+    return log_logContext( context, level, file, line, fmt, detail::varArg( args )... );
+}
+
+#if LOG_USE_STRING_TABLE
+/**
+ * @brief Write a log message of the call site table whose format string has been checked, which is called by the LOG_LOG() macro.
+ *
+ * @tparam Valid The format string matches the argument types.
+ * @param site Call site table entry.
+ * @param fmt printf format string.
+ * @param args printf arguments.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+template<bool Valid, std::uint64_t Narrowing, typename... Args>
+inline int logSite( const tLog_site* site, const char* fmt, Args... args )
+{
+    static_assert( Valid, "log_ec: the printf format string does not match the types of the arguments" );
+    return log_logSite( site, fmt, detail::varArg( args )... );
+}
+
+/**
+ * @brief Write a log message of a logger context and of the call site table whose format string has been checked, which is called by the LOG_LOG_CONTEXT() macro.
+ *
+ * @tparam Valid The format string matches the argument types.
+ * @param context Logger context.
+ * @param site Call site table entry.
+ * @param fmt printf format string.
+ * @param args printf arguments.
+ * @return Number of characters printed if successful. On error, it returns a negative value.
+ */
+template<bool Valid, std::uint64_t Narrowing, typename... Args>
+inline int logContextSite( tLog_context* context, const tLog_site* site, const char* fmt, Args... args )
+{
+    static_assert( Valid, "log_ec: the printf format string does not match the types of the arguments" );
+    return log_logContextSite( context, site, fmt, detail::varArg( args )... );
+}
+#endif
+
+}  // namespace log_ec
+
+#endif  /* #ifndef LOG_EC_HPP */
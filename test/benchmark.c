@@ -0,0 +1,454 @@
+/**
+ * ****************************************************************************
+ * @file   : benchmark.c
+ * @brief  : Latency and throughput benchmark for log_ec logging library
+ * ****************************************************************************
+ *
+ * Copyright (c) 2025 Tony Bayley
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 199309L  /* clock_gettime() */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <inttypes.h>
+#include <time.h>
+#include "log_ec.h"
+
+
+/* Private macro definitions ------------------------------------------------*/
+
+#define DEFAULT_ITERATIONS 100000U  /* Default number of log messages written by each benchmark scenario */
+#define SINK_BUFFER_SIZE 256U       /* Size in bytes of the buffer to which the console sink writes log messages */
+
+
+/* Private type definitions -------------------------------------------------*/
+
+/**
+ * @brief Benchmark scenario function pointer type.
+ *
+ * @param i Iteration number.
+ */
+typedef void (*tScenarioFn)( uint32_t i );
+
+/** Benchmark scenario */
+typedef struct {
+    const char* name;          //!< Scenario name
+    void (*setupFn)( void );   //!< Function that configures the logging library for the scenario
+    tScenarioFn scenarioFn;    //!< Function that writes one log message
+} tScenario;
+
+
+/* Private variable definitions ---------------------------------------------*/
+
+/** Buffer to which the console sink writes log messages, to simulate a console driver */
+static char m_sinkBuffer[SINK_BUFFER_SIZE];
+
+/** Number of characters written to the console sink, which prevents the compiler from optimising the sink away */
+static volatile size_t m_sinkLength = 0U;
+
+/** Timestamp counter */
+static uint32_t m_timestamp = 0U;
+
+/** Latency of each log message, in nanoseconds */
+static uint64_t* m_latencies = NULL;
+
+#if LOG_USE_CALLBACKS
+/** Callback data objects, so that the same callback function can be registered LOG_MAX_CALLBACKS times */
+static uint8_t m_callbackData[LOG_MAX_CALLBACKS];
+#endif
+
+#if LOG_USE_MMAP_SINK
+/** Memory-mapped file sink, which writes log_ec_bench.log in the working directory */
+static tLog_mmapSink m_mmapSink = { .fd = -1 };
+#endif
+
+
+/* Private function declarations --------------------------------------------*/
+
+static uint64_t nanoseconds( void );
+static tLog_timestamp getTimestamp( void );
+static bool lockFunction( bool lock, void* lockData );
+#if LOG_USE_CALLBACKS
+static void callbackFunction( tLog_event* ev, void* cbData );
+#endif
+static int compareLatencies( const void* a, const void* b );
+static void resetLogging( void );
+static void setupConsole( void );
+static void setupSuppressed( void );
+static void setupLock( void );
+#if LOG_USE_CALLBACKS
+static void setupCallbacks( void );
+static void setupCallbacksOnly( void );
+#endif
+#if LOG_USE_ASYNC
+static void setupAsync( void );
+#endif
+#if LOG_USE_MMAP_SINK
+static void setupMmapSink( void );
+#endif
+static void logMessage( uint32_t i );
+static void logSuppressedMessage( uint32_t i );
+static void runScenario( const tScenario* scenario, uint32_t iterations );
+
+
+/* Private constant definitions ---------------------------------------------*/
+
+/** List of benchmark scenarios */
+static const tScenario m_scenarios[] = {
+    { "suppressed (below log level)", setupSuppressed, logSuppressedMessage },
+    { "console", setupConsole, logMessage },
+    { "console + lock function", setupLock, logMessage },
+#if LOG_USE_CALLBACKS
+    { "callbacks only", setupCallbacksOnly, logMessage },
+    { "console + LOG_MAX_CALLBACKS callbacks", setupCallbacks, logMessage },
+#endif
+#if LOG_USE_ASYNC
+#if LOG_DEFERRED_FORMAT
+    { "async enqueue (deferred format)", setupAsync, logMessage },
+#else
+    { "async enqueue", setupAsync, logMessage },
+#endif
+#endif
+#if LOG_USE_MMAP_SINK
+    { "memory-mapped file sink only", setupMmapSink, logMessage },
+#endif
+};
+
+
+/* Public function definitions ----------------------------------------------*/
+
+/**
+ * @brief Benchmark application entry point.
+ *
+ * Each scenario writes the same log message repeatedly and reports the latency
+ * of a single call (median and 99th percentile) and the throughput. The console
+ * output is written to a memory buffer, so the results measure the cost of the
+ * logging library rather than the cost of the terminal. Compile-time options,
+ * such as LOG_USE_COLOR, are compared by building the benchmark with different
+ * CMake cache variable values. Usage:
+ *
+ *     ./log_ec_bench [iterations]
+ *
+ * @param argc Number of command line arguments
+ * @param argv Command line argument array
+ * @return 0 on success, 1 on failure
+ */
+int main( int argc, char* argv[] )
+{
+    uint32_t iterations = ( argc > 1 ) ? (uint32_t)strtoul( argv[1], NULL, 10 ) : DEFAULT_ITERATIONS;
+    iterations = ( iterations > 0U ) ? iterations : DEFAULT_ITERATIONS;
+    m_latencies = malloc( iterations * sizeof( m_latencies[0] ) );
+    if( NULL == m_latencies )
+    {
+        return 1;
+    }
+
+    printf( "log_ec benchmark: %" PRIu32 " log messages per scenario\n", iterations );
+    printf( "LOG_USE_COLOR=%d LOG_MAX_CALLBACKS=%d LOG_MESSAGE_BUFFER_SIZE=%d LOG_USE_CONSOLE_WRITE=%d LOG_USE_MINIMAL_PRINTF=%d "
+            "LOG_ASYNC_QUEUE_LENGTH=%d LOG_DEFERRED_FORMAT=%d\n\n",
+            (int)LOG_USE_COLOR, (int)LOG_MAX_CALLBACKS, (int)LOG_MESSAGE_BUFFER_SIZE, (int)LOG_USE_CONSOLE_WRITE, (int)LOG_USE_MINIMAL_PRINTF,
+            (int)LOG_ASYNC_QUEUE_LENGTH, (int)LOG_DEFERRED_FORMAT );
+    printf( "%-40s %10s %10s %14s\n", "scenario", "p50 (ns)", "p99 (ns)", "messages/s" );
+    for( size_t i = 0U; i < ( sizeof( m_scenarios ) / sizeof( m_scenarios[0] ) ); i++ )
+    {
+        runScenario( &m_scenarios[i], iterations );
+    }
+
+    free( m_latencies );
+    return 0;
+}
+
+int testPrintf( const char* format, ...)
+{
+    va_list arg;
+    va_start( arg, format );
+    int bytesWritten = vsnprintf( m_sinkBuffer, sizeof( m_sinkBuffer ), format, arg );
+    va_end( arg );
+    m_sinkLength += (size_t)bytesWritten;
+    return bytesWritten;
+}
+
+int testVprintf( const char* format, va_list arg)
+{
+    int bytesWritten = vsnprintf( m_sinkBuffer, sizeof( m_sinkBuffer ), format, arg );
+    m_sinkLength += (size_t)bytesWritten;
+    return bytesWritten;
+}
+
+int testVsnprintf( char* buffer, size_t size, const char* format, va_list arg)
+{
+#if LOG_USE_MINIMAL_PRINTF
+    return log_vsnprintf( buffer, size, format, arg );
+#else
+    return vsnprintf( buffer, size, format, arg );
+#endif
+}
+
+#if LOG_USE_CONSOLE_WRITE
+int testWrite( const char* buffer, size_t length )
+{
+    memcpy( m_sinkBuffer, buffer, ( length < sizeof( m_sinkBuffer ) ) ? length : sizeof( m_sinkBuffer ) );
+    m_sinkLength += length;
+    return (int)length;
+}
+#endif
+
+
+/* Private function definitions ---------------------------------------------*/
+
+/**
+ * @brief Read the monotonic clock.
+ *
+ * @return Time in nanoseconds.
+ */
+static uint64_t nanoseconds( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ( (uint64_t)ts.tv_sec * 1000000000U ) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Timestamp function that increments a counter.
+ *
+ * @return Timestamp value.
+ */
+static tLog_timestamp getTimestamp( void )
+{
+    return m_timestamp++;
+}
+
+/**
+ * @brief Lock function that always succeeds, to measure the cost of calling it.
+ *
+ * @param lock true to acquire the lock, false to release it.
+ * @param lockData Pointer to lock counter.
+ * @return true
+ */
+static bool lockFunction( bool lock, void* lockData )
+{
+    volatile uint32_t* lockCount = lockData;
+    *lockCount += lock ? 1U : 0U;
+    return true;
+}
+
+#if LOG_USE_CALLBACKS
+/**
+ * @brief Logging callback function that formats the log message into a buffer,
+ *        e.g. to simulate a callback that writes the log message to a file.
+ *
+ * @param ev Pointer to log event data.
+ * @param cbData Unused.
+ */
+static void callbackFunction( tLog_event* ev, void* cbData )
+{
+    (void)cbData;
+    char message[SINK_BUFFER_SIZE];
+#if LOG_USE_MESSAGE_BUFFER
+    size_t length = ev->textLength;
+    memcpy( message, ev->text, length );
+#else
+    int length = testVsnprintf( message, sizeof( message ), ev->fmt, ev->ap );
+#endif
+    m_sinkLength += (size_t)length;
+}
+#endif
+
+/**
+ * @brief qsort() comparison function for latency values.
+ *
+ * @param a Pointer to first latency value.
+ * @param b Pointer to second latency value.
+ * @return Negative, zero or positive if a is less than, equal to, or greater than b.
+ */
+static int compareLatencies( const void* a, const void* b )
+{
+    uint64_t latencyA = *(const uint64_t*)a;
+    uint64_t latencyB = *(const uint64_t*)b;
+    return ( latencyA > latencyB ) - ( latencyA < latencyB );
+}
+
+/**
+ * @brief Restore the default logging configuration.
+ */
+static void resetLogging( void )
+{
+    log_setTimestampFn( getTimestamp );
+    log_setLockFn( NULL, NULL );
+    log_setLevel( LOG_TRACE );
+    log_on();
+#if LOG_USE_CALLBACKS
+    for( size_t i = 0U; i < LOG_MAX_CALLBACKS; i++ )
+    {
+        log_unregisterCallbackFn( callbackFunction, &m_callbackData[i] );
+    }
+#endif
+#if LOG_USE_ASYNC
+    log_setAsync( false );
+#endif
+#if LOG_USE_MMAP_SINK
+    log_unregisterCallbackFn( log_mmapCallback, &m_mmapSink );
+    log_mmapSinkClose( &m_mmapSink );
+#endif
+}
+
+static void setupConsole( void )
+{
+    resetLogging();
+}
+
+static void setupSuppressed( void )
+{
+    resetLogging();
+    log_setLevel( LOG_WARN );
+}
+
+static void setupLock( void )
+{
+    static uint32_t lockCount = 0U;
+    resetLogging();
+    log_setLockFn( lockFunction, &lockCount );
+}
+
+#if LOG_USE_CALLBACKS
+static void setupCallbacks( void )
+{
+    resetLogging();
+    for( size_t i = 0U; i < LOG_MAX_CALLBACKS; i++ )
+    {
+        (void)log_registerCallbackFn( callbackFunction, &m_callbackData[i], LOG_TRACE );
+    }
+}
+
+static void setupCallbacksOnly( void )
+{
+    setupCallbacks();
+    log_off();
+}
+#endif
+
+#if LOG_USE_ASYNC
+static void setupAsync( void )
+{
+    resetLogging();
+    log_setAsync( true );
+}
+#endif
+
+#if LOG_USE_MMAP_SINK
+static void setupMmapSink( void )
+{
+    resetLogging();
+    if( log_mmapSinkOpen( &m_mmapSink, "log_ec_bench.log", 16U * 1024U * 1024U, 1U, 1024U * 1024U ) )
+    {
+        (void)log_registerCallbackFn( log_mmapCallback, &m_mmapSink, LOG_TRACE );
+    }
+    log_off();
+}
+#endif
+
+/**
+ * @brief Write a typical log message.
+ *
+ * @param i Iteration number.
+ */
+static void logMessage( uint32_t i )
+{
+    log_info( "sensor %u reading %d status %s\n", (unsigned int)( i & 7U ), (int)i - 5000, "ok" );
+}
+
+/**
+ * @brief Write a typical log message below the currently set logging level.
+ *
+ * @param i Iteration number.
+ */
+static void logSuppressedMessage( uint32_t i )
+{
+    log_debug( "sensor %u reading %d status %s\n", (unsigned int)( i & 7U ), (int)i - 5000, "ok" );
+}
+
+/**
+ * @brief Run a benchmark scenario and print the results.
+ *
+ * The latency of each call is measured individually, after subtracting the
+ * overhead of reading the clock, to calculate the percentiles. Then the
+ * throughput is measured by timing all calls together. When asynchronous
+ * logging is enabled, the queue is drained (outside the timed region) before
+ * it becomes full.
+ *
+ * @param scenario Benchmark scenario.
+ * @param iterations Number of log messages to write.
+ */
+static void runScenario( const tScenario* scenario, uint32_t iterations )
+{
+    /* measure the overhead of reading the clock */
+    uint64_t clockOverhead = UINT64_MAX;
+    for( uint32_t i = 0U; i < 1000U; i++ )
+    {
+        uint64_t start = nanoseconds();
+        uint64_t elapsed = nanoseconds() - start;
+        clockOverhead = ( elapsed < clockOverhead ) ? elapsed : clockOverhead;
+    }
+
+    scenario->setupFn();
+    for( uint32_t i = 0U; i < iterations; i++ )
+    {
+#if LOG_USE_ASYNC
+        if( 0U == ( i % LOG_ASYNC_QUEUE_LENGTH ) )
+        {
+            (void)log_drain();
+        }
+#endif
+        uint64_t start = nanoseconds();
+        scenario->scenarioFn( i );
+        uint64_t elapsed = nanoseconds() - start;
+        m_latencies[i] = ( elapsed > clockOverhead ) ? ( elapsed - clockOverhead ) : 0U;
+    }
+    qsort( m_latencies, iterations, sizeof( m_latencies[0] ), compareLatencies );
+    uint64_t p50 = m_latencies[iterations / 2U];
+    uint64_t p99 = m_latencies[( (uint64_t)iterations * 99U ) / 100U];
+
+    /* measure throughput: the queue is drained within the timed region, because that is part of the cost of asynchronous logging */
+    scenario->setupFn();
+    uint64_t start = nanoseconds();
+    for( uint32_t i = 0U; i < iterations; i++ )
+    {
+#if LOG_USE_ASYNC
+        if( 0U == ( i % LOG_ASYNC_QUEUE_LENGTH ) )
+        {
+            (void)log_drain();
+        }
+#endif
+        scenario->scenarioFn( i );
+    }
+#if LOG_USE_ASYNC
+    (void)log_drain();
+#endif
+    uint64_t elapsed = nanoseconds() - start;
+    double messagesPerSecond = ( elapsed > 0U ) ? ( (double)iterations * 1e9 / (double)elapsed ) : 0.0;
+
+    printf( "%-40s %10" PRIu64 " %10" PRIu64 " %14.0f\n", scenario->name, p50, p99, messagesPerSecond );
+    resetLogging();
+}
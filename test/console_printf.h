@@ -54,6 +54,40 @@ extern "C" {
  */
 #define CONSOLE_VPRINTF( FMT, ARG ) testVprintf( FMT, ARG )  /* override vprintf() with function that writes to test buffer */
 
+/**
+ * @brief Macro to override vsnprintf() standard library function.
+ * 
+ * @param BUF Destination buffer.
+ * @param SIZE Size of the destination buffer.
+ * @param FMT Print format string.
+ * @param ARG Argument list.
+ * @return Number of characters that would have been written if the buffer were large enough. 
+ */
+#define LOG_VSNPRINTF( BUF, SIZE, FMT, ARG ) testVsnprintf( BUF, SIZE, FMT, ARG )  /* override vsnprintf() with function that counts calls */
+
+#ifdef TEST_CONSOLE_WRITE
+/**
+ * @brief Macro to write a complete log message to the console with a single call.
+ * 
+ * @param BUF Log message buffer.
+ * @param LEN Number of characters in the log message buffer.
+ * @return Number of characters written. 
+ */
+#define CONSOLE_WRITE( BUF, LEN ) testWrite( BUF, LEN )  /* write log messages to test buffer, counting the number of writes */
+#endif
+
+#ifdef TEST_CYCLE_COUNTER
+/**
+ * @brief Macro to override the CPU cycle counter that is read when LOG_USE_CYCLE_COUNTER is set.
+ * 
+ * @return Cycle count. 
+ */
+#define LOG_READ_CYCLE_COUNTER() testCycleCounter()  /* read the expected timestamp, counting the number of reads */
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
 /* Public function declarations **********************************************/
 
 /**
@@ -74,6 +108,40 @@ int testPrintf( const char* format, ...);
  */
 int testVprintf( const char* format, va_list arg);
 
+/**
+ * @brief Function to override vsnprintf() that counts the number of times that
+ *        a log message body has been formatted.
+ * 
+ * @param buffer Destination buffer.
+ * @param size Size of the destination buffer.
+ * @param format Print format string.
+ * @param arg Argument list.
+ * @return Number of characters that would have been written if the buffer were large enough. 
+ */
+int testVsnprintf( char* buffer, size_t size, const char* format, va_list arg);
+
+#ifdef TEST_CYCLE_COUNTER
+/**
+ * @brief Function to override the CPU cycle counter that returns the expected
+ *        timestamp, and counts the number of times that it has been read.
+ * 
+ * @return Cycle count. 
+ */
+uint64_t testCycleCounter( void );
+#endif
+
+#ifdef TEST_CONSOLE_WRITE
+/**
+ * @brief Function that writes a complete log message to a test buffer, and 
+ *        counts the number of times that it has been called.
+ * 
+ * @param buffer Log message buffer.
+ * @param length Number of characters in the log message buffer.
+ * @return Number of characters written. 
+ */
+int testWrite( const char* buffer, size_t length );
+#endif
+
 #ifdef __cplusplus
 }
 #endif
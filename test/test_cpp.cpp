@@ -0,0 +1,119 @@
+/**
+ * ****************************************************************************
+ * @file   : test_cpp.cpp
+ * @brief  : Unit tests for the C++ front end of the log_ec logging library
+ * ****************************************************************************
+ *
+ * Copyright (c) 2025 Tony Bayley
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Includes -----------------------------------------------------------------*/
+
+#include "log_ec.hpp"
+
+/* Compile time tests of the format string check ----------------------------*/
+
+namespace {
+
+using log_ec::detail::TypeList;
+using log_ec::detail::checkFormat;
+
+/* format strings that match the argument types */
+static_assert( checkFormat( "%d %i %u %c\n", TypeList<const char*, int, short, unsigned, char>{} ).valid );
+static_assert( checkFormat( "%-5s|%04hx|%lld|%*d|%%\n", TypeList<const char*, const char*, unsigned short, long long, int, int>{} ).valid );
+static_assert( checkFormat( "%zu %p %p %.2f %.*e %Lg\n", TypeList<const char*, std::size_t, const void*, std::nullptr_t, float, int, double, long double>{} ).valid );
+static_assert( checkFormat( "no arguments\n", TypeList<const char*>{} ).valid );
+static_assert( checkFormat( "%p %p\n", TypeList<const char*, char*, const char*>{} ).valid );
+
+/* format strings that do not match the argument types */
+static_assert( !checkFormat( "%d\n", TypeList<const char*, const char*>{} ).valid );
+static_assert( !checkFormat( "%d\n", TypeList<const char*, long long>{} ).valid );
+static_assert( !checkFormat( "%hhu\n", TypeList<const char*, int>{} ).valid );
+static_assert( !checkFormat( "%s\n", TypeList<const char*, int>{} ).valid );
+static_assert( !checkFormat( "%p\n", TypeList<const char*, int>{} ).valid );
+static_assert( !checkFormat( "%f\n", TypeList<const char*, int>{} ).valid );
+static_assert( !checkFormat( "%Lf\n", TypeList<const char*, double>{} ).valid );
+static_assert( !checkFormat( "%*d\n", TypeList<const char*, long long, int>{} ).valid );
+static_assert( !checkFormat( "%n\n", TypeList<const char*, int*>{} ).valid );
+static_assert( !checkFormat( "%d %d\n", TypeList<const char*, int>{} ).valid );
+static_assert( !checkFormat( "%d\n", TypeList<const char*, int, int>{} ).valid );
+static_assert( !checkFormat( "incomplete %", TypeList<const char*>{} ).valid );
+
+/* conversions of the packed arguments */
+static_assert( log_ec::detail::NARROW_SHORT == checkFormat( "%hd\n", TypeList<const char*, short>{} ).narrowing );
+static_assert( ( log_ec::detail::NARROW_PRECISION_ARG << 3U ) == checkFormat( "%.*s\n", TypeList<const char*, int, const char*>{} ).narrowing );
+static_assert( ( log_ec::detail::NARROW_POINTER << 3U ) == checkFormat( "%p %p\n", TypeList<const char*, const void*, char*>{} ).narrowing );
+static_assert( ( log_ec::detail::NARROW_PRECISION << 3U ) == checkFormat( "%d %.4s %s\n", TypeList<const char*, int, char*, const char*>{} ).narrowing );
+
+}  // namespace
+
+/* Public function definitions ----------------------------------------------*/
+
+/**
+ * @brief Write a log message with the C++ front end.
+ *
+ * @return Line number of the log message.
+ */
+extern "C" int testCpp_logMessage( void )
+{
+    int line = __LINE__ + 1;
+    (void)log_info( "%-5s|%04hx|%lld|%c|%*d|%hx|%%\n", "ab", static_cast<unsigned short>( 0xFAU ), -9000000000LL, 'z', 4, 7, static_cast<short>( -1 ) );
+    return line;
+}
+
+/**
+ * @brief Write a log message with string arguments that have a precision, with the C++ front end.
+ *
+ * @param str String of at least 4 characters, which need not be null terminated.
+ * @return Line number of the log message.
+ */
+extern "C" int testCpp_logStringPrecision( const char* str )
+{
+    int line = __LINE__ + 1;
+    (void)log_info( "%.*s|%.2s|%5.1s|%s\n", 4, str, str, str, "end" );
+    return line;
+}
+
+/**
+ * @brief Write a log message with the address of a string, with the C++ front end.
+ *
+ * @param str String, whose address is printed.
+ * @return Line number of the log message.
+ */
+extern "C" int testCpp_logStringAddress( const char* str )
+{
+    int line = __LINE__ + 1;
+    (void)log_info( "%p\n", str );
+    return line;
+}
+
+/**
+ * @brief Write a log message of a logger context with the C++ front end.
+ *
+ * @param context Logger context, or NULL for the default context.
+ * @return Line number of the log message.
+ */
+extern "C" int testCpp_logContextMessage( tLog_context* context )
+{
+    int line = __LINE__ + 1;
+    (void)log_info_ctx( context, "%s|%04hx|%lld\n", "ab", static_cast<unsigned short>( 0xFAU ), -9000000000LL );
+    return line;
+}
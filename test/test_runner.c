@@ -25,10 +25,12 @@
  * IN THE SOFTWARE.
  */
 
+#include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdarg.h>
+#include <inttypes.h>
 #include "log_ec.h"
 
 
@@ -37,8 +39,17 @@
 #define EXPECTED_NUMBER_OF_ARGS 2           /* Expected number of command line arguments, including the executable command */
 #define DEFAULT_EXPECTED_TIMESTAMP 12345U   /* Default timestamp value that is expected to be included in log message */
 #define TEST_BUFFER_SIZE 80U                /* Size in bytes of the test buffer to which log messages are written*/
+#define MMAP_TEST_PATH "log_ec_mmap_test"  /* Prefix of the log files written by the memory-mapped file sink tests, in the working directory */
 #define NEXT_LINE ( __LINE__ + 1 )          /* Line number of the next line */
 
+#if LOG_USE_MINIMAL_PRINTF && LOG_MINIMAL_PRINTF_FLOAT
+#define FIELD_FLOAT_TEXT "36.500"  /* Text of the floating point field value 36.5, in the default LOG_FIELD_FLOAT_FORMAT "%.3f" */
+#elif LOG_USE_MINIMAL_PRINTF
+#define FIELD_FLOAT_TEXT "%.3f"    /* The %f conversion is not supported by the minimal printf formatter */
+#else
+#define FIELD_FLOAT_TEXT "36.5"    /* Text of the floating point field value 36.5, in the default LOG_FIELD_FLOAT_FORMAT "%g" */
+#endif
+
 /**
  * @brief Compare two strings.
  *
@@ -96,19 +107,33 @@ typedef struct {
     tLog_event ev;
     void* data;
     char logMessage[TEST_BUFFER_SIZE];
+#if LOG_USE_MESSAGE_BUFFER
+    char text[TEST_BUFFER_SIZE];
+#endif
 } tCallbackData;
 
 /* Private function declarations --------------------------------------------*/
 
-static void setExpectedTimestamp( uint32_t expectedTimestamp );
-static uint32_t getTimestamp( void );
+static void setExpectedTimestamp( tLog_timestamp expectedTimestamp );
+static tLog_timestamp getTimestamp( void );
 static bool setLockState( bool lock, void* lockData );
+static bool setTimedLockState( bool lock, uint32_t timeout, void* lockData );
+static void advanceWriteIndex( int bytesWritten );
 static void clearLogMessage( void );
 static void clearCallbackData( void );
+static void orderCallbackFunction( tLog_event* ev, void* cbData );
 static void callbackFunction( tLog_event* ev, void* cbData );
 static void altCallbackFunction( tLog_event* ev, void* cbData );
 
+/* Function of the C++ front end tests, defined in test_cpp.cpp */
+int testCpp_logMessage( void );
+int testCpp_logContextMessage( tLog_context* context );
+int testCpp_logStringPrecision( const char* str );
+int testCpp_logStringAddress( const char* str );
+
+#if LOG_COMPILE_LEVEL <= 0
 static int test_log_trace_messageFormat( void );
+#endif
 static int test_log_debug_messageFormat( void );
 static int test_log_info_messageFormat( void );
 static int test_log_warn_messageFormat( void );
@@ -116,6 +141,7 @@ static int test_log_error_messageFormat( void );
 static int test_log_fatal_with10DigitTimestamp_messageFormat( void );
 static int test_log_info_withLockFreeShallWriteLogMessage( void );
 static int test_log_info_withLockTakenShallNotWriteLogMessage( void );
+static int test_timedLock_droppedMessagesAreCounted( void );
 static int test_log_off( void );
 static int test_log_on( void );
 static int test_log_setLevel_equalLevelIsPrinted( void );
@@ -131,13 +157,163 @@ static int test_register_overwrite( void );
 static int test_thirdSubcriptionShallFail( void );
 static int test_unsubscribeCallback1_subscribeCallback3( void );
 static int test_unsubscribeCallback2_subscribeCallback3( void );
+static int test_log_discard( void );
+#if LOG_COMPILE_LEVEL > 0
+static int countCall( void );
+static int test_compileLevel_macroIsStripped( void );
+#endif
+static int test_suppressedMessageShallNotReadTimestamp( void );
+static int test_logOffWithoutCallbacksDisablesAllLevels( void );
+static int test_callbackBelowConsoleLevelShallBeInvoked( void );
+static int test_callbacksShallBeInvokedInLevelOrder( void );
+static int test_registrationShallTakeTheLock( void );
+static int test_cpp_logMessageIsWritten( void );
+static int test_cpp_contextLogMessageIsWritten( void );
+#if LOG_USE_ASYNC
+static int test_async_messageIsPrintedByDrain( void );
+static int test_async_messageIsQueuedWhenLockIsTaken( void );
+static int test_async_messageIsDroppedWhenQueueIsFull( void );
+#endif
+static int test_log_prefix_matchesPrintfFormat( void );
+static int test_log_prefix_longFilenameIsNotTruncated( void );
+static int test_timestampDivisor_scalesPrintedTimestamp( void );
+#if LOG_TIMESTAMP_64
+static int test_timestamp64_isPrintedInFull( void );
+#if LOG_USE_RATELIMIT
+static int test_timestamp64_ratelimitIntervalIsNotTruncated( void );
+#endif
+#endif
+#if LOG_USE_CYCLE_COUNTER
+static int test_cycleCounter_timestampIsReadWithoutTimestampFn( void );
+#endif
+#if LOG_USE_MINIMAL_PRINTF
+static int compareWithPrintf( size_t size, const char* format, ... ) LOG_PRINTF_FORMAT( 2, 3 );
+static int test_minimalPrintf_integerConversions( void );
+static int test_minimalPrintf_stringAndCharacterConversions( void );
+#if LOG_MINIMAL_PRINTF_FLOAT
+static int test_minimalPrintf_floatConversions( void );
+#endif
+#endif
+#if LOG_USE_CONSOLE_WRITE
+static int test_consoleWrite_singleWritePerLogMessage( void );
+static int test_consoleWrite_logMessageIsTruncated( void );
+#endif
+#if LOG_USE_MESSAGE_BUFFER
+static int test_messageBuffer_formattedOnceForConsoleAndCallbacks( void );
+static int test_messageBuffer_textIsTruncated( void );
+#if LOG_LAZY_FORMAT
+static int test_lazyFormat_textIsFormattedOnlyWhenRequested( void );
+#endif
+#endif
+#if LOG_USE_ASYNC && ( LOG_ASYNC_QUEUE_COUNT > 1U )
+static uint32_t getContextId( void );
+static int test_asyncQueues_drainMergesQueuesInTimestampOrder( void );
+static int test_asyncQueues_fullQueueDoesNotBlockOtherContexts( void );
+#endif
+#if LOG_DEFERRED_FORMAT
+static int test_deferred_argumentsAreFormattedByDrain( void );
+static int test_deferred_stringArgumentIsCopied( void );
+static int test_deferred_stringArgumentIsCopiedUpToPrecision( void );
+static int test_cpp_packedArgumentsAreQueued( void );
+static int test_cpp_packedStringIsCopiedUpToPrecision( void );
+static int test_cpp_stringAddressIsPackedAsPointer( void );
+#endif
+#if LOG_USE_STRING_TABLE
+static int test_stringTable_siteIsRecorded( void );
+static int test_stringTable_contextSiteIsRecorded( void );
+#endif
+#if LOG_USE_RATELIMIT || LOG_USE_COALESCE || LOG_USE_CRASH_LOG || LOG_USE_STATS || LOG_USE_SAMPLING
+static void countCallbackFunction( tLog_event* ev, void* cbData );
+#endif
+#if LOG_USE_STATS
+static tLog_timestamp getSteppedTimestamp( void );
+static int test_stats_callsAndBytesAreCounted( void );
+static int test_stats_durationsAreCounted( void );
+#endif
+#if LOG_USE_FIELDS
+static int test_fields_textIsWrittenToConsole( void );
+static void fieldsCallbackFunction( tLog_event* ev, void* cbData );
+static int test_fields_typedValuesArePassedToCallbacks( void );
+#if LOG_USE_MESSAGE_BUFFER && LOG_LAZY_FORMAT && !LOG_USE_COALESCE && !LOG_USE_CRASH_LOG
+static void typedFieldsCallbackFunction( tLog_event* ev, void* cbData );
+static int test_fields_textIsFormattedOnlyWhenRequested( void );
+#endif
+#endif
+#if LOG_USE_SPANS
+static int test_spans_beginAndEndRecordsAreWritten( void );
+static int test_spans_scopeEndRecordIsWrittenOnExit( void );
+#if defined( __GNUC__ )
+static int scopedSpanFunction( bool early );
+static void spanCallbackFunction( tLog_event* ev, void* cbData );
+#endif
+#endif
+#if LOG_USE_SAMPLING
+static int test_sampling_everyNthMessageIsWritten( void );
+static void sampledCallSite( int index );
+static int test_sampling_suppressedMessagesAreNotCounted( void );
+#endif
+#if LOG_USE_RATELIMIT
+static void reportCallbackFunction( tLog_event* ev, void* cbData );
+static int test_ratelimit_excessMessagesAreSuppressed( void );
+static int test_ratelimit_suppressedMessagesAreCounted( void );
+#endif
+#if LOG_MAX_MODULES > 1U
+static int test_moduleLevel_overridesGlobalLevel( void );
+static int test_moduleLevel_otherModulesUseGlobalLevel( void );
+#endif
+#if LOG_USE_COALESCE
+static int test_coalesce_repeatsAreCounted( void );
+static int test_coalesce_repeatCountIsWrittenOnTimeout( void );
+#if LOG_USE_ASYNC
+static int test_coalesce_queuedRepeatsAreCountedWithoutLock( void );
+#endif
+#endif
+#if LOG_USE_CRASH_LOG
+static int test_crashLog_recordsAreReplayed( void );
+static int test_crashLog_oldestRecordsAreOverwritten( void );
+#endif
+#if LOG_USE_BATCH_SINK
+static void batchCallback( const tLog_batchEvent* events, size_t count, void* batchData );
+static int test_batchSink_deliveredByCount( void );
+static int test_batchSink_deliveredBySizeAndAge( void );
+static int test_batchSink_deliveredByFlush( void );
+#endif
+#if LOG_USE_CHUNK_OUTPUT
+static bool chunkWrite( const char* chunk, size_t length, void* writeData );
+static int test_chunkOutput_messageIsHandedToDriver( void );
+static int test_chunkOutput_slotIsHeldUntilReleased( void );
+static bool completingChunkWrite( const char* chunk, size_t length, void* writeData );
+static int test_chunkOutput_lengthIsReadBeforeHandingOut( void );
+#endif
+#if LOG_USE_MMAP_SINK
+static size_t readFile( const char* path, char* buffer, size_t size );
+static int test_mmapSink_recordsAreAppended( void );
+static int test_mmapSink_fileIsRotatedBySize( void );
+#endif
+#if LOG_USE_BINARY_SINK
+static void binaryWrite( const uint8_t* record, size_t length, void* writeData );
+static const uint8_t* readVarint( const uint8_t* data, uintmax_t* value );
+static int test_binarySink_recordsAreEncoded( void );
+static int test_binarySink_recordIsTruncated( void );
+#endif
+#if LOG_MAX_CONTEXTS > 0U
+static int test_context_levelAndCallbacksAreSeparate( void );
+static int test_context_lockIsSeparate( void );
+static int test_context_poolIsExhausted( void );
+static int test_context_macroEvaluatesContextOnce( void );
+#if LOG_USE_COALESCE
+static int test_context_repeatsAreCoalescedPerContext( void );
+#endif
+#endif
 
 
 /* Private variable definitions ---------------------------------------------*/
 
 /** @brief List of unit test functions */
 tTestItem m_testList[] = {
+#if LOG_COMPILE_LEVEL <= 0
     { "log_trace message format", test_log_trace_messageFormat },
+#endif
     { "log_debug message format", test_log_debug_messageFormat },
     { "log_info message format", test_log_info_messageFormat },
     { "log_warn message format", test_log_warn_messageFormat },
@@ -145,6 +321,7 @@ tTestItem m_testList[] = {
     { "log_fatal message format with 10 digit timestamp", test_log_fatal_with10DigitTimestamp_messageFormat },
     { "log message shall be written when lock is free", test_log_info_withLockFreeShallWriteLogMessage },
     { "log message shall not be written when lock is taken", test_log_info_withLockTakenShallNotWriteLogMessage },
+    { "log message dropped when the timed lock is not acquired shall be counted", test_timedLock_droppedMessagesAreCounted },
     { "log_off shall disable printing of log messages", test_log_off },
     { "log_on shall enable printing of log messages", test_log_on },
     { "log message at level set by log_setLevel shall be printed", test_log_setLevel_equalLevelIsPrinted },
@@ -159,14 +336,196 @@ tTestItem m_testList[] = {
     { "given callback1 is subscribed the subscription shall be overwritten when resubscribed", test_register_overwrite },
     { "given 2 subscribed callbacks an attempt to subscribe a third callback shall fail", test_thirdSubcriptionShallFail },
     { "given 2 subscribed callbacks when callback1 is unsubscribed callback3 subscription succeeds", test_unsubscribeCallback1_subscribeCallback3 },
-    { "given 2 subscribed callbacks when callback2 is unsubscribed callback3 subscription succeeds", test_unsubscribeCallback2_subscribeCallback3 }
+    { "given 2 subscribed callbacks when callback2 is unsubscribed callback3 subscription succeeds", test_unsubscribeCallback2_subscribeCallback3 },
+    { "log message below LOG_COMPILE_LEVEL shall be discarded", test_log_discard },
+#if LOG_COMPILE_LEVEL > 0
+    { "log_trace below LOG_COMPILE_LEVEL shall be stripped without evaluating its arguments", test_compileLevel_macroIsStripped },
+#endif
+    { "suppressed log message shall not read the timestamp", test_suppressedMessageShallNotReadTimestamp },
+    { "log_off without callbacks shall disable all logging levels", test_logOffWithoutCallbacksDisablesAllLevels },
+    { "callback subscribed below the console logging level shall be invoked", test_callbackBelowConsoleLevelShallBeInvoked },
+    { "callbacks shall be invoked in ascending order of callback logging level", test_callbacksShallBeInvokedInLevelOrder },
+    { "callback registration shall take the lock", test_registrationShallTakeTheLock },
+    { "C++ front end shall write log messages with checked argument types", test_cpp_logMessageIsWritten },
+    { "C++ front end shall write log messages of a logger context with checked argument types", test_cpp_contextLogMessageIsWritten },
+#if LOG_USE_ASYNC
+    { "async log message shall be printed by log_drain", test_async_messageIsPrintedByDrain },
+    { "async log message shall be queued when lock is taken", test_async_messageIsQueuedWhenLockIsTaken },
+    { "async log message shall be dropped when queue is full", test_async_messageIsDroppedWhenQueueIsFull },
+#endif
+    { "log message prefix shall match the printf prefix format", test_log_prefix_matchesPrintfFormat },
+    { "log message prefix shall not truncate a long filename", test_log_prefix_longFilenameIsNotTruncated },
+    { "printed timestamp shall be divided by the timestamp divisor", test_timestampDivisor_scalesPrintedTimestamp },
+#if LOG_TIMESTAMP_64
+    { "64-bit timestamp shall be printed in full", test_timestamp64_isPrintedInFull },
+#if LOG_USE_RATELIMIT
+    { "64-bit rate limit interval shall not be truncated to 32 bits", test_timestamp64_ratelimitIntervalIsNotTruncated },
+#endif
+#endif
+#if LOG_USE_CYCLE_COUNTER
+    { "cycle counter timestamp shall be read without calling the timestamp function", test_cycleCounter_timestampIsReadWithoutTimestampFn },
+#endif
+#if LOG_USE_MINIMAL_PRINTF
+    { "minimal printf integer conversions shall match printf", test_minimalPrintf_integerConversions },
+    { "minimal printf string and character conversions shall match printf", test_minimalPrintf_stringAndCharacterConversions },
+#if LOG_MINIMAL_PRINTF_FLOAT
+    { "minimal printf floating point conversions shall match printf", test_minimalPrintf_floatConversions },
+#endif
+#endif
+#if LOG_USE_CONSOLE_WRITE
+    { "log message prefix and body shall be written with a single console write", test_consoleWrite_singleWritePerLogMessage },
+    { "log message written by console write shall be truncated to the line size", test_consoleWrite_logMessageIsTruncated },
+#endif
+#if LOG_USE_MESSAGE_BUFFER
+    { "log message body shall be formatted once for the console and all callbacks", test_messageBuffer_formattedOnceForConsoleAndCallbacks },
+    { "formatted log message body shall be truncated to the message buffer size", test_messageBuffer_textIsTruncated },
+#if LOG_LAZY_FORMAT
+    { "lazily formatted log message body shall be formatted only when log_eventText is called", test_lazyFormat_textIsFormattedOnlyWhenRequested },
+#endif
+#endif
+#if LOG_USE_ASYNC && ( LOG_ASYNC_QUEUE_COUNT > 1U )
+    { "log_drain shall merge the queues of all contexts in timestamp order", test_asyncQueues_drainMergesQueuesInTimestampOrder },
+    { "full queue of one context shall not block log messages of other contexts", test_asyncQueues_fullQueueDoesNotBlockOtherContexts },
+#endif
+#if LOG_DEFERRED_FORMAT
+    { "deferred log message arguments shall be formatted by log_drain", test_deferred_argumentsAreFormattedByDrain },
+    { "deferred log message string argument shall be copied", test_deferred_stringArgumentIsCopied },
+    { "deferred log message string argument shall be copied up to its precision", test_deferred_stringArgumentIsCopiedUpToPrecision },
+    { "C++ front end arguments shall be packed and queued for log_drain", test_cpp_packedArgumentsAreQueued },
+    { "C++ front end string argument shall be packed up to its precision", test_cpp_packedStringIsCopiedUpToPrecision },
+    { "C++ front end string argument of %p shall be packed as a pointer", test_cpp_stringAddressIsPackedAsPointer },
+#endif
+#if LOG_USE_RATELIMIT
+    { "rate limited call site shall write at most LOG_RATELIMIT_BURST log messages per interval", test_ratelimit_excessMessagesAreSuppressed },
+    { "rate limited call site shall report the number of suppressed log messages", test_ratelimit_suppressedMessagesAreCounted },
+#endif
+#if LOG_USE_SAMPLING
+    { "sampled call site shall write every Nth log message at the sample rate of its level", test_sampling_everyNthMessageIsWritten },
+    { "sampled call site shall not count log messages below the logging level", test_sampling_suppressedMessagesAreNotCounted },
+#endif
+#if LOG_MAX_MODULES > 1U
+    { "module logging level shall override the level set by log_setLevel", test_moduleLevel_overridesGlobalLevel },
+    { "modules without a logging level shall use the level set by log_setLevel", test_moduleLevel_otherModulesUseGlobalLevel },
+#endif
+#if LOG_USE_COALESCE
+    { "identical consecutive log messages shall be counted and the repeat count written on change", test_coalesce_repeatsAreCounted },
+    { "repeat count shall be written when the coalesce timeout elapses or log_flush is called", test_coalesce_repeatCountIsWrittenOnTimeout },
+#if LOG_USE_ASYNC
+    { "queued log messages shall be coalesced without taking the lock", test_coalesce_queuedRepeatsAreCountedWithoutLock },
+#endif
+#endif
+#if LOG_USE_STATS
+    { "statistics shall count calls, suppressed log messages, bytes and callback invocations", test_stats_callsAndBytesAreCounted },
+    { "statistics shall count console write and callback durations in log2 buckets", test_stats_durationsAreCounted },
+#endif
+#if LOG_USE_FIELDS
+    { "structured log message shall be written to the console as key=value text", test_fields_textIsWrittenToConsole },
+    { "callbacks shall receive the typed fields of a structured log message", test_fields_typedValuesArePassedToCallbacks },
+#if LOG_USE_MESSAGE_BUFFER && LOG_LAZY_FORMAT && !LOG_USE_COALESCE && !LOG_USE_CRASH_LOG
+    { "lazily formatted structured log message text shall be formatted only when log_eventText is called", test_fields_textIsFormattedOnlyWhenRequested },
+#endif
+#endif
+#if LOG_USE_SPANS
+    { "span macros shall write begin and end records with the timestamp, filename and line number", test_spans_beginAndEndRecordsAreWritten },
+    { "scoped span shall write its end record when the scope is left", test_spans_scopeEndRecordIsWrittenOnExit },
+#endif
+#if LOG_USE_CRASH_LOG
+    { "crash log records shall be replayed by log_recoverCrashLog with their original timestamps", test_crashLog_recordsAreReplayed },
+    { "crash log shall hold the most recent LOG_CRASH_LOG_LENGTH log messages", test_crashLog_oldestRecordsAreOverwritten },
+#endif
+#if LOG_USE_BATCH_SINK
+    { "batch sink shall deliver the batch when it holds maxEvents log messages", test_batchSink_deliveredByCount },
+    { "batch sink shall deliver the batch when it is full or expired", test_batchSink_deliveredBySizeAndAge },
+    { "log_flush shall deliver the accumulated log messages", test_batchSink_deliveredByFlush },
+#endif
+#if LOG_USE_CHUNK_OUTPUT
+    { "log_drain shall hand each queued log message to the chunk write function", test_chunkOutput_messageIsHandedToDriver },
+    { "queue slot shall not be reused until all chunk references are released", test_chunkOutput_slotIsHeldUntilReleased },
+    { "drained length shall not be read from a chunk released by the driver", test_chunkOutput_lengthIsReadBeforeHandingOut },
+#endif
+#if LOG_USE_STRING_TABLE
+    { "call site table shall record the filename, line number and format string of each log message", test_stringTable_siteIsRecorded },
+    { "call site table shall record the log messages of a logger context", test_stringTable_contextSiteIsRecorded },
+#endif
+#if LOG_USE_BINARY_SINK
+    { "binary sink shall encode a sync record and log message records", test_binarySink_recordsAreEncoded },
+    { "binary sink record shall be truncated to LOG_BINARY_RECORD_SIZE", test_binarySink_recordIsTruncated },
+#endif
+#if LOG_USE_MMAP_SINK
+    { "memory-mapped file sink shall append log messages in the console format", test_mmapSink_recordsAreAppended },
+    { "memory-mapped file sink shall rotate the log file when the next log message does not fit", test_mmapSink_fileIsRotatedBySize },
+#endif
+#if LOG_MAX_CONTEXTS > 0U
+    { "logger context shall have its own logging level and callbacks", test_context_levelAndCallbacksAreSeparate },
+    { "logger context shall not be blocked by the lock of the default context", test_context_lockIsSeparate },
+    { "log_createContext shall return NULL when LOG_MAX_CONTEXTS contexts have been allocated", test_context_poolIsExhausted },
+    { "logger context argument of the context logging macros shall be evaluated once", test_context_macroEvaluatesContextOnce },
+#if LOG_USE_COALESCE
+    { "logger contexts shall coalesce their log messages separately", test_context_repeatsAreCoalescedPerContext },
+#endif
+#endif
 };
 
 /** Number of test cases */
 const size_t m_testListLength = sizeof( m_testList ) / sizeof( m_testList[0U] );
 
 /** Expected timestamp value */
-uint32_t m_timestamp = 0U;
+tLog_timestamp m_timestamp = 0U;
+
+/** Number of times the timestamp function has been called */
+size_t m_timestampReadCount = 0U;
+
+#if LOG_USE_CYCLE_COUNTER
+/** Number of times the cycle counter has been read */
+size_t m_cycleCounterReadCount = 0U;
+#endif
+
+/** Number of times a log message body has been formatted by LOG_VSNPRINTF() */
+size_t m_formatCount = 0U;
+
+#if LOG_USE_COLOR
+/** ANSI colour escape codes of the logging levels */
+static const char* m_levelColors[] = { "\x1b[94m", "\x1b[36m", "\x1b[32m", "\x1b[33m", "\x1b[31m", "\x1b[31m" };
+#endif
+
+/** Context ID returned by the context ID function */
+uint32_t m_contextId = 0U;
+
+/** Number of times a log message has been written by CONSOLE_WRITE() */
+size_t m_consoleWriteCount = 0U;
+
+#if LOG_USE_BATCH_SINK
+/** Number of batches delivered to batchCallback() */
+size_t m_batchCount = 0U;
+
+/** Number of log messages of the last batch delivered to batchCallback() */
+size_t m_batchEventCount = 0U;
+
+/** Log message bodies of the last batch delivered to batchCallback(), separated by '|' */
+char m_batchText[TEST_BUFFER_SIZE];
+#endif
+
+#if LOG_USE_CHUNK_OUTPUT
+/** Chunks accepted by the chunk write function */
+const char* m_chunks[LOG_ASYNC_QUEUE_LENGTH];
+
+/** Number of chunks accepted by the chunk write function */
+size_t m_chunkCount = 0U;
+
+/** Flag that indicates the chunk write function shall reject chunks, i.e. the driver is busy */
+bool m_chunkDriverBusy = false;
+
+/** Number of characters of the chunks accepted by the chunk write function */
+size_t m_chunkBytes = 0U;
+#endif
+
+#if LOG_USE_BINARY_SINK
+/** Buffer to which binary log records are written */
+uint8_t m_binaryRecords[2U * LOG_BINARY_RECORD_SIZE];
+
+/** Number of bytes written to m_binaryRecords */
+size_t m_binaryRecordsLength = 0U;
+#endif
 
 /** Test buffer to which log messages are written */
 char m_logMessage[TEST_BUFFER_SIZE] = { '\0'};
@@ -177,6 +536,9 @@ size_t m_logMessageWriteIndex = 0U;
 /** Mock mutex state variable */
 bool m_logIsLocked = false;
 
+/** Timeout passed to the timed lock function when it last acquired the lock */
+uint32_t m_lockTimeout = 0U;
+
 /** callback1 data  */
 tCallbackData m_callback1Data;
 
@@ -186,6 +548,14 @@ tCallbackData m_callback2Data;
 /** callback3 data  */
 tCallbackData m_callback3Data;
 
+/** Names of the callbacks invoked by orderCallbackFunction(), in invocation order */
+char m_callbackOrder[8];
+
+#if LOG_USE_FIELDS
+/** Number of fields of the last log message passed to fieldsCallbackFunction() */
+size_t m_fieldCount = 0U;
+#endif
+
 /* Public function definitions ----------------------------------------------*/
 
 /**
@@ -233,7 +603,7 @@ int testPrintf( const char* format, ...)
     va_start( arg, format );
     size_t freeSpace = TEST_BUFFER_SIZE - m_logMessageWriteIndex;
     int bytesWritten = vsnprintf( &m_logMessage[m_logMessageWriteIndex], freeSpace , format, arg );
-    m_logMessageWriteIndex += bytesWritten;
+    advanceWriteIndex( bytesWritten );
     va_end( arg );
     return bytesWritten;
 }
@@ -242,10 +612,39 @@ int testVprintf( const char* format, va_list arg)
 {
     size_t freeSpace = TEST_BUFFER_SIZE - m_logMessageWriteIndex;
     int bytesWritten = vsnprintf( &m_logMessage[m_logMessageWriteIndex], freeSpace, format, arg );
-    m_logMessageWriteIndex += bytesWritten;
+    advanceWriteIndex( bytesWritten );
     return bytesWritten;
 }
 
+int testVsnprintf( char* buffer, size_t size, const char* format, va_list arg)
+{
+    m_formatCount++;
+#if LOG_USE_MINIMAL_PRINTF
+    return log_vsnprintf( buffer, size, format, arg );
+#else
+    return vsnprintf( buffer, size, format, arg );
+#endif
+}
+
+#if LOG_USE_CYCLE_COUNTER
+uint64_t testCycleCounter( void )
+{
+    m_cycleCounterReadCount++;
+    return m_timestamp;
+}
+#endif
+
+#if LOG_USE_CONSOLE_WRITE
+int testWrite( const char* buffer, size_t length )
+{
+    m_consoleWriteCount++;
+    size_t freeSpace = TEST_BUFFER_SIZE - m_logMessageWriteIndex - 1U;
+    memcpy( &m_logMessage[m_logMessageWriteIndex], buffer, ( length < freeSpace ) ? length : freeSpace );
+    advanceWriteIndex( (int)length );
+    return (int)length;
+}
+#endif
+
 
 /* Private function definitions ---------------------------------------------*/
 
@@ -254,7 +653,7 @@ int testVprintf( const char* format, va_list arg)
  * 
  * @param expectedTimestamp Expected timestamp value.
  */
-static void setExpectedTimestamp( uint32_t expectedTimestamp )
+static void setExpectedTimestamp( tLog_timestamp expectedTimestamp )
 {
     m_timestamp = expectedTimestamp;
 }
@@ -264,8 +663,9 @@ static void setExpectedTimestamp( uint32_t expectedTimestamp )
  *
  * @return timestamp value
  */
-static uint32_t getTimestamp( void )
+static tLog_timestamp getTimestamp( void )
 {
+    m_timestampReadCount++;
     return m_timestamp;
 }
 
@@ -302,6 +702,39 @@ static bool setLockState( bool lock, void* lockData )
     return success;
 }
 
+/**
+ * @brief Timed log lock function, which records the timeout and mocks a mutex like setLockState().
+ *
+ * @param lock true to acquire the mutex that enables printing of log messages, false to release the mutex.
+ * @param timeout Maximum time to wait to acquire the mutex.
+ * @param lockData Pointer to the lock state.
+ *
+ * @return true if the mutex was successfully acquired or released, or false on failure.
+ */
+static bool setTimedLockState( bool lock, uint32_t timeout, void* lockData )
+{
+    if( lock )
+    {
+        m_lockTimeout = timeout;
+    }
+    return setLockState( lock, lockData );
+}
+
+/**
+ * @brief Advance the test buffer write index, without overrunning the buffer if
+ *        the log message has been truncated.
+ *
+ * @param bytesWritten Number of characters written to the test buffer, excluding the null terminator.
+ */
+static void advanceWriteIndex( int bytesWritten )
+{
+    m_logMessageWriteIndex += bytesWritten;
+    if( m_logMessageWriteIndex >= TEST_BUFFER_SIZE )
+    {
+        m_logMessageWriteIndex = TEST_BUFFER_SIZE - 1U;
+    }
+}
+
 /**
  * @brief Clear the log message buffer.
  */
@@ -342,11 +775,30 @@ static void callbackFunction( tLog_event* ev, void* cbData )
     /* Get reference to the registered callback data object */
     tCallbackData* callbackData = cbData;
 
+#if LOG_USE_MESSAGE_BUFFER
+    snprintf( callbackData->text, sizeof( callbackData->text ), "%s", log_eventText( ev, NULL ) );  /* before ev->ap is read */
+#endif
     callbackData->ev = *ev;
     callbackData->data = cbData;
     vsnprintf( callbackData->logMessage, sizeof( callbackData->logMessage ), ev->fmt, ev->ap );
 }
 
+/**
+ * @brief Callback function that records the order in which callbacks are invoked.
+ *
+ * @param ev Pointer to logging event data.
+ * @param cbData Pointer to the single character name of the callback.
+ */
+static void orderCallbackFunction( tLog_event* ev, void* cbData )
+{
+    (void) ev;
+    size_t length = strlen( m_callbackOrder );
+    if( length < ( sizeof( m_callbackOrder ) - 1U ) )
+    {
+        m_callbackOrder[length] = *(const char*)cbData;
+    }
+}
+
 /**
  * @brief Alternative callback function used for tests of logging callbacks.
  *
@@ -362,6 +814,7 @@ static void altCallbackFunction( tLog_event* ev, void* cbData )
 
 /* Test cases ---------------------------------------------------------------*/
 
+#if LOG_COMPILE_LEVEL <= 0
 /**
  * @brief Verify the format of log messages printed by log_trace() macro.
  *
@@ -381,6 +834,7 @@ static int test_log_trace_messageFormat( void )
     result |= TEST_ASSERT_EQUAL_INT( expectedMsgLen, msgLen );
     return result;
 }
+#endif
 
 /**
  * @brief Verify the format of log messages printed by log_debug() macro.
@@ -499,8 +953,8 @@ static int test_log_info_withLockFreeShallWriteLogMessage( void )
     m_logIsLocked = false;  /* lock is free */
 
     // UUT
-    sprintf( expectedLogMessage, "   12345 TRACE test_runner.c:%u: testValue is 48\n", NEXT_LINE );
-    int msgLen = log_trace( "testValue is %d\n", testValue );
+    sprintf( expectedLogMessage, "   12345 INFO  test_runner.c:%u: testValue is 48\n", NEXT_LINE );
+    int msgLen = log_info( "testValue is %d\n", testValue );
 
     int result = TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
     int expectedMsgLen = strlen( expectedLogMessage );
@@ -524,7 +978,7 @@ static int test_log_info_withLockTakenShallNotWriteLogMessage( void )
     m_logIsLocked = true;  /* Simulate lock acquisition by another thread */
 
     // UUT
-    int msgLen = log_trace( "testValue is %d\n", testValue );
+    int msgLen = log_info( "testValue is %d\n", testValue );
 
     int result = TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );  /* empty message buffer */
     result |= TEST_ASSERT_EQUAL_INT( expectedMsgLen, msgLen );
@@ -532,6 +986,42 @@ static int test_log_info_withLockTakenShallNotWriteLogMessage( void )
 }
 
 
+/**
+ * @brief The timed lock function shall be called with the lock timeout, and a
+ *        log message that is dropped because the lock is not acquired shall be
+ *        counted at its logging level.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_timedLock_droppedMessagesAreCounted( void )
+{
+    log_setTimedLockFn( setTimedLockState, &m_logIsLocked );
+    log_setLockTimeout( 5U );
+    m_logIsLocked = false;  /* lock is free */
+
+    // UUT
+    int result = ( log_info( "written\n" ) > 0 ) ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_INT( 5U, m_lockTimeout );
+    result |= m_logIsLocked ? 1 : 0;  /* lock has been released */
+
+    log_setLockTimeout( 0U );
+    m_logIsLocked = true;  /* Simulate lock acquisition by another thread */
+    result |= TEST_ASSERT_EQUAL_INT( 0, log_warn( "dropped %d\n", 1 ) );
+    result |= TEST_ASSERT_EQUAL_INT( 0, log_warn( "dropped %d\n", 2 ) );
+    result |= TEST_ASSERT_EQUAL_INT( 0, log_error( "dropped %d\n", 3 ) );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, m_lockTimeout );
+
+    tLog_stats stats;
+    log_getStats( &stats );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, stats.dropped[LOG_INFO] );
+    result |= TEST_ASSERT_EQUAL_INT( 2U, stats.dropped[LOG_WARN] );
+    result |= TEST_ASSERT_EQUAL_INT( 1U, stats.dropped[LOG_ERROR] );
+    result |= TEST_ASSERT_EQUAL_INT( 3U, stats.lockFailures );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, stats.queueFull );
+    return result;
+}
+
+
 /**
  * @brief Verify that calling log_off() disables writing of log messages to the console.
  *
@@ -930,3 +1420,2340 @@ static int test_unsubscribeCallback2_subscribeCallback3( void )
     result |= TEST_ASSERT_EQUAL_STRING( "test_runner.c", m_callback3Data.ev.file );
     return result;
 }
+
+/**
+ * @brief A log message that is discarded because it is below LOG_COMPILE_LEVEL
+ * shall not be printed, shall not evaluate its arguments and shall return 0.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_log_discard( void )
+{
+    int testValue = 48;
+    char expectedLogMessage[80] = { '\0'};
+    int expectedMsgLen = 0;
+
+    // UUT
+    int msgLen = LOG_DISCARD( "testValue is %d\n", testValue++ );
+
+    int result = TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );    /* empty message buffer */
+    result |= TEST_ASSERT_EQUAL_INT( expectedMsgLen, msgLen );
+    result |= TEST_ASSERT_EQUAL_INT( 48, testValue );
+    return result;
+}
+
+#if LOG_COMPILE_LEVEL > 0
+/**
+ * @brief Function with a side effect, which counts its calls.
+ *
+ * @return Number of calls.
+ */
+static int countCall( void )
+{
+    static int count = 0;
+    return ++count;
+}
+
+/**
+ * @brief log_trace() and log_trace_ctx() below LOG_COMPILE_LEVEL shall be 
+ * removed by the preprocessor: they shall not be written to the console or the
+ * callbacks, even though the runtime levels would write them, their arguments 
+ * shall not be evaluated, the logger context shall count as used, and they 
+ * shall evaluate to 0.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_compileLevel_macroIsStripped( void )
+{
+    log_setLevel( LOG_TRACE );
+    int result = log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_TRACE ) ? 0 : 1;
+
+    tLog_context* traceContext = log_getDefaultContext();  /* only used by a stripped macro */
+
+    // UUT
+    int msgLen = log_trace( "count is %d\n", countCall() );
+    msgLen |= log_trace_ctx( traceContext, "count is %d\n", countCall() );
+
+    result |= TEST_ASSERT_EQUAL_INT( 0, msgLen );
+    result |= TEST_ASSERT_EQUAL_STRING( "", m_logMessage );
+    result |= TEST_ASSERT_EQUAL_STRING( "", m_callback1Data.logMessage );
+    result |= TEST_ASSERT_EQUAL_INT( 1, countCall() );  /* first call */
+    result |= ( log_info( "count is %d\n", countCall() ) > 0 ) ? 0 : 1;  /* above LOG_COMPILE_LEVEL */
+    result |= TEST_ASSERT_EQUAL_STRING( "count is 2\n", m_callback1Data.logMessage );
+    return result;
+}
+#endif
+
+/**
+ * @brief A log message below the logging level of the console and of all
+ * callbacks shall be suppressed before the timestamp function is called.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_suppressedMessageShallNotReadTimestamp( void )
+{
+    char expectedLogMessage[80] = { '\0'};
+    int expectedMsgLen = 0;
+    m_timestampReadCount = 0U;
+
+    // UUT
+    log_setLevel( LOG_WARN );  /* Set the logging level */
+    int msgLen = log_info( "This message is not expected to be printed\n" );
+
+    int result = TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );    /* empty message buffer */
+    result |= TEST_ASSERT_EQUAL_INT( expectedMsgLen, msgLen );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, m_timestampReadCount );
+    return result;
+}
+
+/**
+ * @brief When console logging is disabled and no callbacks are subscribed, log
+ * messages at all levels shall be suppressed by the logging macros.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_logOffWithoutCallbacksDisablesAllLevels( void )
+{
+    // UUT
+    log_off();
+    int result = LOG_IS_ENABLED( LOG_FATAL ) ? 1 : 0;
+
+    log_on();
+    result |= LOG_IS_ENABLED( LOG_TRACE ) ? 0 : 1;
+    return result;
+}
+
+/**
+ * @brief When the console logging level is LOG_WARN and callback1 has been
+ * subscribed with level LOG_DEBUG, then a call to log_debug() shall invoke
+ * callback1 but shall not print to the console.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_callbackBelowConsoleLevelShallBeInvoked( void )
+{
+    int testValue = 1024;
+    char expectedLogMessage[80] = { '\0'};
+    sprintf( expectedLogMessage, "testValue is 1024\n" );
+
+    // UUT
+    log_setLevel( LOG_WARN );
+    int result = log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_DEBUG ) ? 0 : 1;
+    int msgLen = log_debug( "testValue is %d\n", testValue );
+
+    result |= TEST_ASSERT_EQUAL_INT( 0, msgLen );
+    result |= TEST_ASSERT_EQUAL_STRING( "", m_logMessage );    /* empty message buffer */
+    result |= TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_callback1Data.logMessage );
+    result |= TEST_ASSERT_EQUAL_INT( LOG_DEBUG, m_callback1Data.ev.level );
+    return result;
+}
+
+/**
+ * @brief Given callback 'a' subscribed with level LOG_INFO and callback 'b' 
+ * subscribed with level LOG_TRACE, a call to log_warn() shall invoke callback 
+ * 'b' before callback 'a', regardless of the order of subscription. After 
+ * callback 'b' is unsubscribed, only callback 'a' shall be invoked.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_callbacksShallBeInvokedInLevelOrder( void )
+{
+    static char nameA = 'a';
+    static char nameB = 'b';
+    memset( m_callbackOrder, 0, sizeof( m_callbackOrder ) );
+
+    // UUT
+    int result = log_registerCallbackFn( orderCallbackFunction, &nameA, LOG_INFO ) ? 0 : 1;
+    result |= log_registerCallbackFn( orderCallbackFunction, &nameB, LOG_TRACE ) ? 0 : 1;
+    log_warn( "level order" );
+    result |= TEST_ASSERT_EQUAL_STRING( "ba", m_callbackOrder );
+
+    memset( m_callbackOrder, 0, sizeof( m_callbackOrder ) );
+    log_unregisterCallbackFn( orderCallbackFunction, &nameB );
+    log_warn( "level order" );
+    result |= TEST_ASSERT_EQUAL_STRING( "a", m_callbackOrder );
+    return result;
+}
+
+/**
+ * @brief Registration and unregistration of a callback shall take and release
+ * the lock, waiting without a timeout for a timed lock, and shall not change
+ * the registrations when the lock is not acquired.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_registrationShallTakeTheLock( void )
+{
+    log_setTimedLockFn( setTimedLockState, &m_logIsLocked );
+    log_setLockTimeout( 0U );
+
+    // UUT
+    int result = log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_INFO ) ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_INT( LOG_LOCK_WAIT_FOREVER, m_lockTimeout );
+    result |= m_logIsLocked ? 1 : 0;  /* the lock is released */
+
+    m_logIsLocked = true;  /* Simulate lock acquisition by another thread */
+    result |= log_registerCallbackFn( callbackFunction, &m_callback2Data, LOG_INFO ) ? 1 : 0;
+    log_unregisterCallbackFn( callbackFunction, &m_callback1Data );
+    m_logIsLocked = false;
+
+    log_info( "registered\n" );
+    result |= TEST_ASSERT_EQUAL_STRING( "registered\n", m_callback1Data.logMessage );
+    result |= TEST_ASSERT_EQUAL_STRING( "", m_callback2Data.logMessage );
+    return result;
+}
+
+#if LOG_USE_ASYNC
+/**
+ * @brief When asynchronous logging is enabled, a log message shall not be
+ * printed until log_drain() is called.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_async_messageIsPrintedByDrain( void )
+{
+    int testValue = 48;
+    char expectedLogMessage[80] = { '\0'};
+    log_setAsync( true );
+
+    // UUT
+    sprintf( expectedLogMessage, "   12345 INFO  test_runner.c:%u: testValue is 48\n", NEXT_LINE );
+    int msgLen = log_info( "testValue is %d\n", testValue );
+
+    int result = TEST_ASSERT_EQUAL_STRING( "", m_logMessage );    /* empty message buffer */
+#if LOG_DEFERRED_FORMAT
+    result |= TEST_ASSERT_EQUAL_INT( sizeof( int32_t ), msgLen );  /* 1 packed int argument */
+#else
+    result |= TEST_ASSERT_EQUAL_INT( strlen( "testValue is 48\n" ), msgLen );
+#endif
+
+    int drainLen = log_drain();
+    result |= TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+    result |= TEST_ASSERT_EQUAL_INT( strlen( expectedLogMessage ), drainLen );
+    result |= TEST_ASSERT_EQUAL_INT( 0, log_drain() );  /* queue is empty */
+    return result;
+}
+
+/**
+ * @brief When asynchronous logging is enabled, a log message shall be queued
+ * even if the lock cannot be acquired, e.g. in ISR context, and shall not be
+ * counted as dropped when it cannot be passed to the callbacks.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_async_messageIsQueuedWhenLockIsTaken( void )
+{
+    int testValue = 48;
+    char expectedLogMessage[80] = { '\0'};
+    log_setLockFn( setLockState, &m_logIsLocked );
+    int result = log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_TRACE ) ? 0 : 1;
+    m_logIsLocked = true;  /* Simulate lock acquisition by another thread */
+    log_setAsync( true );
+
+    // UUT
+    sprintf( expectedLogMessage, "   12345 WARN  test_runner.c:%u: testValue is 48\n", NEXT_LINE );
+    log_warn( "testValue is %d\n", testValue );
+    log_drain();
+
+    result |= TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+    result |= TEST_ASSERT_EQUAL_STRING( "", m_callback1Data.logMessage );
+    tLog_stats stats;
+    log_getStats( &stats );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, stats.dropped[LOG_WARN] );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, stats.lockFailures );
+    result |= TEST_ASSERT_EQUAL_INT( 1U, stats.callbackLockFailures );
+    return result;
+}
+
+/**
+ * @brief When asynchronous logging is enabled and the queue is full, a log
+ * message shall be dropped, and queueing shall resume after log_drain().
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_async_messageIsDroppedWhenQueueIsFull( void )
+{
+    int result = 0;
+    log_setAsync( true );
+
+    // UUT
+    for( size_t i = 0U; i < LOG_ASYNC_QUEUE_LENGTH; i++ )
+    {
+        result |= ( log_info( "message %u\n", (unsigned int)i ) >= 0 ) ? 0 : 1;
+    }
+    result |= TEST_ASSERT_EQUAL_INT( -1, log_info( "dropped\n" ) );
+    tLog_stats stats;
+    log_getStats( &stats );
+    result |= TEST_ASSERT_EQUAL_INT( 1U, stats.queueFull );
+    result |= TEST_ASSERT_EQUAL_INT( 1U, stats.dropped[LOG_INFO] );
+
+    log_drain();
+    result |= ( log_info( "queued\n" ) >= 0 ) ? 0 : 1;
+    return result;
+}
+#endif
+
+#if LOG_USE_ASYNC && ( LOG_ASYNC_QUEUE_COUNT > 1U )
+/**
+ * @brief Custom context ID function that returns a known context ID when running tests.
+ *
+ * @return context ID
+ */
+static uint32_t getContextId( void )
+{
+    return m_contextId;
+}
+
+/**
+ * @brief When there are multiple asynchronous logging queues, log_drain() shall
+ * print the log messages of all contexts in timestamp order.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_asyncQueues_drainMergesQueuesInTimestampOrder( void )
+{
+    log_setContextIdFn( getContextId );
+    log_setAsync( true );
+
+    // UUT
+    m_contextId = 1U;
+    setExpectedTimestamp( 20U );
+    log_log( LOG_INFO, "f", 1, "b\n" );
+    m_contextId = 0U;
+    setExpectedTimestamp( 10U );
+    log_log( LOG_INFO, "f", 1, "a\n" );
+    m_contextId = 1U;
+    setExpectedTimestamp( 30U );
+    log_log( LOG_INFO, "f", 1, "c\n" );
+    log_drain();
+
+    int result = TEST_ASSERT_EQUAL_STRING( "      10 INFO  f:1: a\n      20 INFO  f:1: b\n      30 INFO  f:1: c\n", m_logMessage );
+    log_setContextIdFn( NULL );
+    return result;
+}
+
+/**
+ * @brief When there are multiple asynchronous logging queues, a full queue shall
+ * not prevent other contexts from queueing log messages.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_asyncQueues_fullQueueDoesNotBlockOtherContexts( void )
+{
+    int result = 0;
+    log_setContextIdFn( getContextId );
+    log_setAsync( true );
+
+    // UUT
+    m_contextId = 0U;
+    for( size_t i = 0U; i < LOG_ASYNC_QUEUE_LENGTH; i++ )
+    {
+        result |= ( log_info( "message %u\n", (unsigned int)i ) >= 0 ) ? 0 : 1;
+    }
+    result |= TEST_ASSERT_EQUAL_INT( -1, log_info( "dropped\n" ) );
+    m_contextId = 1U;
+    result |= ( log_info( "queued\n" ) >= 0 ) ? 0 : 1;
+    log_setContextIdFn( NULL );
+    return result;
+}
+#endif
+
+#if LOG_DEFERRED_FORMAT
+/**
+ * @brief When deferred formatting is enabled, printf arguments of different 
+ * types shall be packed by the logging macro and formatted by log_drain().
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_deferred_argumentsAreFormattedByDrain( void )
+{
+    char expectedLogMessage[80] = { '\0'};
+    log_setAsync( true );
+
+    // UUT
+    sprintf( expectedLogMessage, "   12345 INFO  test_runner.c:%u: ab   |00fa|-9000000000|z|   7|%%\n", NEXT_LINE );
+    log_info( "%-5s|%04hx|%lld|%c|%*d|%%\n", "ab", (unsigned short)0xFA, -9000000000LL, 'z', 4, 7 );
+    log_drain();
+
+    int result = TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+
+#if !LOG_USE_MINIMAL_PRINTF || LOG_MINIMAL_PRINTF_FLOAT
+    /* the minimal printf formatter only formats floating-point values if LOG_MINIMAL_PRINTF_FLOAT is set */
+    clearLogMessage();
+    sprintf( expectedLogMessage, "   12345 INFO  test_runner.c:%u: 2.50|-1\n", NEXT_LINE );
+    log_info( "%.2f|%d\n", 2.5, -1 );
+    log_drain();
+
+    result |= TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+#endif
+    return result;
+}
+
+/**
+ * @brief When deferred formatting is enabled, a string argument shall be 
+ * copied into the queue, so that it may be modified before log_drain().
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_deferred_stringArgumentIsCopied( void )
+{
+    char testValue[16] = "original";
+    char expectedLogMessage[80] = { '\0'};
+    log_setAsync( true );
+
+    // UUT
+    sprintf( expectedLogMessage, "   12345 INFO  test_runner.c:%u: testValue is original\n", NEXT_LINE );
+    log_info( "testValue is %s\n", testValue );
+    strcpy( testValue, "modified" );
+    log_drain();
+
+    int result = TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+    return result;
+}
+
+/**
+ * @brief When deferred formatting is enabled, no more characters of a string
+ * argument than its precision shall be read, so that a string that is not null
+ * terminated can be logged with "%.*s".
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_deferred_stringArgumentIsCopiedUpToPrecision( void )
+{
+    char* testValue = malloc( 4U );  /* heap allocation, so that ASan detects reads past its end */
+    memcpy( testValue, "abcd", 4U );
+    char expectedLogMessage[80] = { '\0'};
+    log_setAsync( true );
+
+    // UUT
+    sprintf( expectedLogMessage, "   12345 INFO  test_runner.c:%u: testValue is abcd|ab\n", NEXT_LINE );
+    log_info( "testValue is %.*s|%.2s\n", 4, testValue, testValue );
+    free( testValue );
+    log_drain();
+
+    int result = TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+    return result;
+}
+
+/**
+ * @brief When deferred formatting is enabled, the arguments of a log message 
+ * of the C++ front end shall be packed without a va_list and queued, and 
+ * formatted by log_drain().
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_cpp_packedArgumentsAreQueued( void )
+{
+    char expectedLogMessage[TEST_BUFFER_SIZE] = { '\0'};
+    log_setAsync( true );
+
+    // UUT
+    int line = testCpp_logMessage();
+    int result = TEST_ASSERT_EQUAL_STRING( "", m_logMessage );  /* queued, not yet printed */
+    log_drain();
+
+    sprintf( expectedLogMessage, "   12345 INFO  test_cpp.cpp:%d: ab   |00fa|-9000000000|z|   7|ffff|%%\n", line );
+    result |= TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+    return result;
+}
+
+/**
+ * @brief When deferred formatting is enabled, the C++ front end shall pack no
+ * more characters of a string argument than its precision, so that a string 
+ * that is not null terminated can be logged with "%.*s" or "%.4s".
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_cpp_packedStringIsCopiedUpToPrecision( void )
+{
+    char* testValue = malloc( 4U );  /* heap allocation, so that ASan detects reads past its end */
+    memcpy( testValue, "abcd", 4U );
+    char expectedLogMessage[TEST_BUFFER_SIZE] = { '\0'};
+    log_setAsync( true );
+
+    // UUT
+    int line = testCpp_logStringPrecision( testValue );
+    free( testValue );
+    log_drain();
+
+    sprintf( expectedLogMessage, "   12345 INFO  test_cpp.cpp:%d: abcd|ab|    a|end\n", line );
+    int result = TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+    return result;
+}
+
+/**
+ * @brief When deferred formatting is enabled, the C++ front end shall pack a 
+ * pointer to char of a "%p" conversion as a pointer, instead of copying the
+ * string, so that the address of the buffer is printed.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_cpp_stringAddressIsPackedAsPointer( void )
+{
+    const char* testValue = "abcd";
+    char expectedLogMessage[TEST_BUFFER_SIZE] = { '\0'};
+    log_setAsync( true );
+
+    // UUT
+    int line = testCpp_logStringAddress( testValue );
+    log_drain();
+
+    sprintf( expectedLogMessage, "   12345 INFO  test_cpp.cpp:%d: %p\n", line, (const void*)testValue );
+    int result = TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+    return result;
+}
+#endif
+
+#if LOG_USE_MESSAGE_BUFFER
+/**
+ * @brief When the message buffer is enabled and 2 callbacks are subscribed, the
+ * log message body shall be formatted once, and the formatted text shall be 
+ * printed to the console and passed to both callbacks.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_messageBuffer_formattedOnceForConsoleAndCallbacks( void )
+{
+    int testValue = 48;
+    char expectedLogMessage[80] = { '\0'};
+    m_formatCount = 0U;
+
+    // UUT
+    int result = log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_INFO ) ? 0 : 1;
+    result |= log_registerCallbackFn( callbackFunction, &m_callback2Data, LOG_DEBUG ) ? 0 : 1;
+    sprintf( expectedLogMessage, "   12345 INFO  test_runner.c:%u: testValue is 48\n", NEXT_LINE );
+    int msgLen = log_info( "testValue is %d\n", testValue );
+
+    result |= TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+    result |= TEST_ASSERT_EQUAL_INT( strlen( expectedLogMessage ), msgLen );
+    result |= TEST_ASSERT_EQUAL_STRING( "testValue is 48\n", m_callback1Data.text );
+    result |= TEST_ASSERT_EQUAL_STRING( "testValue is 48\n", m_callback2Data.text );
+    result |= TEST_ASSERT_EQUAL_INT( strlen( "testValue is 48\n" ), m_callback2Data.ev.textLength );
+    result |= TEST_ASSERT_EQUAL_INT( 1U, m_formatCount );
+    return result;
+}
+
+/**
+ * @brief When the message buffer is enabled, a log message body that is longer
+ * than the buffer shall be truncated.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_messageBuffer_textIsTruncated( void )
+{
+    char longValue[LOG_MESSAGE_BUFFER_SIZE + 10U];
+    memset( longValue, 'x', sizeof( longValue ) - 1U );
+    longValue[sizeof( longValue ) - 1U] = '\0';
+
+    // UUT
+    int result = log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_INFO ) ? 0 : 1;
+    log_off();
+    log_info( "%s", longValue );
+
+    result |= TEST_ASSERT_EQUAL_INT( LOG_MESSAGE_BUFFER_SIZE - 1U, m_callback1Data.ev.textLength );
+    result |= TEST_ASSERT_EQUAL_STRING( "", m_logMessage );    /* empty message buffer */
+    return result;
+}
+
+#if LOG_LAZY_FORMAT
+/**
+ * @brief When lazy formatting is enabled, the log message body shall not be 
+ * formatted if no callback calls log_eventText(), and shall be formatted once
+ * for all the callbacks that do.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_lazyFormat_textIsFormattedOnlyWhenRequested( void )
+{
+    int result = log_registerCallbackFn( altCallbackFunction, NULL, LOG_TRACE ) ? 0 : 1;
+    log_off();
+    m_formatCount = 0U;
+
+    // UUT
+    log_info( "not formatted %d\n", 1 );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, m_formatCount );
+
+    log_unregisterCallbackFn( altCallbackFunction, NULL );
+    result |= log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_INFO ) ? 0 : 1;
+    result |= log_registerCallbackFn( callbackFunction, &m_callback2Data, LOG_INFO ) ? 0 : 1;
+    log_warn( "formatted %d\n", 2 );
+    result |= TEST_ASSERT_EQUAL_INT( 1U, m_formatCount );
+    result |= TEST_ASSERT_EQUAL_STRING( "formatted 2\n", m_callback1Data.text );
+    result |= TEST_ASSERT_EQUAL_STRING( "formatted 2\n", m_callback2Data.text );
+    return result;
+}
+#endif
+#endif
+
+/**
+ * @brief The log message prefix, which is formatted without printf(), shall be
+ * identical to the prefix formatted by printf(), for timestamps and line numbers
+ * of 1 to 10 digits.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_log_prefix_matchesPrintfFormat( void )
+{
+    static const uint32_t values[] = { 0U, 7U, 10U, 99U, 100U, 12345U, 9999999U, 99999999U, 100000000U, 4294967295U };
+    static const char* levels[] = { "TRACE", "DEBUG", "INFO", "WARN", "ERROR", "FATAL" };
+    int result = 0;
+    for( size_t i = 0U; i < ( sizeof( values ) / sizeof( values[0] ) ); i++ )
+    {
+        char expectedLogMessage[80] = { '\0'};
+        int level = (int)( i % ( sizeof( levels ) / sizeof( levels[0] ) ) );
+        int line = (int)( values[i] % 1000000U );
+        setExpectedTimestamp( values[i] );
+        clearLogMessage();
+
+        // UUT
+#if LOG_USE_COLOR
+        sprintf( expectedLogMessage, "%8" PRIu32 " %s%-5s\x1b[0m \x1b[90m%s:%d:\x1b[0m x\n", values[i], m_levelColors[level], levels[level], "file.c", line );
+#else
+        sprintf( expectedLogMessage, "%8" PRIu32 " %-5s %s:%d: x\n", values[i], levels[level], "file.c", line );
+#endif
+        int msgLen = log_log( level, "file.c", line, "x\n" );
+
+        result |= TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+        result |= TEST_ASSERT_EQUAL_INT( strlen( expectedLogMessage ), msgLen );
+    }
+    return result;
+}
+
+/**
+ * @brief A filename that is longer than the prefix buffer shall be printed in
+ * full, followed by the line number and the separator.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_log_prefix_longFilenameIsNotTruncated( void )
+{
+#if LOG_USE_COLOR
+    static const char file[] = "a_source_file_with_a_long_name.c";  /* longer than LOG_PREFIX_SIZE with the timestamp, level and escape codes */
+#else
+    static const char file[] = "a_source_file_with_a_long_name_in_the_project.c";  /* longer than LOG_PREFIX_SIZE with the timestamp and level */
+#endif
+    char expectedLogMessage[TEST_BUFFER_SIZE] = { '\0'};
+
+    // UUT
+    int msgLen = log_log( LOG_WARN, file, 4321, "x\n" );
+
+#if LOG_USE_COLOR
+    snprintf( expectedLogMessage, sizeof( expectedLogMessage ), "   12345 %sWARN \x1b[0m \x1b[90m%s:4321:\x1b[0m x\n", m_levelColors[LOG_WARN], file );
+#else
+    snprintf( expectedLogMessage, sizeof( expectedLogMessage ), "   12345 WARN  %s:4321: x\n", file );
+#endif
+    int result = TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+    result |= TEST_ASSERT_EQUAL_INT( strlen( expectedLogMessage ), msgLen );
+    return result;
+}
+
+/**
+ * @brief The printed timestamp shall be divided by the divisor set by 
+ * log_setTimestampDivisor(), and callbacks shall receive the unscaled 
+ * timestamp.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_timestampDivisor_scalesPrintedTimestamp( void )
+{
+    char expectedLogMessage[80] = { '\0'};
+    int result = log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_TRACE ) ? 0 : 1;
+
+    // UUT
+    log_setTimestampDivisor( 1000U );
+    sprintf( expectedLogMessage, "      12 INFO  test_runner.c:%u: scaled\n", NEXT_LINE );
+    int msgLen = log_info( "scaled\n" );
+    log_setTimestampDivisor( 0U );
+
+    result |= TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+    result |= TEST_ASSERT_EQUAL_INT( strlen( expectedLogMessage ), msgLen );
+    result |= TEST_ASSERT_EQUAL_INT( DEFAULT_EXPECTED_TIMESTAMP, m_callback1Data.ev.time );
+    return result;
+}
+
+#if LOG_TIMESTAMP_64
+/**
+ * @brief A 64-bit timestamp shall be printed with all of its digits.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_timestamp64_isPrintedInFull( void )
+{
+    char expectedLogMessage[80] = { '\0'};
+
+    // UUT
+    setExpectedTimestamp( UINT64_MAX );
+    sprintf( expectedLogMessage, "18446744073709551615 WARN  test_runner.c:%u: wide\n", NEXT_LINE );
+    int msgLen = log_warn( "wide\n" );
+
+    int result = TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+    result |= TEST_ASSERT_EQUAL_INT( strlen( expectedLogMessage ), msgLen );
+    return result;
+}
+
+#if LOG_USE_RATELIMIT
+/**
+ * @brief A rate limit interval longer than 2^32 timestamp ticks shall not be
+ * truncated to 32 bits.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_timestamp64_ratelimitIntervalIsNotTruncated( void )
+{
+    tLog_ratelimit ratelimit = { 0 };
+    uint32_t suppressed = 0U;
+    const tLog_timestamp interval = ( (tLog_timestamp)1U << 32 ) + 100U;
+
+    // UUT
+    int result = log_ratelimit( &ratelimit, 1U, interval, &suppressed ) ? 0 : 1;
+    setExpectedTimestamp( DEFAULT_EXPECTED_TIMESTAMP + 200U );
+    result |= log_ratelimit( &ratelimit, 1U, interval, &suppressed ) ? 1 : 0;
+    setExpectedTimestamp( DEFAULT_EXPECTED_TIMESTAMP + interval );
+    result |= log_ratelimit( &ratelimit, 1U, interval, &suppressed ) ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_INT( 1U, suppressed );
+    return result;
+}
+#endif
+#endif
+
+#if LOG_USE_CYCLE_COUNTER
+/**
+ * @brief The cycle counter shall be read instead of the timestamp function.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_cycleCounter_timestampIsReadWithoutTimestampFn( void )
+{
+    int result = log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_TRACE ) ? 0 : 1;
+    m_timestampReadCount = 0U;
+    m_cycleCounterReadCount = 0U;
+    m_timestamp = 1234U;
+
+    // UUT
+    log_enableCycleCounter();
+    log_info( "first\n" );
+
+    result |= TEST_ASSERT_EQUAL_INT( 0U, m_timestampReadCount );
+    result |= ( m_cycleCounterReadCount > 0U ) ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_INT( 1234U, m_callback1Data.ev.time );
+    return result;
+}
+#endif
+
+#if LOG_USE_MINIMAL_PRINTF
+/**
+ * @brief Format a string with both log_vsnprintf() and vsnprintf(), and compare
+ * the results.
+ *
+ * @param size Size of the destination buffer.
+ * @param format printf format string.
+ * @param ... printf variadic arguments.
+ * @return 0 if the formatted strings and return values are identical, 1 if they are different.
+ */
+static int compareWithPrintf( size_t size, const char* format, ... )
+{
+    char expected[TEST_BUFFER_SIZE] = { '\0' };
+    char actual[TEST_BUFFER_SIZE] = { '\0' };
+    va_list arg;
+    va_start( arg, format );
+    int expectedResult = vsnprintf( expected, size, format, arg );
+    va_end( arg );
+    va_start( arg, format );
+    int actualResult = log_vsnprintf( actual, size, format, arg );
+    va_end( arg );
+    int result = ( ( 0 == strcmp( expected, actual ) ) && ( expectedResult == actualResult ) ) ? 0 : 1;
+    if( 0 != result )
+    {
+        printf( "format \"%s\": expected \"%s\" (%d), actual \"%s\" (%d)\n", format, expected, expectedResult, actual, actualResult );
+    }
+    return result;
+}
+
+/**
+ * @brief The minimal printf formatter shall format integer conversions with 
+ * flags, field width, precision and length modifiers identically to printf.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_minimalPrintf_integerConversions( void )
+{
+    int result = compareWithPrintf( TEST_BUFFER_SIZE, "%d %i %u %x %X %o", -42, 42, 42U, 0xbeefU, 0xBEEFU, 8U );
+    result |= compareWithPrintf( TEST_BUFFER_SIZE, "[%5d] [%-5d] [%05d] [%+d] [% d] [%.3d] [%8.3x]", 42, 42, -42, 42, 42, 7, 0xaU );
+    result |= compareWithPrintf( TEST_BUFFER_SIZE, "[%*d] [%-*d] [%*d] [%.*d] [%.0d]", 4, 1, 4, 2, -4, 3, 3, 4, 0 );
+    result |= compareWithPrintf( TEST_BUFFER_SIZE, "%hhd %hu %ld %lu %lld %llx", (signed char)-1, (unsigned short)65535U, -123456789L, 123456789UL, -1234567890123LL, 0xfedcba9876543210ULL );
+    result |= compareWithPrintf( TEST_BUFFER_SIZE, "%zu %jd %td %d %u", sizeof( int ), (intmax_t)INT64_MIN, (ptrdiff_t)-5, INT32_MIN, UINT32_MAX );
+    result |= compareWithPrintf( TEST_BUFFER_SIZE, "%p %% 100%%", (void*)&result );
+    result |= compareWithPrintf( 8U, "truncated %d", 1234567 );  /* return value is the untruncated length */
+    return result;
+}
+
+/**
+ * @brief The minimal printf formatter shall format string and character
+ * conversions identically to printf, and shall read no more characters of a
+ * string than its precision.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_minimalPrintf_stringAndCharacterConversions( void )
+{
+    int result = compareWithPrintf( TEST_BUFFER_SIZE, "%s [%8s] [%-8s] [%.3s] [%*.*s]", "abc", "abc", "abc", "abcdef", 6, 2, "abcdef" );
+    result |= compareWithPrintf( TEST_BUFFER_SIZE, "%c%c%c [%3c] [%-3c]", 'a', 'b', 'c', 'd', 'e' );
+    result |= compareWithPrintf( TEST_BUFFER_SIZE, "no conversions" );
+    result |= compareWithPrintf( 1U, "%s", "empty buffer" );
+    char* unterminated = malloc( 4U );  /* heap allocation, so that ASan detects reads past its end */
+    memcpy( unterminated, "abcd", 4U );
+    result |= compareWithPrintf( TEST_BUFFER_SIZE, "[%.4s] [%.*s]", unterminated, 2, unterminated );
+    free( unterminated );
+    return result;
+}
+
+#if LOG_MINIMAL_PRINTF_FLOAT
+/**
+ * @brief The minimal printf formatter shall format the %f conversion 
+ * identically to printf.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_minimalPrintf_floatConversions( void )
+{
+    int result = compareWithPrintf( TEST_BUFFER_SIZE, "%f %f %f", 3.14159, -2.5, 0.0 );
+    result |= compareWithPrintf( TEST_BUFFER_SIZE, "[%.2f] [%.0f] [%8.3f] [%-8.1f] [%08.2f] [%+.1f]", 1.005, 2.7, 3.14159, 9.96, -1.25, 1.0 );
+    result |= compareWithPrintf( TEST_BUFFER_SIZE, "%.9f %f %.3f", 0.123456789, 123456789.125, 0.9995 );
+    return result;
+}
+#endif
+#endif
+
+#if LOG_USE_CONSOLE_WRITE
+/**
+ * @brief When CONSOLE_WRITE() is defined, the log message prefix and body shall
+ * be written to the console with a single call.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_consoleWrite_singleWritePerLogMessage( void )
+{
+    int testValue = 48;
+    char expectedLogMessage[80] = { '\0'};
+    m_consoleWriteCount = 0U;
+
+    // UUT
+    sprintf( expectedLogMessage, "   12345 WARN  test_runner.c:%u: testValue is 48\n", NEXT_LINE );
+    int msgLen = log_warn( "testValue is %d\n", testValue );
+
+    int result = TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+    result |= TEST_ASSERT_EQUAL_INT( strlen( expectedLogMessage ), msgLen );
+    result |= TEST_ASSERT_EQUAL_INT( 1U, m_consoleWriteCount );
+    return result;
+}
+
+/**
+ * @brief When CONSOLE_WRITE() is defined, a log message that is longer than 
+ * LOG_CONSOLE_LINE_SIZE shall be truncated.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_consoleWrite_logMessageIsTruncated( void )
+{
+    char longValue[LOG_CONSOLE_LINE_SIZE];
+    memset( longValue, 'x', sizeof( longValue ) - 1U );
+    longValue[sizeof( longValue ) - 1U] = '\0';
+    char expectedPrefix[80] = { '\0'};
+    m_consoleWriteCount = 0U;
+
+    // UUT
+    size_t expectedMsgLen = (size_t)sprintf( expectedPrefix, "   12345 INFO  test_runner.c:%u: ", NEXT_LINE );
+    int msgLen = log_info( "%s", longValue );
+
+#if LOG_USE_MESSAGE_BUFFER
+    expectedMsgLen += LOG_MESSAGE_BUFFER_SIZE - 1U;  /* log message body is truncated to the message buffer size */
+#else
+    expectedMsgLen += sizeof( longValue ) - 1U;
+#endif
+    expectedMsgLen = ( expectedMsgLen < LOG_CONSOLE_LINE_SIZE ) ? expectedMsgLen : ( LOG_CONSOLE_LINE_SIZE - 1U );
+    int result = TEST_ASSERT_EQUAL_INT( expectedMsgLen, msgLen );
+    result |= TEST_ASSERT_EQUAL_INT( 1U, m_consoleWriteCount );
+    return result;
+}
+#endif
+
+#if LOG_USE_BINARY_SINK
+/**
+ * @brief Binary log record write function, which appends records to m_binaryRecords.
+ *
+ * @param record Encoded record.
+ * @param length Number of bytes of the record.
+ * @param writeData Unused.
+ */
+static void binaryWrite( const uint8_t* record, size_t length, void* writeData )
+{
+    (void)writeData;
+    size_t freeSpace = sizeof( m_binaryRecords ) - m_binaryRecordsLength;
+    length = ( length < freeSpace ) ? length : freeSpace;
+    memcpy( &m_binaryRecords[m_binaryRecordsLength], record, length );
+    m_binaryRecordsLength += length;
+}
+
+/**
+ * @brief Decode an unsigned LEB128 variable length integer.
+ *
+ * @param data Encoded value.
+ * @param value Decoded value.
+ * @return Pointer to the byte that follows the encoded value.
+ */
+static const uint8_t* readVarint( const uint8_t* data, uintmax_t* value )
+{
+    unsigned int shift = 0U;
+    *value = 0U;
+    do
+    {
+        *value |= (uintmax_t)( *data & 0x7FU ) << shift;
+        shift += 7U;
+    } while( 0U != ( *data++ & 0x80U ) );
+    return data;
+}
+
+/**
+ * @brief The binary sink shall write a sync record with the absolute timestamp,
+ * followed by a record for each log message that holds the timestamp delta, 
+ * the logging level, the filename and format string addresses, the line number
+ * and the encoded printf arguments. A string argument shall be encoded up to 
+ * its precision.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_binarySink_recordsAreEncoded( void )
+{
+    static const uint8_t expectedSync[] = { 5U, 0x10U, 1U, 0xB9U, 0x60U, (uint8_t)( 8U * sizeof( tLog_timestamp ) ) };  /* length, type, version, timestamp 12345, timestamp width */
+    static const uint8_t expectedArgs[] = { 5U, 2U, 'a', 'b', 0xACU, 0x02U };  /* -3, "ab", 300 */
+    tLog_binarySink sink;
+    uintmax_t fields[5U][2U];
+    m_binaryRecordsLength = 0U;
+
+    // UUT
+    log_binarySinkInit( &sink, binaryWrite, NULL );
+    int result = log_registerCallbackFn( log_binaryCallback, &sink, LOG_TRACE ) ? 0 : 1;
+    int line = __LINE__; log_info( "v=%d s=%s u=%u\n", -3, "ab", 300U );
+    setExpectedTimestamp( DEFAULT_EXPECTED_TIMESTAMP + 200U );
+    log_warn( "v=%d s=%.2s u=%u\n", -3, "abc", 300U );  /* string is encoded up to its precision */
+    log_unregisterCallbackFn( log_binaryCallback, &sink );
+
+    result |= TEST_ASSERT_EQUAL_INT( 0, memcmp( expectedSync, m_binaryRecords, sizeof( expectedSync ) ) );
+    const uint8_t* data = &m_binaryRecords[sizeof( expectedSync )];
+    const uint8_t* recordEnd[2U];
+    uint8_t header[2U];
+    for( size_t i = 0U; i < 2U; i++ )
+    {
+        uintmax_t length;
+        data = readVarint( data, &length );
+        recordEnd[i] = data + length;
+        header[i] = *data++;
+#if LOG_USE_STRING_TABLE
+        data = readVarint( data, &fields[0U][i] );  /* time delta */
+        data = readVarint( data, &fields[3U][i] );  /* call site ID */
+        const tLog_site* site = log_getSite( (uint16_t)fields[3U][i] );
+        fields[1U][i] = (uintptr_t)site->file;
+        fields[2U][i] = (uintmax_t)site->line;
+        header[i] &= (uint8_t)~0x20U;  /* call site record type */
+#else
+        for( size_t j = 0U; j < 4U; j++ )
+        {
+            data = readVarint( data, &fields[j][i] );  /* time delta, filename, line, format string */
+        }
+#endif
+        result |= TEST_ASSERT_EQUAL_INT( (size_t)( recordEnd[i] - data ), sizeof( expectedArgs ) );
+        result |= TEST_ASSERT_EQUAL_INT( 0, memcmp( expectedArgs, data, sizeof( expectedArgs ) ) );
+        data = recordEnd[i];
+    }
+    result |= TEST_ASSERT_EQUAL_INT( (size_t)( data - m_binaryRecords ), m_binaryRecordsLength );
+    result |= TEST_ASSERT_EQUAL_INT( LOG_INFO, header[0U] );
+    result |= TEST_ASSERT_EQUAL_INT( LOG_WARN, header[1U] );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, fields[0U][0U] );
+    result |= TEST_ASSERT_EQUAL_INT( 200U, fields[0U][1U] );
+    result |= TEST_ASSERT_EQUAL_INT( fields[1U][0U], fields[1U][1U] );  /* same filename */
+    result |= TEST_ASSERT_EQUAL_INT( line, fields[2U][0U] );
+    result |= TEST_ASSERT_EQUAL_INT( ( line + 2 ), fields[2U][1U] );
+    return result;
+}
+
+/**
+ * @brief A log message record shall not exceed LOG_BINARY_RECORD_SIZE. A string
+ * argument that does not fit shall be truncated, and the record shall be 
+ * flagged as truncated.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_binarySink_recordIsTruncated( void )
+{
+    char longValue[LOG_BINARY_RECORD_SIZE + 1U];
+    memset( longValue, 'x', sizeof( longValue ) - 1U );
+    longValue[sizeof( longValue ) - 1U] = '\0';
+    tLog_binarySink sink;
+    m_binaryRecordsLength = 0U;
+
+    // UUT
+    log_binarySinkInit( &sink, binaryWrite, NULL );
+    int result = log_registerCallbackFn( log_binaryCallback, &sink, LOG_TRACE ) ? 0 : 1;
+    log_error( "%s %d", longValue, 1 );
+    log_unregisterCallbackFn( log_binaryCallback, &sink );
+
+    uintmax_t length;
+    const uint8_t* data = readVarint( m_binaryRecords, &length );
+    data = readVarint( data + length, &length );  /* skip the sync record */
+    result |= TEST_ASSERT_EQUAL_INT( 1, length <= LOG_BINARY_RECORD_SIZE );
+    result |= TEST_ASSERT_EQUAL_INT( (size_t)( data + length - m_binaryRecords ), m_binaryRecordsLength );
+#if LOG_USE_STRING_TABLE
+    result |= TEST_ASSERT_EQUAL_INT( ( 0x80U | 0x20U | LOG_ERROR ), *data );
+#else
+    result |= TEST_ASSERT_EQUAL_INT( ( 0x80U | LOG_ERROR ), *data );
+#endif
+    return result;
+}
+#endif
+
+#if LOG_USE_STRING_TABLE
+/**
+ * @brief When the call site table is enabled, the log event passed to a 
+ * callback shall refer to the call site table entry of the log message, which
+ * shall hold its filename, line number, format string and logging level, and
+ * shall be found by its call site ID. An entry that is not in the table shall
+ * have the reserved invalid call site ID.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_stringTable_siteIsRecorded( void )
+{
+    // UUT
+    int result = log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_TRACE ) ? 0 : 1;
+    int line = __LINE__; log_warn( "site %d\n", 1 );
+    log_info( "other site\n" );
+    const tLog_site* site = m_callback1Data.ev.site;
+    log_unregisterCallbackFn( callbackFunction, &m_callback1Data );
+
+    result |= ( NULL != site ) ? 0 : 1;
+    if( NULL != site )
+    {
+        result |= TEST_ASSERT_EQUAL_STRING( "other site\n", site->fmt );
+        result |= TEST_ASSERT_EQUAL_STRING( "test_runner.c", site->file );
+        result |= TEST_ASSERT_EQUAL_INT( ( line + 1 ), site->line );
+        result |= TEST_ASSERT_EQUAL_INT( LOG_INFO, site->level );
+        result |= ( site == log_getSite( log_siteId( site ) ) ) ? 0 : 1;
+    }
+    result |= ( NULL == log_getSite( LOG_SITE_ID_INVALID ) ) ? 0 : 1;
+    tLog_site otherSite = { "other.c", "not in the table\n", 1, LOG_INFO, 0 };
+    result |= TEST_ASSERT_EQUAL_INT( LOG_SITE_ID_INVALID, log_siteId( &otherSite ) );
+    return result;
+}
+
+/**
+ * @brief When the call site table is enabled, the log event of a log message of
+ * a logger context shall refer to its call site table entry, and to the context.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_stringTable_contextSiteIsRecorded( void )
+{
+    char expectedLogMessage[80] = { '\0'};
+
+    // UUT
+    int result = log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_TRACE ) ? 0 : 1;
+    int line = __LINE__; log_warn_ctx( NULL, "context site %d\n", 2 );
+    const tLog_site* site = m_callback1Data.ev.site;
+    log_unregisterCallbackFn( callbackFunction, &m_callback1Data );
+#if LOG_USE_ASYNC
+    log_drain();
+#endif
+
+    result |= ( NULL != site ) ? 0 : 1;
+    if( NULL != site )
+    {
+        result |= TEST_ASSERT_EQUAL_STRING( "context site %d\n", site->fmt );
+        result |= TEST_ASSERT_EQUAL_INT( line, site->line );
+        result |= TEST_ASSERT_EQUAL_INT( LOG_WARN, site->level );
+        result |= ( LOG_SITE_ID_INVALID != log_siteId( site ) ) ? 0 : 1;
+    }
+    result |= ( NULL == m_callback1Data.ev.context ) ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_STRING( "context site 2\n", m_callback1Data.logMessage );
+    sprintf( expectedLogMessage, "   12345 WARN  test_runner.c:%d: context site 2\n", line );
+    result |= TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+    return result;
+}
+#endif
+
+#if LOG_USE_CHUNK_OUTPUT
+/**
+ * @brief Chunk write function, which records the accepted chunks in m_chunks.
+ *
+ * @param chunk Log message.
+ * @param length Number of characters of the log message.
+ * @param writeData Unused.
+ * @return false if m_chunkDriverBusy is set, otherwise true.
+ */
+static bool chunkWrite( const char* chunk, size_t length, void* writeData )
+{
+    (void)writeData;
+    bool accepted = !m_chunkDriverBusy && ( m_chunkCount < LOG_ASYNC_QUEUE_LENGTH ) && ( strlen( chunk ) == length );
+    if( accepted )
+    {
+        m_chunks[m_chunkCount++] = chunk;
+    }
+    return accepted;
+}
+
+/**
+ * @brief When a chunk write function is registered, log_drain() shall hand the
+ * complete, aligned log message to it instead of writing it to the console, and
+ * a rejected log message shall be handed out again by the next log_drain().
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_chunkOutput_messageIsHandedToDriver( void )
+{
+    char expectedLogMessage[80] = { '\0'};
+    m_chunkCount = 0U;
+    log_setAsync( true );
+    log_setChunkWriteFn( chunkWrite, NULL );
+
+    // UUT
+    sprintf( expectedLogMessage, "   12345 INFO  test_runner.c:%u: testValue is 48\n", NEXT_LINE );
+    log_info( "testValue is %d\n", 48 );
+    m_chunkDriverBusy = true;
+    int result = TEST_ASSERT_EQUAL_INT( 0, log_drain() );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, m_chunkCount );
+    m_chunkDriverBusy = false;
+    int drainLen = log_drain();
+
+    result |= TEST_ASSERT_EQUAL_STRING( "", m_logMessage );    /* nothing written to the console */
+    result |= TEST_ASSERT_EQUAL_INT( 1U, m_chunkCount );
+    result |= TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_chunks[0U] );
+    result |= TEST_ASSERT_EQUAL_INT( strlen( expectedLogMessage ), drainLen );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, (uintptr_t)m_chunks[0U] % LOG_CHUNK_ALIGNMENT );
+    log_releaseChunk( m_chunks[0U] );
+    result |= TEST_ASSERT_EQUAL_INT( 0, log_drain() );  /* queue is empty */
+    return result;
+}
+
+/**
+ * @brief A queue slot that has been handed to the chunk write function shall 
+ * not be reused by producers until every reference to the chunk has been 
+ * released.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_chunkOutput_slotIsHeldUntilReleased( void )
+{
+    int result = 0;
+    m_chunkCount = 0U;
+    log_setAsync( true );
+    log_setChunkWriteFn( chunkWrite, NULL );
+
+    // UUT
+    for( size_t i = 0U; i < LOG_ASYNC_QUEUE_LENGTH; i++ )
+    {
+        result |= ( log_info( "message %u\n", (unsigned int)i ) >= 0 ) ? 0 : 1;
+    }
+    log_drain();
+    result |= TEST_ASSERT_EQUAL_INT( LOG_ASYNC_QUEUE_LENGTH, m_chunkCount );
+    result |= TEST_ASSERT_EQUAL_INT( -1, log_info( "dropped\n" ) );  /* all slots are held by the driver */
+
+    log_retainChunk( m_chunks[0U] );  /* second driver */
+    log_releaseChunk( m_chunks[0U] );
+    result |= TEST_ASSERT_EQUAL_INT( -1, log_info( "dropped\n" ) );
+    log_releaseChunk( m_chunks[0U] );
+    result |= ( log_info( "queued\n" ) >= 0 ) ? 0 : 1;
+    return result;
+}
+
+/**
+ * @brief Chunk write function that transmits each chunk at once, like a DMA 
+ * complete interrupt that releases the chunk before the write function returns,
+ * and writes a log message into the first released slot.
+ *
+ * @param chunk Log message.
+ * @param length Number of characters of the log message.
+ * @param writeData Unused.
+ * @return true.
+ */
+static bool completingChunkWrite( const char* chunk, size_t length, void* writeData )
+{
+    (void)writeData;
+    m_chunkBytes += length;
+    m_chunkCount++;
+    log_releaseChunk( chunk );
+    if( 1U == m_chunkCount )
+    {
+        (void)log_info( "x\n" );  /* overwrites the released slot */
+    }
+    return true;
+}
+
+/**
+ * @brief log_drain() shall return the length of the log messages handed to the
+ * chunk write function, even if a chunk is released and its slot is reused 
+ * before the chunk write function returns.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_chunkOutput_lengthIsReadBeforeHandingOut( void )
+{
+    int result = 0;
+    m_chunkCount = 0U;
+    m_chunkBytes = 0U;
+    log_setAsync( true );
+    log_setChunkWriteFn( completingChunkWrite, NULL );
+    for( size_t i = 0U; i < LOG_ASYNC_QUEUE_LENGTH; i++ )
+    {
+        result |= ( log_info( "message %u\n", (unsigned int)i ) >= 0 ) ? 0 : 1;
+    }
+
+    // UUT
+    int drainLen = log_drain();
+
+    result |= TEST_ASSERT_EQUAL_INT( LOG_ASYNC_QUEUE_LENGTH + 1U, m_chunkCount );
+    result |= TEST_ASSERT_EQUAL_INT( m_chunkBytes, drainLen );
+    return result;
+}
+#endif
+
+#if LOG_USE_BATCH_SINK
+/**
+ * @brief Batch callback function, which records the last batch in m_batchText.
+ *
+ * @param events Array of log messages.
+ * @param count Number of log messages.
+ * @param batchData Unused.
+ */
+static void batchCallback( const tLog_batchEvent* events, size_t count, void* batchData )
+{
+    (void)batchData;
+    m_batchCount++;
+    m_batchEventCount = count;
+    size_t length = 0U;
+    for( size_t i = 0U; i < count; i++ )
+    {
+        length += (size_t)snprintf( &m_batchText[length], sizeof( m_batchText ) - length, "%s%s", ( i > 0U ) ? "|" : "", events[i].text );
+        length = ( length < sizeof( m_batchText ) ) ? length : ( sizeof( m_batchText ) - 1U );
+    }
+}
+
+/**
+ * @brief A batch sink shall accumulate log messages, and deliver them to the 
+ * batch callback in a single call when the batch holds maxEvents log messages.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_batchSink_deliveredByCount( void )
+{
+    static tLog_batchSink sink;
+    m_batchCount = 0U;
+    log_batchSinkInit( &sink, batchCallback, NULL, 3U, 0U, 0U );
+
+    // UUT
+    int result = log_registerCallbackFn( log_batchCallback, &sink, LOG_TRACE ) ? 0 : 1;
+    log_info( "a%d", 1 );
+    log_info( "b%d", 2 );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, m_batchCount );
+    int line = __LINE__; log_warn( "c%d", 3 );
+
+    result |= TEST_ASSERT_EQUAL_INT( 1U, m_batchCount );
+    result |= TEST_ASSERT_EQUAL_INT( 3U, m_batchEventCount );
+    result |= TEST_ASSERT_EQUAL_STRING( "a1|b2|c3", m_batchText );
+    result |= TEST_ASSERT_EQUAL_INT( LOG_WARN, sink.events[2U].level );
+    result |= TEST_ASSERT_EQUAL_INT( line, sink.events[2U].line );
+    result |= TEST_ASSERT_EQUAL_INT( DEFAULT_EXPECTED_TIMESTAMP, sink.events[2U].time );
+    return result;
+}
+
+/**
+ * @brief A batch sink shall deliver the batch before a log message body that 
+ * would not fit in maxBytes is added, and when the oldest log message is maxAge
+ * older than the newest.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_batchSink_deliveredBySizeAndAge( void )
+{
+    static tLog_batchSink sink;
+    m_batchCount = 0U;
+    log_batchSinkInit( &sink, batchCallback, NULL, 0U, 8U, 100U );
+
+    // UUT
+    int result = log_registerCallbackFn( log_batchCallback, &sink, LOG_TRACE ) ? 0 : 1;
+    log_info( "abc" );
+    log_info( "def" );  /* 8 bytes including null terminators: the batch is full */
+    result |= TEST_ASSERT_EQUAL_INT( 1U, m_batchCount );
+    result |= TEST_ASSERT_EQUAL_STRING( "abc|def", m_batchText );
+
+    log_info( "ghij" );
+    log_info( "klm" );  /* does not fit: the batch is delivered first */
+    result |= TEST_ASSERT_EQUAL_INT( 2U, m_batchCount );
+    result |= TEST_ASSERT_EQUAL_STRING( "ghij", m_batchText );
+
+    setExpectedTimestamp( DEFAULT_EXPECTED_TIMESTAMP + 100U );
+    log_info( "n" );  /* oldest log message has expired */
+    result |= TEST_ASSERT_EQUAL_INT( 3U, m_batchCount );
+    result |= TEST_ASSERT_EQUAL_STRING( "klm|n", m_batchText );
+    return result;
+}
+
+/**
+ * @brief log_flush() shall deliver the log messages accumulated by each 
+ * registered batch sink, and shall not invoke the batch callback of an empty 
+ * batch sink.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_batchSink_deliveredByFlush( void )
+{
+    static tLog_batchSink sink;
+    m_batchCount = 0U;
+    log_batchSinkInit( &sink, batchCallback, NULL, 0U, 0U, 0U );
+
+    // UUT
+    int result = log_registerCallbackFn( log_batchCallback, &sink, LOG_INFO ) ? 0 : 1;
+    log_debug( "below level" );
+    log_error( "flushed" );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, m_batchCount );
+    result |= log_flush() ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_INT( 1U, m_batchCount );
+    result |= TEST_ASSERT_EQUAL_STRING( "flushed", m_batchText );
+    result |= log_flush() ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_INT( 1U, m_batchCount );
+    return result;
+}
+#endif
+
+#if LOG_USE_RATELIMIT || LOG_USE_COALESCE || LOG_USE_CRASH_LOG || LOG_USE_STATS || LOG_USE_SAMPLING
+/**
+ * @brief Callback function that counts the log messages passed to it.
+ *
+ * @param ev Pointer to logging event data.
+ * @param cbData Pointer to the size_t count.
+ */
+static void countCallbackFunction( tLog_event* ev, void* cbData )
+{
+    (void) ev;
+    (*(size_t*)cbData)++;
+}
+#endif
+
+#if LOG_USE_RATELIMIT
+/**
+ * @brief A rate limited call site shall write at most LOG_RATELIMIT_BURST log
+ * messages per interval, and shall write log messages again in the next
+ * interval, after the suppressed log message count.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_ratelimit_excessMessagesAreSuppressed( void )
+{
+    size_t count = 0U;
+    int result = log_registerCallbackFn( countCallbackFunction, &count, LOG_TRACE ) ? 0 : 1;
+    result |= log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_TRACE ) ? 0 : 1;
+
+    // UUT
+    for( int i = 0; i <= (int)LOG_RATELIMIT_BURST + 5; i++ )
+    {
+        if( ( (int)LOG_RATELIMIT_BURST + 5 ) == i )
+        {
+            result |= TEST_ASSERT_EQUAL_INT( LOG_RATELIMIT_BURST, count );
+            setExpectedTimestamp( DEFAULT_EXPECTED_TIMESTAMP + LOG_RATELIMIT_INTERVAL );
+        }
+        log_warn_ratelimited( "storm %d", i );
+    }
+
+    result |= TEST_ASSERT_EQUAL_INT( ( LOG_RATELIMIT_BURST + 2U ), count );
+    char expected[TEST_BUFFER_SIZE];
+    snprintf( expected, sizeof( expected ), "storm %d", (int)LOG_RATELIMIT_BURST + 5 );
+    result |= TEST_ASSERT_EQUAL_STRING( expected, m_callback1Data.logMessage );
+    return result;
+}
+
+/**
+ * @brief Callback function that only records the log messages that report the
+ * number of log messages suppressed by a rate limited call site.
+ *
+ * @param ev Pointer to logging event data.
+ * @param cbData Pointer to the tCallbackData object.
+ */
+static void reportCallbackFunction( tLog_event* ev, void* cbData )
+{
+    if( 0 == strcmp( LOG_RATELIMIT_SUPPRESSED_FORMAT, ev->fmt ) )
+    {
+        callbackFunction( ev, cbData );
+    }
+}
+
+/**
+ * @brief When log_ratelimit() allows a log message after log messages have 
+ * been suppressed, it shall return the number of suppressed log messages and
+ * reset it, without writing a log message. A rate limited macro shall write
+ * the number through the same entry point as its own log messages, with its 
+ * level, filename, line number, module and call site table entry.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_ratelimit_suppressedMessagesAreCounted( void )
+{
+    tLog_ratelimit ratelimit = { 0 };
+    uint32_t suppressed = 1U;
+    int result = log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_TRACE ) ? 0 : 1;
+
+    // UUT
+    result |= log_ratelimit( &ratelimit, 2U, 100U, &suppressed ) ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_INT( 0U, suppressed );
+    result |= log_ratelimit( &ratelimit, 2U, 100U, &suppressed ) ? 0 : 1;
+    result |= log_ratelimit( &ratelimit, 2U, 100U, &suppressed ) ? 1 : 0;
+    setExpectedTimestamp( DEFAULT_EXPECTED_TIMESTAMP + 99U );
+    result |= log_ratelimit( &ratelimit, 2U, 100U, &suppressed ) ? 1 : 0;
+    setExpectedTimestamp( DEFAULT_EXPECTED_TIMESTAMP + 100U );
+    result |= log_ratelimit( &ratelimit, 2U, 100U, &suppressed ) ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_INT( 2U, suppressed );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, ratelimit.suppressed );
+    result |= TEST_ASSERT_NULL( m_callback1Data.ev.file );  /* nothing is written by log_ratelimit() */
+
+    result |= log_registerCallbackFn( reportCallbackFunction, &m_callback2Data, LOG_TRACE ) ? 0 : 1;
+    int line = 0;
+    setExpectedTimestamp( DEFAULT_EXPECTED_TIMESTAMP );
+    for( int i = 0; i < (int)LOG_RATELIMIT_BURST + 3; i++ )
+    {
+        if( ( (int)LOG_RATELIMIT_BURST + 2 ) == i )
+        {
+            setExpectedTimestamp( DEFAULT_EXPECTED_TIMESTAMP + LOG_RATELIMIT_INTERVAL );
+        }
+        line = NEXT_LINE;
+        log_error_ratelimited( "storm %d", i );
+    }
+    result |= TEST_ASSERT_EQUAL_STRING( "2 log messages suppressed", m_callback2Data.logMessage );
+    result |= TEST_ASSERT_EQUAL_INT( LOG_ERROR, m_callback2Data.ev.level );
+    result |= TEST_ASSERT_EQUAL_STRING( "test_runner.c", m_callback2Data.ev.file );
+    result |= TEST_ASSERT_EQUAL_INT( line, m_callback2Data.ev.line );
+#if LOG_USE_MODULES
+    result |= TEST_ASSERT_EQUAL_INT( LOG_MODULE, m_callback2Data.ev.module );
+#endif
+#if LOG_USE_STRING_TABLE
+    result |= ( NULL != m_callback2Data.ev.site ) ? 0 : 1;
+    result |= ( NULL != m_callback2Data.ev.site ) ? TEST_ASSERT_EQUAL_STRING( LOG_RATELIMIT_SUPPRESSED_FORMAT, m_callback2Data.ev.site->fmt ) : 1;
+#endif
+    return result;
+}
+#endif
+
+#if LOG_USE_COALESCE
+/**
+ * @brief Identical consecutive log messages shall be counted instead of 
+ * written, and a different log message shall first write the repeat count, 
+ * with the level, filename and line number of the repeated log message.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_coalesce_repeatsAreCounted( void )
+{
+    size_t count = 0U;
+    int result = log_registerCallbackFn( countCallbackFunction, &count, LOG_TRACE ) ? 0 : 1;
+    result |= log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_TRACE ) ? 0 : 1;
+
+    // UUT
+    int line = 0;
+    for( int i = 0; i < 4; i++ )
+    {
+        line = __LINE__; log_warn( "retry %d of %s", 3, "sensor" );
+    }
+    result |= TEST_ASSERT_EQUAL_INT( 1U, count );
+    int otherLine = __LINE__; log_warn( "retry %d of %s", 3, "sensor" );  /* same format string and arguments, but a different call site */
+    result |= TEST_ASSERT_EQUAL_INT( 3U, count );
+    result |= TEST_ASSERT_EQUAL_INT( otherLine, m_callback1Data.ev.line );
+    result |= ( line != otherLine ) ? 0 : 1;
+
+    for( int i = 0; i < 3; i++ )
+    {
+        log_warn( "retry %d of %s", ( i < 2 ) ? 4 : 5, "sensor" );
+    }
+    result |= TEST_ASSERT_EQUAL_INT( 6U, count );
+    result |= TEST_ASSERT_EQUAL_STRING( "retry 5 of sensor", m_callback1Data.logMessage );
+    return result;
+}
+
+/**
+ * @brief The repeat count shall be written, and the log message written again,
+ * when a repeat arrives after LOG_COALESCE_TIMEOUT, and log_flush() shall write
+ * the repeat count of the last log message.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_coalesce_repeatCountIsWrittenOnTimeout( void )
+{
+    size_t count = 0U;
+    int result = log_registerCallbackFn( countCallbackFunction, &count, LOG_TRACE ) ? 0 : 1;
+    result |= log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_TRACE ) ? 0 : 1;
+
+    // UUT
+    int line = 0;
+    for( int i = 0; i < 5; i++ )
+    {
+        if( 3 == i )
+        {
+            setExpectedTimestamp( DEFAULT_EXPECTED_TIMESTAMP + LOG_COALESCE_TIMEOUT );
+        }
+        line = __LINE__; log_error( "link down" );
+    }
+    result |= TEST_ASSERT_EQUAL_INT( 3U, count );
+    result |= TEST_ASSERT_EQUAL_STRING( "link down", m_callback1Data.logMessage );
+
+    result |= log_flush() ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_INT( 4U, count );
+    result |= TEST_ASSERT_EQUAL_STRING( "last message repeated 1 times", m_callback1Data.logMessage );
+    result |= TEST_ASSERT_EQUAL_INT( LOG_ERROR, m_callback1Data.ev.level );
+    result |= TEST_ASSERT_EQUAL_INT( line, m_callback1Data.ev.line );
+
+    result |= log_flush() ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_INT( 4U, count );
+    return result;
+}
+
+#if LOG_USE_ASYNC
+/**
+ * @brief Identical consecutive log messages that are only queued for the 
+ * console shall be coalesced without taking the lock, and log_flush() shall 
+ * queue the repeat count.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_coalesce_queuedRepeatsAreCountedWithoutLock( void )
+{
+    char expectedLogMessage[80] = { '\0'};
+    log_setLockFn( setLockState, &m_logIsLocked );
+    m_logIsLocked = true;  /* Simulate lock acquisition by another thread */
+    log_setAsync( true );
+
+    // UUT
+    int line = 0;
+    for( int i = 0; i < 3; i++ )
+    {
+        line = __LINE__; log_warn( "link down\n" );
+    }
+    sprintf( expectedLogMessage, "   12345 WARN  test_runner.c:%u: link down\n", line );
+    int result = ( log_drain() > 0 ) ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+
+    m_logIsLocked = false;
+    clearLogMessage();
+    result |= log_flush() ? 0 : 1;
+    result |= ( log_drain() > 0 ) ? 0 : 1;
+    sprintf( expectedLogMessage, "   12345 WARN  test_runner.c:%u: last message repeated 2 times", line );
+#if LOG_USE_CHUNK_OUTPUT
+    expectedLogMessage[LOG_ASYNC_MESSAGE_SIZE - 1U] = '\0';  /* the prefix is formatted into the queue slot too */
+#endif
+    result |= TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+
+    tLog_stats stats;
+    log_getStats( &stats );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, stats.lockFailures );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, stats.coalesceSkipped );
+    return result;
+}
+#endif
+#endif
+
+#if LOG_MAX_MODULES > 1U
+/**
+ * @brief A module logging level shall override the level set by log_setLevel()
+ * for the log messages of the module, until it is set to LOG_LEVEL_INHERIT.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_moduleLevel_overridesGlobalLevel( void )
+{
+    log_setLevel( LOG_WARN );
+
+    // UUT
+    int result = log_setModuleLevel( LOG_MODULE, LOG_DEBUG ) ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_INT( LOG_DEBUG, log_effectiveModuleLevel[LOG_MODULE] );
+    result |= ( log_debug( "traced\n" ) > 0 ) ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_INT( 0, log_trace( "not traced\n" ) );
+
+    result |= log_setModuleLevel( LOG_MODULE, LOG_LEVEL_INHERIT ) ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_INT( LOG_WARN, log_effectiveModuleLevel[LOG_MODULE] );
+    result |= TEST_ASSERT_EQUAL_INT( 0, log_debug( "not traced\n" ) );
+    return result;
+}
+
+/**
+ * @brief The log messages of a module without a logging level shall use the 
+ * level set by log_setLevel(), and log_setModuleLevel() shall reject an 
+ * invalid module index.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_moduleLevel_otherModulesUseGlobalLevel( void )
+{
+    // UUT
+    int result = log_setModuleLevel( 1, LOG_TRACE ) ? 0 : 1;
+    log_setLevel( LOG_ERROR );
+    result |= ( log_logModule( 1, LOG_DEBUG, "module1.c", 1, "traced\n" ) > 0 ) ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_INT( 0, log_logModule( 0, LOG_WARN, "module0.c", 1, "not printed\n" ) );
+    result |= TEST_ASSERT_EQUAL_INT( 0, log_warn( "not printed\n" ) );
+    result |= TEST_ASSERT_EQUAL_INT( LOG_ERROR, log_effectiveModuleLevel[0] );
+
+    result |= log_setModuleLevel( (int)LOG_MAX_MODULES, LOG_TRACE ) ? 1 : 0;
+    result |= log_setModuleLevel( -1, LOG_TRACE ) ? 1 : 0;
+    return result;
+}
+#endif
+
+#if LOG_USE_CRASH_LOG
+/**
+ * @brief log_recoverCrashLog() shall write the log messages recorded before 
+ * the reset to the callbacks, oldest first, with their original timestamps, 
+ * level, filename and line number, and shall then empty the crash log, as
+ * shall log_discardCrashLog().
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_crashLog_recordsAreReplayed( void )
+{
+    log_warn( "motor %d stalled at %s", 2, "startup" );
+    setExpectedTimestamp( DEFAULT_EXPECTED_TIMESTAMP + 5U );
+    int line = __LINE__; log_error( "voltage %u mV", 3300U );
+    setExpectedTimestamp( DEFAULT_EXPECTED_TIMESTAMP + 10U );
+
+    size_t count = 0U;
+    int result = log_registerCallbackFn( countCallbackFunction, &count, LOG_TRACE ) ? 0 : 1;
+    result |= log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_TRACE ) ? 0 : 1;
+
+    // UUT
+    result |= TEST_ASSERT_EQUAL_INT( 2, log_recoverCrashLog() );
+    result |= TEST_ASSERT_EQUAL_INT( 2U, count );
+    result |= TEST_ASSERT_EQUAL_STRING( "voltage 3300 mV", m_callback1Data.logMessage );
+    result |= TEST_ASSERT_EQUAL_INT( ( DEFAULT_EXPECTED_TIMESTAMP + 5U ), m_callback1Data.ev.time );
+    result |= TEST_ASSERT_EQUAL_INT( LOG_ERROR, m_callback1Data.ev.level );
+    result |= TEST_ASSERT_EQUAL_INT( line, m_callback1Data.ev.line );
+    result |= TEST_ASSERT_EQUAL_STRING( FILE_NAME, m_callback1Data.ev.file );
+
+    result |= TEST_ASSERT_EQUAL_INT( 0, log_recoverCrashLog() );
+    result |= TEST_ASSERT_EQUAL_INT( 2U, count );
+
+    log_info( "discarded" );
+    log_discardCrashLog();
+    result |= TEST_ASSERT_EQUAL_INT( 0, log_recoverCrashLog() );
+    return result;
+}
+
+/**
+ * @brief When more than LOG_CRASH_LOG_LENGTH log messages are written, the 
+ * oldest records shall be overwritten, and log_recoverCrashLog() shall replay
+ * the most recent LOG_CRASH_LOG_LENGTH log messages.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_crashLog_oldestRecordsAreOverwritten( void )
+{
+    for( int i = 0; i < (int)LOG_CRASH_LOG_LENGTH + 2; i++ )
+    {
+        log_info( "event %d", i );
+    }
+
+    size_t count = 0U;
+    int result = log_registerCallbackFn( countCallbackFunction, &count, LOG_TRACE ) ? 0 : 1;
+    result |= log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_TRACE ) ? 0 : 1;
+
+    // UUT
+    result |= TEST_ASSERT_EQUAL_INT( (int)LOG_CRASH_LOG_LENGTH, log_recoverCrashLog() );
+    result |= TEST_ASSERT_EQUAL_INT( LOG_CRASH_LOG_LENGTH, count );
+    char expected[TEST_BUFFER_SIZE];
+    snprintf( expected, sizeof( expected ), "event %d", (int)LOG_CRASH_LOG_LENGTH + 1 );
+    result |= TEST_ASSERT_EQUAL_STRING( expected, m_callback1Data.logMessage );
+    return result;
+}
+#endif
+
+#if LOG_USE_MMAP_SINK
+/**
+ * @brief Read a file into a null terminated buffer.
+ *
+ * @param path Path of the file.
+ * @param buffer Destination buffer.
+ * @param size Size of the destination buffer in bytes.
+ * @return Number of bytes read, or 0 if the file does not exist.
+ */
+static size_t readFile( const char* path, char* buffer, size_t size )
+{
+    size_t length = 0U;
+    FILE* file = fopen( path, "rb" );
+    if( NULL != file )
+    {
+        length = fread( buffer, 1U, size - 1U, file );
+        (void)fclose( file );
+    }
+    buffer[length] = '\0';
+    return length;
+}
+
+/**
+ * @brief The memory-mapped file sink shall append each log message to the log
+ * file with its prefix, terminated by a newline, and the log file shall be
+ * truncated to the bytes written when the sink is closed.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_mmapSink_recordsAreAppended( void )
+{
+    tLog_mmapSink sink;
+    (void)remove( MMAP_TEST_PATH "_append.log" );
+    int result = log_mmapSinkOpen( &sink, MMAP_TEST_PATH "_append.log", 4096U, 0U, 64U ) ? 0 : 1;
+    result |= log_registerCallbackFn( log_mmapCallback, &sink, LOG_TRACE ) ? 0 : 1;
+
+    // UUT
+    int line = __LINE__; log_info( "first %d\n", 1 );
+    log_warn( "second %s", "record" );  /* the sink terminates the record with a newline */
+    result |= log_mmapSinkSync( &sink ) ? 0 : 1;
+    log_unregisterCallbackFn( log_mmapCallback, &sink );
+    log_mmapSinkClose( &sink );
+
+    char expected[4U * TEST_BUFFER_SIZE];
+    snprintf( expected, sizeof( expected ), "   12345 INFO  %s:%d: first 1\n   12345 WARN  %s:%d: second record\n",
+              FILE_NAME, line, FILE_NAME, line + 1 );
+    char text[4U * TEST_BUFFER_SIZE];
+    size_t length = readFile( MMAP_TEST_PATH "_append.log", text, sizeof( text ) );
+    result |= TEST_ASSERT_EQUAL_STRING( expected, text );
+    result |= TEST_ASSERT_EQUAL_INT( strlen( expected ), length );
+    (void)remove( MMAP_TEST_PATH "_append.log" );
+    return result;
+}
+
+/**
+ * @brief When the next log message does not fit in the log file, the sink 
+ * shall rename the log file to "<path>.1" and continue in a new log file, 
+ * keeping maxFiles rotated log files.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_mmapSink_fileIsRotatedBySize( void )
+{
+    char expected[TEST_BUFFER_SIZE];
+    int line = __LINE__ + 11;  /* line of the log_info() call */
+    size_t recordLength = (size_t)snprintf( expected, sizeof( expected ), "   12345 INFO  %s:%d: message 4\n", FILE_NAME, line );
+
+    tLog_mmapSink sink;
+    (void)remove( MMAP_TEST_PATH "_rotate.log.2" );
+    int result = log_mmapSinkOpen( &sink, MMAP_TEST_PATH "_rotate.log", 2U * recordLength + recordLength / 2U, 1U, 0U ) ? 0 : 1;
+    result |= log_registerCallbackFn( log_mmapCallback, &sink, LOG_TRACE ) ? 0 : 1;
+
+    // UUT
+    for( int i = 0; i < 5; i++ )
+    {
+        log_info( "message %d", i );
+    }
+    log_unregisterCallbackFn( log_mmapCallback, &sink );
+    log_mmapSinkClose( &sink );
+
+    result |= TEST_ASSERT_EQUAL_INT( 2U, sink.rotations );
+    char text[4U * TEST_BUFFER_SIZE];
+    result |= TEST_ASSERT_EQUAL_INT( recordLength, readFile( MMAP_TEST_PATH "_rotate.log", text, sizeof( text ) ) );
+    result |= TEST_ASSERT_EQUAL_STRING( expected, text );
+    result |= TEST_ASSERT_EQUAL_INT( ( 2U * recordLength ), readFile( MMAP_TEST_PATH "_rotate.log.1", text, sizeof( text ) ) );
+    result |= ( NULL != strstr( text, "message 3\n" ) ) ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_INT( 0U, readFile( MMAP_TEST_PATH "_rotate.log.2", text, sizeof( text ) ) );
+    (void)remove( MMAP_TEST_PATH "_rotate.log" );
+    (void)remove( MMAP_TEST_PATH "_rotate.log.1" );
+    return result;
+}
+#endif
+
+#if LOG_USE_STATS
+/**
+ * @brief Custom timestamp generator function that advances the timestamp by 4 each time it is read.
+ *
+ * @return timestamp value
+ */
+static tLog_timestamp getSteppedTimestamp( void )
+{
+    m_timestamp += 4U;
+    return m_timestamp;
+}
+
+/**
+ * @brief The statistics shall count the log_log() calls and the suppressed log
+ * messages at each level, including those suppressed by the logging macros,
+ * the characters written to the console and the callback invocations.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_stats_callsAndBytesAreCounted( void )
+{
+    size_t count = 0U;
+    log_setLevel( LOG_INFO );
+    int result = log_registerCallbackFn( countCallbackFunction, &count, LOG_WARN ) ? 0 : 1;
+    log_resetStats();
+
+    // UUT
+    int bytes = log_info( "first\n" );
+    bytes += log_warn( "second %d\n", 2 );
+    result |= TEST_ASSERT_EQUAL_INT( 0, log_log( LOG_DEBUG, "stats.c", 1, "suppressed\n" ) );
+    result |= TEST_ASSERT_EQUAL_INT( 0, log_debug( "suppressed by the macro\n" ) );  /* log_log() is not called */
+    result |= TEST_ASSERT_EQUAL_INT( 0, log_debug_ctx( log_getDefaultContext(), "suppressed by the macro\n" ) );
+
+    tLog_stats stats;
+    log_getStats( &stats );
+    result |= TEST_ASSERT_EQUAL_INT( 3U, stats.calls[LOG_DEBUG] );
+    result |= TEST_ASSERT_EQUAL_INT( 1U, stats.calls[LOG_INFO] );
+    result |= TEST_ASSERT_EQUAL_INT( 1U, stats.calls[LOG_WARN] );
+    result |= TEST_ASSERT_EQUAL_INT( 3U, stats.suppressed[LOG_DEBUG] );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, stats.suppressed[LOG_INFO] );
+    result |= TEST_ASSERT_EQUAL_INT( bytes, (int)stats.bytes );
+    result |= TEST_ASSERT_EQUAL_INT( 1U, stats.callbackInvocations );
+    result |= TEST_ASSERT_EQUAL_INT( 1U, count );
+    return result;
+}
+
+/**
+ * @brief The statistics shall count the duration of each console write, and 
+ * of each callback by registration slot, in log2 buckets, and 
+ * log_resetStats() shall reset them.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_stats_durationsAreCounted( void )
+{
+    int result = log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_TRACE ) ? 0 : 1;
+    result |= log_registerCallbackFn( altCallbackFunction, &m_callback2Data, LOG_TRACE ) ? 0 : 1;
+    log_setTimestampFn( getSteppedTimestamp );
+
+    // UUT
+    log_error( "timed\n" );
+
+    tLog_stats stats;
+    log_getStats( &stats );
+    result |= TEST_ASSERT_EQUAL_INT( 1U, stats.printTime[3] );  /* 4 ticks */
+    result |= TEST_ASSERT_EQUAL_INT( 1U, stats.callbackTime[0][3] );
+    result |= TEST_ASSERT_EQUAL_INT( 1U, stats.callbackTime[1][3] );
+    result |= TEST_ASSERT_EQUAL_INT( 2U, stats.callbackInvocations );
+    result |= TEST_ASSERT_EQUAL_INT( 1U, stats.calls[LOG_ERROR] );
+
+    log_resetStats();
+    log_getStats( &stats );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, stats.printTime[3] );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, stats.callbackTime[0][3] );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, stats.callbackInvocations );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, stats.calls[LOG_ERROR] );
+    return result;
+}
+#endif
+
+#if LOG_USE_FIELDS
+/**
+ * @brief A structured log message shall be written to the console as the 
+ * message, followed by key=value text for each field.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_fields_textIsWrittenToConsole( void )
+{
+    char expectedLogMessage[TEST_BUFFER_SIZE];
+    int32_t direction = -3;
+
+    // UUT
+    sprintf( expectedLogMessage, "   12345 INFO  test_runner.c:%u: motor rpm=1200 temp=%s dir=-3 on=true\n", NEXT_LINE, FIELD_FLOAT_TEXT );
+    int msgLen = log_info_kv( "motor", LOG_U32( "rpm", 1200U ), LOG_F32( "temp", 36.5f ), LOG_I32( "dir", direction ), LOG_BOOL( "on", true ) );
+
+    int result = TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+    result |= TEST_ASSERT_EQUAL_INT( (int)strlen( expectedLogMessage ), msgLen );
+    return result;
+}
+
+/**
+ * @brief Callback function that copies the fields of a structured log message.
+ *
+ * @param ev Pointer to logging event data.
+ * @param cbData Pointer to the array of tLog_field to which the fields are copied.
+ */
+static void fieldsCallbackFunction( tLog_event* ev, void* cbData )
+{
+    tLog_field* fields = cbData;
+    m_fieldCount = ev->fieldCount;
+    for( size_t i = 0U; ( NULL != ev->fields ) && ( i < ev->fieldCount ) && ( i < 3U ); i++ )
+    {
+        fields[i] = ev->fields[i];
+    }
+    callbackFunction( ev, &m_callback1Data );
+}
+
+/**
+ * @brief The callbacks shall receive the typed fields of a structured log 
+ * message, and its text as the printf argument of the format string.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_fields_typedValuesArePassedToCallbacks( void )
+{
+    tLog_field fields[3U];
+    memset( fields, 0, sizeof( fields ) );
+    int result = log_registerCallbackFn( fieldsCallbackFunction, fields, LOG_TRACE ) ? 0 : 1;
+
+    // UUT
+    log_warn_kv( "sensor", LOG_I64( "offset", -5000000000LL ), LOG_U64( "count", UINT64_MAX ), LOG_STR( "id", "s1" ) );
+
+    result |= TEST_ASSERT_EQUAL_STRING( "sensor offset=-5000000000 count=18446744073709551615 id=\"s1\"\n", m_callback1Data.logMessage );
+    result |= TEST_ASSERT_EQUAL_INT( 3U, m_fieldCount );
+    result |= TEST_ASSERT_EQUAL_STRING( "offset", fields[0].key );
+    result |= TEST_ASSERT_EQUAL_INT( LOG_FIELD_I64, fields[0].type );
+    result |= ( -5000000000LL == fields[0].value.i64 ) ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_STRING( "count", fields[1].key );
+    result |= TEST_ASSERT_EQUAL_INT( LOG_FIELD_U64, fields[1].type );
+    result |= ( UINT64_MAX == fields[1].value.u64 ) ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_STRING( "s1", fields[2].value.str );
+
+    log_info( "plain\n" );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, m_fieldCount );
+    return result;
+}
+
+#if LOG_USE_MESSAGE_BUFFER && LOG_LAZY_FORMAT && !LOG_USE_COALESCE && !LOG_USE_CRASH_LOG
+/**
+ * @brief Callback function that only reads the typed fields of a structured log message.
+ *
+ * @param ev Pointer to logging event data.
+ * @param cbData Unused.
+ */
+static void typedFieldsCallbackFunction( tLog_event* ev, void* cbData )
+{
+    (void)cbData;
+    m_fieldCount = ev->fieldCount;
+}
+
+/**
+ * @brief When lazy formatting is enabled, the text of a structured log message
+ * shall not be formatted for a callback that only reads the typed fields, and
+ * shall be formatted when a callback calls log_eventText().
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_fields_textIsFormattedOnlyWhenRequested( void )
+{
+    char expectedText[TEST_BUFFER_SIZE];
+    int result = log_registerCallbackFn( typedFieldsCallbackFunction, NULL, LOG_TRACE ) ? 0 : 1;
+    log_off();
+    m_formatCount = 0U;
+
+    // UUT
+    log_info_kv( "motor", LOG_F32( "temp", 36.5f ), LOG_U32( "rpm", 1200U ) );
+    result |= TEST_ASSERT_EQUAL_INT( 2U, m_fieldCount );
+    result |= TEST_ASSERT_EQUAL_INT( 0U, m_formatCount );  /* the floating point value is not formatted */
+
+    log_unregisterCallbackFn( typedFieldsCallbackFunction, NULL );
+    result |= log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_TRACE ) ? 0 : 1;
+    log_info_kv( "motor", LOG_F32( "temp", 36.5f ), LOG_U32( "rpm", 1200U ) );
+    snprintf( expectedText, sizeof( expectedText ), "motor temp=%s rpm=1200\n", FIELD_FLOAT_TEXT );
+    result |= TEST_ASSERT_EQUAL_STRING( expectedText, m_callback1Data.text );
+    result |= TEST_ASSERT_EQUAL_STRING( expectedText, m_callback1Data.logMessage );
+    return result;
+}
+#endif
+#endif
+
+#if LOG_USE_SPANS
+/**
+ * @brief The span macros shall write begin and end records, in the console 
+ * format, at the span logging level.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_spans_beginAndEndRecordsAreWritten( void )
+{
+    char expectedLogMessage[TEST_BUFFER_SIZE];
+    sprintf( expectedLogMessage, "   12345 TRACE test_runner.c:%d: span B pid\n", NEXT_LINE );
+    LOG_SPAN_BEGIN( "pid" );
+    int result = TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+
+    clearLogMessage();
+    sprintf( expectedLogMessage, "   12345 TRACE test_runner.c:%d: span E\n", NEXT_LINE );
+    LOG_SPAN_END();
+    result |= TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+
+    clearLogMessage();
+    log_setLevel( LOG_SPAN_LEVEL + 1 );
+    LOG_SPAN_BEGIN( "pid" );
+    LOG_SPAN_END();
+    result |= TEST_ASSERT_EQUAL_STRING( "", m_logMessage );  /* spans are suppressed below the console logging level */
+    return result;
+}
+
+#if defined( __GNUC__ )
+/**
+ * @brief Function that returns from within the scope of a scoped span.
+ *
+ * @param early true to return before the end of the scope.
+ * @return 1 if it returned early, otherwise 0.
+ */
+static int scopedSpanFunction( bool early )
+{
+    LOG_SPAN_SCOPE( "step" );
+    if( early )
+    {
+        return 1;
+    }
+    log_trace( "work\n" );
+    return 0;
+}
+
+/**
+ * @brief Function that holds two scoped spans in the same block.
+ */
+static void nestedScopedSpanFunction( void )
+{
+    LOG_SPAN_SCOPE( "outer" );
+    LOG_SPAN_SCOPE( "inner" );
+    log_trace( "work\n" );
+}
+#endif
+
+/**
+ * @brief Callback function that records the span records and other log 
+ * messages in m_callbackOrder: 'B' for a span begin record, 'E' for a span end
+ * record and 'w' for any other log message.
+ *
+ * @param ev Pointer to logging event data.
+ * @param cbData Unused.
+ */
+static void spanCallbackFunction( tLog_event* ev, void* cbData )
+{
+    (void) cbData;
+    size_t length = strlen( m_callbackOrder );
+    if( length < ( sizeof( m_callbackOrder ) - 1U ) )
+    {
+        m_callbackOrder[length] = ( 0 == strcmp( ev->fmt, LOG_SPAN_BEGIN_FORMAT ) ) ? 'B' :
+                                  ( 0 == strcmp( ev->fmt, LOG_SPAN_END_FORMAT ) ) ? 'E' : 'w';
+    }
+}
+
+/**
+ * @brief A span begun by LOG_SPAN_SCOPE() shall write its end record when its
+ * scope is left, including by an early return, and a block shall be able to 
+ * hold several scoped spans. If the call site table is enabled, the end record
+ * shall have a call site table entry.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_spans_scopeEndRecordIsWrittenOnExit( void )
+{
+    int result = 0;
+#if defined( __GNUC__ )
+    result |= log_registerCallbackFn( spanCallbackFunction, NULL, LOG_TRACE ) ? 0 : 1;
+    result |= log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_TRACE ) ? 0 : 1;
+    log_off();
+    result |= TEST_ASSERT_EQUAL_INT( 1, scopedSpanFunction( true ) );
+    result |= TEST_ASSERT_EQUAL_STRING( "BE", m_callbackOrder );
+#if LOG_USE_STRING_TABLE
+    /* the end record has its own call site table entry, at the line number of the begin record */
+    const tLog_site* site = m_callback1Data.ev.site;
+    result |= ( ( NULL != site ) && ( 0 == strcmp( LOG_SPAN_END_FORMAT, site->fmt ) ) && ( m_callback1Data.ev.line == site->line ) ) ? 0 : 1;
+#endif
+
+    memset( m_callbackOrder, 0, sizeof( m_callbackOrder ) );
+    result |= TEST_ASSERT_EQUAL_INT( 0, scopedSpanFunction( false ) );
+    result |= TEST_ASSERT_EQUAL_STRING( "BwE", m_callbackOrder );
+
+    memset( m_callbackOrder, 0, sizeof( m_callbackOrder ) );
+    nestedScopedSpanFunction();
+    result |= TEST_ASSERT_EQUAL_STRING( "BBwEE", m_callbackOrder );
+#endif
+    return result;
+}
+#endif
+
+#if LOG_USE_SAMPLING
+/**
+ * @brief A sampled call site shall write every Nth log message, where N is 
+ * the sample rate of its logging level, and shall write all log messages at 
+ * the levels whose sample rate has not been set.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_sampling_everyNthMessageIsWritten( void )
+{
+    size_t count = 0U;
+    int result = log_registerCallbackFn( countCallbackFunction, &count, LOG_TRACE ) ? 0 : 1;
+    log_off();
+    result |= log_setSampleRate( LOG_DEBUG, 3U ) ? 0 : 1;
+    result |= log_setSampleRate( LOG_FATAL + 1, 3U ) ? 1 : 0;
+
+    // UUT
+    for( int i = 0; i < 10; i++ )
+    {
+        log_debug_sampled( "sample %d\n", i );
+    }
+    result |= TEST_ASSERT_EQUAL_INT( 3U, count );  /* the 3rd, 6th and 9th log messages */
+
+    count = 0U;
+    for( int i = 0; i < 4; i++ )
+    {
+        log_info_sampled( "unsampled %d\n", i );
+    }
+    result |= TEST_ASSERT_EQUAL_INT( 4U, count );
+    return result;
+}
+
+/**
+ * @brief Call site of a log message that is sampled at the rate 2.
+ *
+ * @param index Argument of the log message, which differs between calls so
+ * that the log messages are not coalesced.
+ */
+static void sampledCallSite( int index )
+{
+    LOG_LOG_SAMPLED( LOG_INFO, 2U, "sample %d\n", index );
+}
+
+/**
+ * @brief A sampled call site shall only count the log messages that would be
+ * written, and LOG_LOG_SAMPLED() shall apply the sample rate of its call site.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_sampling_suppressedMessagesAreNotCounted( void )
+{
+    size_t count = 0U;
+    int result = log_registerCallbackFn( countCallbackFunction, &count, LOG_INFO ) ? 0 : 1;
+    log_off();
+
+    // UUT
+    for( int i = 0; i < 3; i++ )
+    {
+        sampledCallSite( i );
+    }
+    result |= TEST_ASSERT_EQUAL_INT( 1U, count );  /* the 2nd log message */
+
+    log_unregisterCallbackFn( countCallbackFunction, &count );
+    for( int i = 3; i < 8; i++ )
+    {
+        sampledCallSite( i );  /* suppressed: not counted */
+    }
+    result |= log_registerCallbackFn( countCallbackFunction, &count, LOG_INFO ) ? 0 : 1;
+    sampledCallSite( 8 );
+    result |= TEST_ASSERT_EQUAL_INT( 2U, count );  /* the 4th log message that would be written */
+    return result;
+}
+#endif
+
+/**
+ * @brief A log message of the C++ front end, whose format string is checked 
+ * against the argument types at compile time, shall be written to the console.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_cpp_logMessageIsWritten( void )
+{
+    char expectedLogMessage[TEST_BUFFER_SIZE] = { '\0'};
+
+    // UUT
+    int line = testCpp_logMessage();
+#if LOG_USE_ASYNC
+    log_drain();
+#endif
+
+    sprintf( expectedLogMessage, "   12345 INFO  test_cpp.cpp:%d: ab   |00fa|-9000000000|z|   7|ffff|%%\n", line );
+    int result = TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+    return result;
+}
+
+/**
+ * @brief A log message of a logger context of the C++ front end, whose format 
+ * string is checked against the argument types at compile time, shall be 
+ * written to the console.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_cpp_contextLogMessageIsWritten( void )
+{
+    char expectedLogMessage[TEST_BUFFER_SIZE] = { '\0'};
+
+    // UUT
+    int line = testCpp_logContextMessage( NULL );
+#if LOG_USE_ASYNC
+    log_drain();
+#endif
+
+    sprintf( expectedLogMessage, "   12345 INFO  test_cpp.cpp:%d: ab|00fa|-9000000000\n", line );
+    int result = TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+    return result;
+}
+
+#if LOG_MAX_CONTEXTS > 0U
+/**
+ * @brief A log message of a logger context shall be written to the console at
+ * the logging level of the context, and passed to the callbacks of the context
+ * with the context, but not to the callbacks of the default context.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_context_levelAndCallbacksAreSeparate( void )
+{
+    char expectedLogMessage[TEST_BUFFER_SIZE] = { '\0'};
+    tLog_context* context = log_createContext();
+    int result = ( NULL != context ) ? 0 : 1;
+    log_setLevel( LOG_ERROR );
+    log_setContextLevel( context, LOG_DEBUG );
+    result |= log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_TRACE ) ? 0 : 1;
+    result |= log_registerContextCallbackFn( context, callbackFunction, &m_callback2Data, LOG_INFO ) ? 0 : 1;
+
+    // UUT
+    int line = NEXT_LINE;
+    log_debug_ctx( context, "testValue is %d\n", 7 );
+#if LOG_USE_ASYNC
+    log_drain();
+#endif
+
+    sprintf( expectedLogMessage, "   12345 DEBUG test_runner.c:%d: testValue is 7\n", line );
+    result |= TEST_ASSERT_EQUAL_STRING( expectedLogMessage, m_logMessage );
+    result |= TEST_ASSERT_EQUAL_STRING( "", m_callback1Data.logMessage );
+    result |= TEST_ASSERT_EQUAL_STRING( "", m_callback2Data.logMessage );  /* below the callback level */
+
+    log_info_ctx( context, "testValue is %d\n", 8 );
+    result |= TEST_ASSERT_EQUAL_STRING( "", m_callback1Data.logMessage );
+    result |= TEST_ASSERT_EQUAL_STRING( "testValue is 8\n", m_callback2Data.logMessage );
+    result |= ( context == m_callback2Data.ev.context ) ? 0 : 1;
+
+    log_debug( "default context\n" );
+    result |= ( NULL == m_callback1Data.ev.context ) ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_STRING( "default context\n", m_callback1Data.logMessage );
+    result |= TEST_ASSERT_EQUAL_STRING( "testValue is 8\n", m_callback2Data.logMessage );
+
+    result |= log_isContextEnabled( context, LOG_TRACE ) ? 1 : 0;
+    result |= log_isContextEnabled( NULL, LOG_TRACE ) ? 0 : 1;
+    log_contextOff( context );
+    result |= log_isContextEnabled( context, LOG_DEBUG ) ? 1 : 0;
+    result |= log_isContextEnabled( context, LOG_INFO ) ? 0 : 1;
+    return result;
+}
+
+/**
+ * @brief A logger context shall take its own lock, so that its log messages 
+ * are passed to its callbacks while the lock of the default context is taken.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_context_lockIsSeparate( void )
+{
+    bool contextIsLocked = false;
+    tLog_context* context = log_createContext();
+    log_off();
+    log_contextOff( context );
+    log_setLockFn( setLockState, &m_logIsLocked );
+    log_setContextLockFn( context, setLockState, &contextIsLocked );
+    int result = log_registerCallbackFn( callbackFunction, &m_callback1Data, LOG_TRACE ) ? 0 : 1;
+    result |= log_registerContextCallbackFn( context, callbackFunction, &m_callback2Data, LOG_TRACE ) ? 0 : 1;
+    m_logIsLocked = true;  /* Simulate lock acquisition by another thread */
+
+    // UUT
+    log_info( "blocked\n" );
+    log_info_ctx( context, "not blocked\n" );
+
+    result |= TEST_ASSERT_EQUAL_STRING( "", m_callback1Data.logMessage );
+    result |= TEST_ASSERT_EQUAL_STRING( "not blocked\n", m_callback2Data.logMessage );
+    result |= contextIsLocked ? 1 : 0;  /* the context lock is released */
+
+    contextIsLocked = true;
+    log_info_ctx( context, "blocked\n" );
+    result |= TEST_ASSERT_EQUAL_STRING( "not blocked\n", m_callback2Data.logMessage );
+    return result;
+}
+
+/**
+ * @brief log_createContext() shall allocate LOG_MAX_CONTEXTS distinct contexts,
+ * which are not the default context, and shall then return NULL.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_context_poolIsExhausted( void )
+{
+    tLog_context* contexts[LOG_MAX_CONTEXTS];
+    int result = 0;
+
+    // UUT
+    for( size_t i = 0U; i < LOG_MAX_CONTEXTS; i++ )
+    {
+        contexts[i] = log_createContext();
+        result |= ( NULL != contexts[i] ) ? 0 : 1;
+        result |= ( log_getDefaultContext() != contexts[i] ) ? 0 : 1;
+        for( size_t j = 0U; j < i; j++ )
+        {
+            result |= ( contexts[j] != contexts[i] ) ? 0 : 1;
+        }
+    }
+    result |= TEST_ASSERT_NULL( log_createContext() );
+    return result;
+}
+
+/**
+ * @brief Get a logger context, and count the calls.
+ *
+ * @param context Logger context.
+ * @param[in,out] count Number of calls.
+ * @return The logger context.
+ */
+static tLog_context* countContext( tLog_context* context, size_t* count )
+{
+    (*count)++;
+    return context;
+}
+
+/**
+ * @brief The logger context argument of the context logging macros shall be 
+ * evaluated once, whether the log message is written or not.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_context_macroEvaluatesContextOnce( void )
+{
+    size_t count = 0U;
+    tLog_context* context = log_createContext();
+    log_setContextLevel( context, LOG_INFO );
+    int result = log_registerContextCallbackFn( context, callbackFunction, &m_callback1Data, LOG_TRACE ) ? 0 : 1;
+
+    // UUT
+    log_info_ctx( countContext( context, &count ), "written\n" );
+    log_debug_ctx( countContext( context, &count ), "passed to the callback\n" );
+    log_contextOff( context );
+    (void)log_unregisterContextCallbackFn( context, callbackFunction, &m_callback1Data );
+    log_info_ctx( countContext( context, &count ), "not written\n" );
+
+#if defined( __GNUC__ )
+    result |= TEST_ASSERT_EQUAL_INT( 3U, count );
+#else
+    result |= TEST_ASSERT_EQUAL_INT( 5U, count );  /* the context argument is evaluated twice if the log message is written */
+#endif
+    result |= TEST_ASSERT_EQUAL_STRING( "passed to the callback\n", m_callback1Data.logMessage );
+    return result;
+}
+
+#if LOG_USE_COALESCE
+/**
+ * @brief Each logger context shall compare a log message with its own last log
+ * message, so that interleaved repeats of two contexts are still coalesced.
+ *
+ * @return 0 if test passes, 1 if test fails. 
+ */
+static int test_context_repeatsAreCoalescedPerContext( void )
+{
+    size_t count = 0U;
+    size_t contextCount = 0U;
+    tLog_context* context = log_createContext();
+    int result = log_registerCallbackFn( countCallbackFunction, &count, LOG_TRACE ) ? 0 : 1;
+    result |= log_registerContextCallbackFn( context, countCallbackFunction, &contextCount, LOG_TRACE ) ? 0 : 1;
+
+    // UUT
+    for( int i = 0; i < 4; i++ )
+    {
+        log_warn( "link down" );
+        log_warn_ctx( context, "link down" );
+    }
+    result |= TEST_ASSERT_EQUAL_INT( 1U, count );
+    result |= TEST_ASSERT_EQUAL_INT( 1U, contextCount );
+
+    result |= log_flush() ? 0 : 1;
+    result |= TEST_ASSERT_EQUAL_INT( 2U, count );  /* repeat count of each context */
+    result |= TEST_ASSERT_EQUAL_INT( 2U, contextCount );
+    return result;
+}
+#endif
+#endif
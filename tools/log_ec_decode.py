@@ -0,0 +1,294 @@
+#!/usr/bin/env python3
+"""
+Decode binary log records written by log_binaryCallback() into text.
+
+The filename and format string of each record are read from the ELF file of
+the firmware, at their offset from the log_binaryAnchor object, or from the
+call site table (the log_ec_sites section) if the record holds a call site ID.
+The decoded log messages are printed in the same format as the console log
+messages:
+
+    log_ec_decode.py firmware.elf log.bin
+
+The call site table can be saved to a JSON file, which decodes call site
+records without the ELF file:
+
+    log_ec_decode.py --dump-table firmware.elf sites.json
+    log_ec_decode.py --table sites.json log.bin
+
+Copyright (c) 2025 Tony Bayley. SPDX-License-Identifier: MIT
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+LEVELS = ("TRACE", "DEBUG", "INFO", "WARN", "ERROR", "FATAL")
+RECORD_MESSAGE = 0x00
+RECORD_SYNC = 0x10
+RECORD_SITE = 0x20
+RECORD_TRUNCATED = 0x80
+FORMAT_VERSION = 1
+ANCHOR_SYMBOL = "log_binaryAnchor"
+SITES_SECTION = "log_ec_sites"
+MAX_SITES = 0xFFFF  # call site ID 0xFFFF is LOG_SITE_ID_INVALID
+
+# printf conversion specification: flags, width, precision, length modifier, specifier
+CONVERSION = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|j|z|t|L)?(.?)")
+
+
+class ElfImage:
+    """Minimal ELF reader: allocated section contents and symbol table."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF":
+            raise ValueError(f"{path} is not an ELF file")
+        self.is64 = self.data[4] == 2
+        self.endian = "<" if self.data[5] == 1 else ">"
+        if self.is64:
+            shoff, = struct.unpack_from(self.endian + "Q", self.data, 0x28)
+            shentsize, shnum = struct.unpack_from(self.endian + "HH", self.data, 0x3A)
+        else:
+            shoff, = struct.unpack_from(self.endian + "I", self.data, 0x20)
+            shentsize, shnum = struct.unpack_from(self.endian + "HH", self.data, 0x2E)
+        self.sections = [self._section(shoff + i * shentsize) for i in range(shnum)]
+        shstrndx, = struct.unpack_from(self.endian + "H", self.data, 0x3E if self.is64 else 0x32)
+        names = self.sections[shstrndx]
+        for section in self.sections:
+            start = names["offset"] + section["name"]
+            section["name"] = self.data[start:self.data.index(b"\0", start)].decode()
+
+    def _section(self, offset):
+        if self.is64:
+            name, stype, flags, addr, off, size, link, _, _, entsize = struct.unpack_from(
+                self.endian + "IIQQQQIIQQ", self.data, offset)
+        else:
+            name, stype, flags, addr, off, size, link, _, _, entsize = struct.unpack_from(
+                self.endian + "IIIIIIIIII", self.data, offset)
+        return {"name": name, "type": stype, "flags": flags, "addr": addr, "offset": off,
+                "size": size, "link": link, "entsize": entsize}
+
+    def symbol(self, name):
+        """Return the value of the named symbol, from the symbol table."""
+        for section in self.sections:
+            if section["type"] != 2:  # SHT_SYMTAB
+                continue
+            strtab = self.sections[section["link"]]
+            for i in range(section["size"] // section["entsize"]):
+                offset = section["offset"] + i * section["entsize"]
+                if self.is64:
+                    st_name, _, _, _, value, _ = struct.unpack_from(self.endian + "IBBHQQ", self.data, offset)
+                else:
+                    st_name, value, _, _, _, _ = struct.unpack_from(self.endian + "IIIBBH", self.data, offset)
+                start = strtab["offset"] + st_name
+                if self.data[start:self.data.index(b"\0", start)].decode() == name:
+                    return value
+        raise KeyError(f"symbol {name} not found: the ELF file shall not be stripped")
+
+    def string(self, address):
+        """Return the null terminated string at a virtual address."""
+        for section in self.sections:
+            if (section["flags"] & 0x2) and section["type"] != 8 and \
+                    section["addr"] <= address < section["addr"] + section["size"]:  # SHF_ALLOC, not SHT_NOBITS
+                start = section["offset"] + address - section["addr"]
+                return self.data[start:self.data.index(b"\0", start)].decode(errors="replace")
+        return f"<0x{address:x}>"
+
+    def sites(self):
+        """Return the call site table: a list of (file, line, level, fmt) tuples, indexed by call site ID."""
+        entry = self.endian + ("QQihh" if self.is64 else "IIihh")
+        size = struct.calcsize(entry)
+        for section in self.sections:
+            if section["name"] == SITES_SECTION:
+                return [(self.string(file), line, level, self.string(fmt))
+                        for file, fmt, line, level, _ in struct.iter_unpack(
+                            entry, self.data[section["offset"]:section["offset"] + section["size"] // size * size])]
+        return []
+
+
+class SiteTable:
+    """Call site table read from a JSON file written by --dump-table, without string addresses."""
+
+    def __init__(self, path):
+        with open(path) as f:
+            self.table = [(site["file"], site["line"], site["level"], site["fmt"]) for site in json.load(f)["sites"]]
+
+    def symbol(self, name):
+        return 0
+
+    def string(self, address):
+        return "<no ELF file>"
+
+    def sites(self):
+        return self.table
+
+
+class Reader:
+    """Reader of the fields of a binary log record."""
+
+    def __init__(self, data):
+        self.data = data
+        self.index = 0
+
+    def remaining(self):
+        return len(self.data) - self.index
+
+    def varint(self):
+        value = shift = 0
+        while True:
+            if self.index >= len(self.data):
+                raise EOFError
+            byte = self.data[self.index]
+            self.index += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                return value
+
+    def signed(self):
+        value = self.varint()
+        return (value >> 1) ^ -(value & 1)
+
+    def bytes(self, length):
+        if self.index + length > len(self.data):
+            raise EOFError
+        value = self.data[self.index:self.index + length]
+        self.index += length
+        return value
+
+
+def format_conversion(flags, width, precision, specifier, value):
+    """Format a single printf conversion with Python's % operator."""
+    spec = "%" + flags + ("" if width is None else str(width)) + \
+        ("" if precision is None else "." + str(precision))
+    if specifier == "p":
+        return "(nil)" if value == 0 else format_conversion(flags.replace("#", "") + "#", width, precision, "x", value)
+    if specifier == "o":
+        return ((spec + "o") % value).replace("0o", "0", 1)  # C alternate form prefix is "0", not "0o"
+    if specifier == "u":
+        specifier = "d"
+    if specifier in "aA":
+        return value.hex() if specifier == "a" else value.hex().upper()
+    if specifier == "c":
+        value = chr(value)
+    return (spec + specifier) % value
+
+
+def render(fmt, reader):
+    """Format a log message body from its format string and encoded arguments."""
+    out = []
+    position = 0
+    for match in CONVERSION.finditer(fmt):
+        out.append(fmt[position:match.start()])
+        position = match.end()
+        flags, width, precision, _, specifier = match.groups()
+        if specifier == "%":
+            out.append("%")
+            continue
+        try:
+            if width == "*":
+                width = reader.signed()
+                if width < 0:
+                    flags, width = flags + "-", -width
+            elif width is not None:
+                width = int(width)
+            if precision == "*":
+                precision = reader.signed()
+                precision = None if precision < 0 else precision
+            elif precision is not None:
+                precision = int(precision or 0)
+            if specifier in "di":
+                value = reader.signed()
+            elif specifier in "uoxXcp":
+                value = reader.varint()
+            elif specifier in "fFeEgGaA":
+                value, = struct.unpack("<d", reader.bytes(8))
+            elif specifier == "s":
+                value = reader.bytes(reader.varint()).decode(errors="replace")
+            elif specifier == "n":
+                continue
+            else:
+                out.append(match.group(0))
+                continue
+        except EOFError:
+            out.append("<truncated>")
+            return "".join(out)
+        out.append(format_conversion(flags, width, precision, specifier, value))
+    out.append(fmt[position:])
+    return "".join(out)
+
+
+def decode(elf, stream, output):
+    """Decode a stream of binary log records, writing text log messages to output."""
+    anchor = elf.symbol(ANCHOR_SYMBOL)
+    sites = elf.sites()
+    time = 0
+    time_mask = 0xFFFFFFFF
+    records = Reader(stream)
+    while records.remaining() > 0:
+        try:
+            record = Reader(records.bytes(records.varint()))
+            header = record.bytes(1)[0]
+            if header & 0x70 == RECORD_SYNC:
+                version = record.bytes(1)[0]
+                if version != FORMAT_VERSION:
+                    raise ValueError(f"unsupported binary record format version {version}")
+                time = record.varint()
+                time_mask = (1 << record.varint()) - 1 if record.remaining() > 0 else 0xFFFFFFFF
+                continue
+            if header & 0x70 not in (RECORD_MESSAGE, RECORD_SITE):
+                continue  # unknown record type
+            time = (time + record.varint()) & time_mask
+            if header & 0x70 == RECORD_SITE:
+                site = record.varint()
+                file, line, _, fmt = sites[site] if site < len(sites) else (f"<site {site}>", 0, 0, "")
+            else:
+                file = elf.string(anchor + record.signed())
+                line = record.varint()
+                fmt = elf.string(anchor + record.signed())
+        except EOFError:
+            print("<incomplete record>", file=sys.stderr)
+            break
+        level = LEVELS[header & 0x07] if (header & 0x07) < len(LEVELS) else "?"
+        body = render(fmt, record)
+        if header & RECORD_TRUNCATED and not body.endswith("<truncated>"):
+            body += "<truncated>"
+        output.write(f"{time:8d} {level:<5s} {file}:{line}: {body}")
+        if not body.endswith("\n"):
+            output.write("\n")
+
+
+def dump_table(elf, path):
+    """Write the call site table of an ELF file to a JSON file."""
+    sites = [{"file": file, "line": line, "level": level, "fmt": fmt} for file, line, level, fmt in elf.sites()]
+    if len(sites) > MAX_SITES:
+        sys.exit(f"error: the call site table holds {len(sites)} entries, but log_siteId() assigns at most "
+                 f"{MAX_SITES} 16-bit call site IDs")
+    with open(path, "w") as f:
+        json.dump({"sites": sites}, f, indent=1)
+        f.write("\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("source", help="ELF file of the firmware that wrote the log records (not stripped), "
+                                       "or the JSON call site table if --table is given")
+    parser.add_argument("log", help="binary log record file, or the JSON output file if --dump-table is given")
+    mode = parser.add_mutually_exclusive_group()
+    mode.add_argument("--table", action="store_true", help="decode call site records with a JSON call site table")
+    mode.add_argument("--dump-table", action="store_true", help="write the call site table of the ELF file to JSON")
+    args = parser.parse_args()
+    if args.dump_table:
+        dump_table(ElfImage(args.source), args.log)
+        return
+    with open(args.log, "rb") as f:
+        stream = f.read()
+    decode(SiteTable(args.source) if args.table else ElfImage(args.source), stream, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
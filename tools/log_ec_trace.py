@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""
+Convert log_ec span records into Chrome trace / Perfetto JSON.
+
+The span records written by LOG_SPAN_BEGIN(), LOG_SPAN_END() and
+LOG_SPAN_SCOPE() are read from a captured console log, and converted into
+duration events. The other log messages are converted into instant events:
+
+    log_ec_trace.py console.log trace.json
+
+Binary log records written by log_binaryCallback() are decoded first, with the
+ELF file of the firmware or a JSON call site table (see log_ec_decode.py):
+
+    log_ec_trace.py --elf firmware.elf log.bin trace.json
+    log_ec_trace.py --table sites.json log.bin trace.json
+
+Open the JSON file in https://ui.perfetto.dev or chrome://tracing.
+
+Copyright (c) 2025 Tony Bayley. SPDX-License-Identifier: MIT
+"""
+
+import argparse
+import io
+import json
+import re
+import sys
+
+import log_ec_decode
+
+# console format log message: timestamp, level, filename, line number and body
+MESSAGE = re.compile(r"^\s*(\d+) (TRACE|DEBUG|INFO|WARN|ERROR|FATAL)\s+(.+?):(\d+): (.*)$")
+SPAN_BEGIN = re.compile(r"^span B (.*)$")
+SPAN_END = "span E"
+ESCAPE = re.compile(r"\x1b\[[0-9;]*m")  # colour escape codes, if LOG_USE_COLOR is set
+
+
+def convert(lines, tick_us, timestamp_bits, messages):
+    """Convert console format log messages into a list of trace events."""
+    events = []
+    spans = []
+    wrap = 1 << timestamp_bits
+    offset = 0
+    last = None
+    for line in lines:
+        match = MESSAGE.match(ESCAPE.sub("", line.rstrip("\r\n")))
+        if match is None:
+            continue
+        time, level, file, line_number, body = match.groups()
+        time = int(time)
+        if last is not None and time + offset < last - wrap // 2:
+            offset += wrap  # the timestamp has wrapped around
+        last = time + offset
+        event = {"ts": last * tick_us, "pid": 0, "tid": 0}
+        begin = SPAN_BEGIN.match(body)
+        if begin is not None:
+            spans.append(begin.group(1))
+            event.update(name=begin.group(1), ph="B", args={"location": f"{file}:{line_number}"})
+        elif body == SPAN_END:
+            if not spans:
+                continue  # the span began before the start of the log
+            event.update(name=spans.pop(), ph="E")
+        elif messages:
+            event.update(name=body, ph="i", s="t", cat=level, args={"location": f"{file}:{line_number}"})
+        else:
+            continue
+        events.append(event)
+    return events
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("log", help="console log file, or binary log record file if --elf or --table is given")
+    parser.add_argument("output", help="Chrome trace JSON output file")
+    source = parser.add_mutually_exclusive_group()
+    source.add_argument("--elf", help="ELF file of the firmware that wrote the binary log records")
+    source.add_argument("--table", help="JSON call site table of the firmware that wrote the binary log records")
+    parser.add_argument("--tick-us", type=float, default=1.0,
+                        help="microseconds per printed timestamp unit (default 1.0)")
+    parser.add_argument("--timestamp-bits", type=int, default=32,
+                        help="width of the printed timestamps, at which they wrap around (default 32)")
+    parser.add_argument("--spans-only", action="store_true", help="omit the log messages that are not span records")
+    args = parser.parse_args()
+    if args.elf or args.table:
+        with open(args.log, "rb") as f:
+            stream = f.read()
+        source = log_ec_decode.ElfImage(args.elf) if args.elf else log_ec_decode.SiteTable(args.table)
+        text = io.StringIO()
+        log_ec_decode.decode(source, stream, text)
+        lines = text.getvalue().splitlines()
+    else:
+        with open(args.log, errors="replace") as f:
+            lines = f.read().splitlines()
+    events = convert(lines, args.tick_us, args.timestamp_bits, not args.spans_only)
+    with open(args.output, "w") as f:
+        json.dump({"traceEvents": events, "displayTimeUnit": "ns"}, f, indent=1)
+        f.write("\n")
+    print(f"{len(events)} trace events written to {args.output}", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()